@@ -2,6 +2,23 @@ def can_build(env, platform):
     return not env["disable_3d"]
 
 
+def get_opts(platform):
+    from SCons.Variables import BoolVariable
+
+    return [
+        BoolVariable(
+            "many_bone_ik_deterministic",
+            "Use portable math without fused multiply-adds in the IK solver for bit-reproducible results across platforms",
+            False,
+        ),
+        BoolVariable(
+            "many_bone_ik_trace",
+            "Compile in the solver's Chrome trace instrumentation (EWBIK3D.start_trace)",
+            False,
+        ),
+    ]
+
+
 def configure(env):
     pass
 
@@ -17,6 +34,13 @@ def get_doc_classes():
         "IKRay3D",
         "IKNode3D",
         "IKLimitCone3D",
+        "IKReachabilityVolume3D",
+        "IKEffectorAnimation3D",
+        "IKAnimationBaker3D",
+        "IKRetargeter3D",
+        "IKPoseSnapshot3D",
+        "IKSolveTrace3D",
+        "IKTargetRecording3D",
     ]
 
 
@@ -0,0 +1,299 @@
+/**************************************************************************/
+/*  ik_core_frame_ring.cpp                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_core_frame_ring.h"
+
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IKCore {
+
+static uint64_t _get_slot_stride(uint32_t p_slot_capacity) {
+	return (uint64_t(FrameRing::SLOT_HEADER_SIZE) + p_slot_capacity + 63) & ~uint64_t(63);
+}
+
+size_t FrameRing::get_required_size(uint32_t p_slot_count, uint32_t p_slot_capacity) {
+	return sizeof(RingHeader) + size_t(p_slot_count) * _get_slot_stride(p_slot_capacity);
+}
+
+FrameRing::SlotHeader *FrameRing::_get_slot(uint64_t p_frame) const {
+	return reinterpret_cast<SlotHeader *>(slots + (p_frame % header->slot_count) * header->slot_stride);
+}
+
+void FrameRing::_resync(uint64_t p_frame, uint64_t p_slot_sequence) {
+	// The slot holds, or is being filled with, a later frame than p_frame, so
+	// the producer lapped this reader. Resume at the oldest frame the producer
+	// is not about to overwrite, judged from whichever of its write count and
+	// the slot's own sequence is further ahead.
+	const uint64_t slot_frame = (p_slot_sequence - 1) / 2;
+	const uint64_t written = header->write_count.load(std::memory_order_acquire);
+	const uint64_t latest = written > slot_frame + 1 ? written : slot_frame + 1;
+	const uint64_t oldest = latest > header->slot_count ? latest - header->slot_count + 1 : 0;
+	local_count = oldest > p_frame + 1 ? oldest : p_frame + 1;
+	header->read_count.store(local_count, std::memory_order_release);
+}
+
+FrameRing::Result FrameRing::create(void *p_memory, size_t p_size, uint32_t p_slot_count, uint32_t p_slot_capacity) {
+	if (!p_memory || (reinterpret_cast<uintptr_t>(p_memory) & 63) != 0 || p_slot_count == 0 || p_size < get_required_size(p_slot_count, p_slot_capacity)) {
+		return RESULT_INVALID;
+	}
+	header = new (p_memory) RingHeader();
+	header->slot_count = p_slot_count;
+	header->slot_capacity = p_slot_capacity;
+	header->slot_stride = _get_slot_stride(p_slot_capacity);
+	std::memset(header->reserved, 0, sizeof(header->reserved));
+	header->write_count.store(0, std::memory_order_relaxed);
+	header->read_count.store(0, std::memory_order_relaxed);
+	slots = static_cast<uint8_t *>(p_memory) + sizeof(RingHeader);
+	for (uint32_t slot_i = 0; slot_i < p_slot_count; slot_i++) {
+		SlotHeader *slot = new (slots + slot_i * header->slot_stride) SlotHeader();
+		slot->sequence.store(0, std::memory_order_relaxed);
+		slot->size = 0;
+		slot->reserved = 0;
+	}
+	header->version = VERSION;
+	// Publishing the magic last lets an attaching process tell a finished layout from a partial one.
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = MAGIC;
+	local_count = 0;
+	return RESULT_OK;
+}
+
+FrameRing::Result FrameRing::attach(void *p_memory, size_t p_size, Side p_side) {
+	header = nullptr;
+	slots = nullptr;
+	if (!p_memory || (reinterpret_cast<uintptr_t>(p_memory) & 63) != 0 || p_size < sizeof(RingHeader)) {
+		return RESULT_INVALID;
+	}
+	RingHeader *candidate = static_cast<RingHeader *>(p_memory);
+	if (candidate->magic != MAGIC) {
+		return RESULT_INVALID;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (candidate->version != VERSION || candidate->slot_count == 0 || candidate->slot_stride != _get_slot_stride(candidate->slot_capacity) ||
+			p_size < get_required_size(candidate->slot_count, candidate->slot_capacity)) {
+		return RESULT_INVALID;
+	}
+	header = candidate;
+	slots = static_cast<uint8_t *>(p_memory) + sizeof(RingHeader);
+	local_count = p_side == SIDE_PRODUCER ? header->write_count.load(std::memory_order_acquire) : header->read_count.load(std::memory_order_acquire);
+	return RESULT_OK;
+}
+
+bool FrameRing::is_valid() const {
+	return header != nullptr;
+}
+
+uint32_t FrameRing::get_slot_capacity() const {
+	return header ? header->slot_capacity : 0;
+}
+
+uint64_t FrameRing::get_write_count() const {
+	return header ? header->write_count.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t FrameRing::get_read_count() const {
+	return header ? header->read_count.load(std::memory_order_acquire) : 0;
+}
+
+FrameRing::Result FrameRing::push(const void *p_data, uint32_t p_size) {
+	if (!header || (p_size > 0 && !p_data)) {
+		return RESULT_INVALID;
+	}
+	if (p_size > header->slot_capacity) {
+		return RESULT_TOO_LARGE;
+	}
+	const uint64_t frame = local_count;
+	SlotHeader *slot = _get_slot(frame);
+	slot->sequence.store(2 * frame + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->size = p_size;
+	std::memcpy(reinterpret_cast<uint8_t *>(slot) + SLOT_HEADER_SIZE, p_data, p_size);
+	slot->sequence.store(2 * frame + 2, std::memory_order_release);
+	local_count = frame + 1;
+	header->write_count.store(local_count, std::memory_order_release);
+	return RESULT_OK;
+}
+
+FrameRing::Result FrameRing::pop(void *r_data, uint32_t p_capacity, uint32_t *r_size, uint64_t *r_sequence) {
+	if (!header || !r_size || (p_capacity > 0 && !r_data)) {
+		return RESULT_INVALID;
+	}
+	const uint64_t written = header->write_count.load(std::memory_order_acquire);
+	if (local_count >= written) {
+		return RESULT_EMPTY;
+	}
+	if (written - local_count > header->slot_count) {
+		// Frames up to written - slot_count have been overwritten.
+		local_count = written - header->slot_count;
+		header->read_count.store(local_count, std::memory_order_release);
+		return RESULT_OVERRUN;
+	}
+	const uint64_t frame = local_count;
+	SlotHeader *slot = _get_slot(frame);
+	const uint64_t expected = 2 * frame + 2;
+	const uint64_t before = slot->sequence.load(std::memory_order_acquire);
+	if (before != expected) {
+		if (before > expected) {
+			_resync(frame, before);
+			return RESULT_OVERRUN;
+		}
+		local_count = frame + 1;
+		header->read_count.store(local_count, std::memory_order_release);
+		return RESULT_TORN;
+	}
+	const uint32_t size = slot->size;
+	if (size > p_capacity || size > header->slot_capacity) {
+		local_count = frame + 1;
+		header->read_count.store(local_count, std::memory_order_release);
+		return RESULT_TOO_LARGE;
+	}
+	std::memcpy(r_data, reinterpret_cast<const uint8_t *>(slot) + SLOT_HEADER_SIZE, size);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64_t after = slot->sequence.load(std::memory_order_relaxed);
+	if (after != expected) {
+		_resync(frame, after);
+		return RESULT_TORN;
+	}
+	local_count = frame + 1;
+	header->read_count.store(local_count, std::memory_order_release);
+	*r_size = size;
+	if (r_sequence) {
+		*r_sequence = frame;
+	}
+	return RESULT_OK;
+}
+
+FrameRing::Result FrameRing::pop_latest(void *r_data, uint32_t p_capacity, uint32_t *r_size, uint64_t *r_sequence) {
+	if (!header) {
+		return RESULT_INVALID;
+	}
+	const uint64_t written = header->write_count.load(std::memory_order_acquire);
+	if (written > local_count + 1) {
+		local_count = written - 1;
+	}
+	return pop(r_data, p_capacity, r_size, r_sequence);
+}
+
+#ifndef _WIN32
+
+bool SharedMemory::create(const char *p_name, size_t p_size) {
+	close();
+	const int fd = shm_open(p_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		return false;
+	}
+	if (ftruncate(fd, off_t(p_size)) != 0) {
+		::close(fd);
+		shm_unlink(p_name);
+		return false;
+	}
+	void *mapped = mmap(nullptr, p_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		shm_unlink(p_name);
+		return false;
+	}
+	memory = mapped;
+	size = p_size;
+	return true;
+}
+
+bool SharedMemory::open(const char *p_name, size_t p_size) {
+	close();
+	const int fd = shm_open(p_name, O_RDWR, 0600);
+	if (fd < 0) {
+		return false;
+	}
+	// Mapping past the end of the object would fault on first touch instead of failing here.
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0 || uint64_t(info.st_size) < p_size) {
+		::close(fd);
+		return false;
+	}
+	const size_t map_size = p_size ? p_size : size_t(info.st_size);
+	void *mapped = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	memory = mapped;
+	size = map_size;
+	return true;
+}
+
+void SharedMemory::close() {
+	if (memory) {
+		munmap(memory, size);
+	}
+	memory = nullptr;
+	size = 0;
+}
+
+bool SharedMemory::unlink(const char *p_name) {
+	return shm_unlink(p_name) == 0;
+}
+
+#else
+
+bool SharedMemory::create(const char *p_name, size_t p_size) {
+	(void)p_name;
+	(void)p_size;
+	return false;
+}
+
+bool SharedMemory::open(const char *p_name, size_t p_size) {
+	(void)p_name;
+	(void)p_size;
+	return false;
+}
+
+void SharedMemory::close() {
+}
+
+bool SharedMemory::unlink(const char *p_name) {
+	(void)p_name;
+	return false;
+}
+
+#endif
+
+SharedMemory::~SharedMemory() {
+	close();
+}
+
+} // namespace IKCore
@@ -0,0 +1,159 @@
+/**************************************************************************/
+/*  ik_core_frame_ring.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace IKCore {
+
+// Single-producer, single-consumer ring of fixed-size frames in memory shared
+// between processes. The solver reads target frames from one ring and writes
+// pose frames to another; an external process does the opposite.
+//
+// The producer never waits. When the consumer falls behind by a whole ring
+// the oldest frames are overwritten, and the consumer finds out through the
+// per-slot sequence numbers: each slot is a seqlock whose sequence is odd
+// while its payload is being written, so a copy that raced a write is
+// detected and discarded instead of returned torn.
+//
+// Layout, in native byte order, offsets in bytes:
+//   0    RingHeader (128 bytes)
+//   128  slot_count slots of SLOT_HEADER_SIZE + slot_capacity bytes each,
+//        rounded up to 64 so every slot starts on a cache line
+class FrameRing {
+public:
+	static constexpr uint32_t MAGIC = 0x474e5249; // "IRNG"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t SLOT_HEADER_SIZE = 16;
+
+	enum Side {
+		SIDE_PRODUCER,
+		SIDE_CONSUMER,
+	};
+
+	enum Result {
+		RESULT_OK,
+		// No frame newer than the last one read.
+		RESULT_EMPTY,
+		// The producer lapped the consumer; reading resumes at the oldest frame still in the ring.
+		RESULT_OVERRUN,
+		// The frame was overwritten while it was being copied; reading resumes
+		// at the oldest frame still in the ring.
+		RESULT_TORN,
+		// The frame does not fit the slot, or the caller's buffer.
+		RESULT_TOO_LARGE,
+		RESULT_INVALID,
+	};
+
+	struct alignas(64) RingHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slot_count;
+		uint32_t slot_capacity;
+		uint64_t slot_stride;
+		uint8_t reserved[40];
+		// Frames published so far. Written by the producer only.
+		alignas(64) std::atomic<uint64_t> write_count;
+		// Frames consumed so far, for monitoring lag. Written by the consumer only.
+		std::atomic<uint64_t> read_count;
+	};
+
+	struct SlotHeader {
+		// 2 * (n + 1) once frame n is complete, one less while it is written.
+		std::atomic<uint64_t> sequence;
+		uint32_t size;
+		uint32_t reserved;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared rings need lock-free 64-bit atomics.");
+	static_assert(sizeof(RingHeader) == 128, "RingHeader is part of the shared layout.");
+	static_assert(sizeof(SlotHeader) == SLOT_HEADER_SIZE, "SlotHeader is part of the shared layout.");
+
+private:
+	RingHeader *header = nullptr;
+	uint8_t *slots = nullptr;
+	// Next frame number this side will write or read.
+	uint64_t local_count = 0;
+
+	SlotHeader *_get_slot(uint64_t p_frame) const;
+	void _resync(uint64_t p_frame, uint64_t p_slot_sequence);
+
+public:
+	static size_t get_required_size(uint32_t p_slot_count, uint32_t p_slot_capacity);
+
+	// Lays out a new ring in p_memory, which must be 64-byte aligned and
+	// zero-filled or otherwise unused.
+	Result create(void *p_memory, size_t p_size, uint32_t p_slot_count, uint32_t p_slot_capacity);
+	// Attaches to a ring another process created, validating its header. A
+	// producer continues after the last frame published, a consumer after the
+	// last frame consumed.
+	Result attach(void *p_memory, size_t p_size, Side p_side);
+	bool is_valid() const;
+
+	uint32_t get_slot_capacity() const;
+	uint64_t get_write_count() const;
+	uint64_t get_read_count() const;
+
+	// Producer side.
+	Result push(const void *p_data, uint32_t p_size);
+
+	// Consumer side. p_sequence, when given, receives the frame number.
+	Result pop(void *r_data, uint32_t p_capacity, uint32_t *r_size, uint64_t *r_sequence = nullptr);
+	// Skips to the newest complete frame and reads it, for pollers that only
+	// care about the latest state, such as a solver reading targets once per frame.
+	Result pop_latest(void *r_data, uint32_t p_capacity, uint32_t *r_size, uint64_t *r_sequence = nullptr);
+};
+
+// A named POSIX shared memory mapping, so an unrelated process can open the
+// same rings. Unsupported platforms fail to create or open.
+class SharedMemory {
+	void *memory = nullptr;
+	size_t size = 0;
+
+public:
+	bool create(const char *p_name, size_t p_size);
+	// Fails if the object is smaller than p_size. A p_size of 0 maps the whole object.
+	bool open(const char *p_name, size_t p_size);
+	void close();
+	static bool unlink(const char *p_name);
+
+	void *get_memory() const { return memory; }
+	size_t get_size() const { return size; }
+
+	SharedMemory() = default;
+	SharedMemory(const SharedMemory &) = delete;
+	SharedMemory &operator=(const SharedMemory &) = delete;
+	~SharedMemory();
+};
+
+} // namespace IKCore
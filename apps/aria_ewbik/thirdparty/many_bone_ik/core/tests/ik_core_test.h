@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*  ik_core_test.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// A very small test harness so the core builds its tests without third-party
+// code. Each TEST_CASE registers itself; CHECK records a failure and carries on.
+namespace IKCoreTest {
+
+struct Case {
+	const char *name;
+	void (*function)();
+};
+
+inline std::vector<Case> &get_cases() {
+	static std::vector<Case> cases;
+	return cases;
+}
+
+inline int &get_failures() {
+	static int failures = 0;
+	return failures;
+}
+
+struct Registrar {
+	Registrar(const char *p_name, void (*p_function)()) {
+		get_cases().push_back({ p_name, p_function });
+	}
+};
+
+inline void check(bool p_passed, const char *p_expression, const char *p_file, int p_line) {
+	if (!p_passed) {
+		std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", p_file, p_line, p_expression);
+		get_failures()++;
+	}
+}
+
+} // namespace IKCoreTest
+
+#define IK_CORE_TEST_CONCAT_IMPL(m_a, m_b) m_a##m_b
+#define IK_CORE_TEST_CONCAT(m_a, m_b) IK_CORE_TEST_CONCAT_IMPL(m_a, m_b)
+#define TEST_CASE(m_name) \
+	static void IK_CORE_TEST_CONCAT(_ik_core_test_, __LINE__)(); \
+	static IKCoreTest::Registrar IK_CORE_TEST_CONCAT(_ik_core_registrar_, __LINE__)(m_name, &IK_CORE_TEST_CONCAT(_ik_core_test_, __LINE__)); \
+	static void IK_CORE_TEST_CONCAT(_ik_core_test_, __LINE__)()
+#define CHECK(m_expression) IKCoreTest::check(static_cast<bool>(m_expression), #m_expression, __FILE__, __LINE__)
@@ -0,0 +1,348 @@
+/**************************************************************************/
+/*  test_ik_core_frame_ring.cpp                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_core_test.h"
+
+#include "ik_core_frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace IKCore;
+
+namespace {
+
+struct alignas(64) RingMemory {
+	uint8_t bytes[4096];
+};
+
+} // namespace
+
+TEST_CASE("Frame ring delivers frames in order") {
+	RingMemory memory = {};
+	FrameRing producer;
+	FrameRing consumer;
+	CHECK(producer.create(memory.bytes, sizeof(memory.bytes), 4, 32) == FrameRing::RESULT_OK);
+	CHECK(consumer.attach(memory.bytes, sizeof(memory.bytes), FrameRing::SIDE_CONSUMER) == FrameRing::RESULT_OK);
+
+	uint32_t value = 0;
+	uint32_t size = 0;
+	uint64_t sequence = 0;
+	CHECK(consumer.pop(&value, sizeof(value), &size) == FrameRing::RESULT_EMPTY);
+	for (uint32_t frame_i = 0; frame_i < 3; frame_i++) {
+		CHECK(producer.push(&frame_i, sizeof(frame_i)) == FrameRing::RESULT_OK);
+	}
+	for (uint32_t frame_i = 0; frame_i < 3; frame_i++) {
+		CHECK(consumer.pop(&value, sizeof(value), &size, &sequence) == FrameRing::RESULT_OK);
+		CHECK(value == frame_i);
+		CHECK(size == sizeof(value));
+		CHECK(sequence == frame_i);
+	}
+	CHECK(consumer.pop(&value, sizeof(value), &size) == FrameRing::RESULT_EMPTY);
+	CHECK(consumer.get_read_count() == 3);
+
+	uint8_t large[33] = {};
+	CHECK(producer.push(large, sizeof(large)) == FrameRing::RESULT_TOO_LARGE);
+	CHECK(consumer.attach(large + 1, sizeof(large) - 1, FrameRing::SIDE_CONSUMER) == FrameRing::RESULT_INVALID);
+}
+
+TEST_CASE("Frame ring reports overruns and skips to the latest frame") {
+	RingMemory memory = {};
+	FrameRing producer;
+	FrameRing consumer;
+	producer.create(memory.bytes, sizeof(memory.bytes), 4, 32);
+	consumer.attach(memory.bytes, sizeof(memory.bytes), FrameRing::SIDE_CONSUMER);
+	for (uint32_t frame_i = 0; frame_i < 10; frame_i++) {
+		producer.push(&frame_i, sizeof(frame_i));
+	}
+	uint32_t value = 0;
+	uint32_t size = 0;
+	CHECK(consumer.pop(&value, sizeof(value), &size) == FrameRing::RESULT_OVERRUN);
+	CHECK(consumer.pop(&value, sizeof(value), &size) == FrameRing::RESULT_OK);
+	CHECK(value == 6);
+
+	CHECK(consumer.pop_latest(&value, sizeof(value), &size) == FrameRing::RESULT_OK);
+	CHECK(value == 9);
+	CHECK(consumer.pop_latest(&value, sizeof(value), &size) == FrameRing::RESULT_EMPTY);
+}
+
+TEST_CASE("Frame ring detects a frame rewritten during a read") {
+	RingMemory memory = {};
+	FrameRing producer;
+	FrameRing consumer;
+	producer.create(memory.bytes, sizeof(memory.bytes), 4, 32);
+	consumer.attach(memory.bytes, sizeof(memory.bytes), FrameRing::SIDE_CONSUMER);
+	const uint32_t frame = 7;
+	producer.push(&frame, sizeof(frame));
+	// Mark slot 0 as mid-write, as the producer would when lapping the reader.
+	FrameRing::SlotHeader *slot = reinterpret_cast<FrameRing::SlotHeader *>(memory.bytes + sizeof(FrameRing::RingHeader));
+	slot->sequence.store(9, std::memory_order_relaxed);
+	uint32_t value = 0;
+	uint32_t size = 0;
+	CHECK(consumer.pop(&value, sizeof(value), &size) != FrameRing::RESULT_OK);
+}
+
+TEST_CASE("Frame ring resyncs to the producer after a lapped slot") {
+	RingMemory memory = {};
+	FrameRing producer;
+	FrameRing consumer;
+	producer.create(memory.bytes, sizeof(memory.bytes), 4, 32);
+	consumer.attach(memory.bytes, sizeof(memory.bytes), FrameRing::SIDE_CONSUMER);
+	for (uint32_t frame_i = 0; frame_i < 4; frame_i++) {
+		producer.push(&frame_i, sizeof(frame_i));
+	}
+	// The consumer saw a write count of 4, but by the time it reads slot 0
+	// the producer is already writing frame 8 there.
+	FrameRing::SlotHeader *slot = reinterpret_cast<FrameRing::SlotHeader *>(memory.bytes + sizeof(FrameRing::RingHeader));
+	slot->sequence.store(2 * 8 + 1, std::memory_order_relaxed);
+	uint32_t value = 0;
+	uint32_t size = 0;
+	CHECK(consumer.pop(&value, sizeof(value), &size) == FrameRing::RESULT_OVERRUN);
+	// Frames 0 to 5 are gone or about to be; stepping one frame at a time
+	// would fail again on each of them.
+	CHECK(consumer.get_read_count() == 6);
+}
+
+#ifndef _WIN32
+
+namespace {
+
+static constexpr uint32_t SLOT_COUNT = 64;
+static constexpr uint32_t TRANSFORM_FLOATS = 7;
+
+// Every float of a throughput frame carries its frame number, so a torn copy
+// shows up as a mix of two numbers.
+struct ThroughputFrame {
+	uint64_t number;
+	float values[4 * TRANSFORM_FLOATS];
+};
+
+struct PingFrame {
+	uint64_t number;
+	float target[TRANSFORM_FLOATS];
+};
+
+struct PongFrame {
+	uint64_t number;
+	float rotations[4 * 4];
+};
+
+struct SharedRings {
+	void *memory = nullptr;
+	size_t ring_size = 0;
+	size_t size = 0;
+
+	uint8_t *get_ring(int p_index) const { return static_cast<uint8_t *>(memory) + p_index * ring_size; }
+};
+
+SharedRings map_rings() {
+	SharedRings rings;
+	rings.ring_size = (FrameRing::get_required_size(SLOT_COUNT, sizeof(ThroughputFrame)) + 4095) & ~size_t(4095);
+	rings.size = rings.ring_size * 2;
+	void *memory = mmap(nullptr, rings.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	rings.memory = memory == MAP_FAILED ? nullptr : memory;
+	return rings;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point p_start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - p_start).count();
+}
+
+int wait_for_child(pid_t p_child) {
+	int status = 0;
+	waitpid(p_child, &status, 0);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : 100;
+}
+
+} // namespace
+
+TEST_CASE("Shared memory opens only objects large enough") {
+	char name[64];
+	std::snprintf(name, sizeof(name), "/ik_core_test_%d", int(getpid()));
+	SharedMemory::unlink(name);
+	SharedMemory created;
+	CHECK(created.create(name, 8192));
+	SharedMemory opened;
+	CHECK(!opened.open(name, 8193));
+	CHECK(opened.open(name, 4096));
+	CHECK(opened.get_size() == 4096);
+	CHECK(opened.open(name, 0));
+	CHECK(opened.get_size() == 8192);
+	opened.close();
+	created.close();
+	CHECK(SharedMemory::unlink(name));
+	CHECK(!opened.open(name, 0));
+}
+
+TEST_CASE("Frame ring streams between processes") {
+	SharedRings rings = map_rings();
+	CHECK(rings.memory != nullptr);
+	if (!rings.memory) {
+		return;
+	}
+	FrameRing producer;
+	producer.create(rings.get_ring(0), rings.ring_size, SLOT_COUNT, sizeof(ThroughputFrame));
+	const uint64_t frame_count = 500000;
+
+	const pid_t child = fork();
+	if (child == 0) {
+		FrameRing consumer;
+		if (consumer.attach(rings.get_ring(0), rings.ring_size, FrameRing::SIDE_CONSUMER) != FrameRing::RESULT_OK) {
+			_exit(2);
+		}
+		ThroughputFrame frame;
+		uint32_t size = 0;
+		uint64_t received = 0;
+		uint64_t last = 0;
+		const auto start = std::chrono::steady_clock::now();
+		while (last + 1 < frame_count && seconds_since(start) < 20.0) {
+			const FrameRing::Result result = consumer.pop(&frame, sizeof(frame), &size);
+			if (result != FrameRing::RESULT_OK) {
+				// Spinning alone would starve the producer on a single core.
+				std::this_thread::yield();
+				continue;
+			}
+			for (float value : frame.values) {
+				if (value != float(frame.number)) {
+					_exit(3);
+				}
+			}
+			if (received > 0 && frame.number <= last) {
+				_exit(4);
+			}
+			last = frame.number;
+			received++;
+		}
+		_exit(received > 0 && last + 1 == frame_count ? 0 : 5);
+	}
+
+	ThroughputFrame frame;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t frame_i = 0; frame_i < frame_count; frame_i++) {
+		frame.number = frame_i;
+		for (float &value : frame.values) {
+			value = float(frame_i);
+		}
+		producer.push(&frame, sizeof(frame));
+	}
+	const double elapsed = seconds_since(start);
+	CHECK(wait_for_child(child) == 0);
+	std::printf("  frame ring: %.2f M frames/s pushed (%u bytes each)\n", frame_count / elapsed / 1e6, unsigned(sizeof(frame)));
+	munmap(rings.memory, rings.size);
+}
+
+TEST_CASE("Frame ring round trip through a polling process") {
+	SharedRings rings = map_rings();
+	CHECK(rings.memory != nullptr);
+	if (!rings.memory) {
+		return;
+	}
+	FrameRing targets;
+	FrameRing poses;
+	targets.create(rings.get_ring(0), rings.ring_size, SLOT_COUNT, sizeof(PingFrame));
+	poses.create(rings.get_ring(1), rings.ring_size, SLOT_COUNT, sizeof(PongFrame));
+	const uint64_t round_trips = 2000;
+
+	const pid_t child = fork();
+	if (child == 0) {
+		// The polling side: take the newest target, answer, publish. The answer
+		// is an echo so the timing is the transport's alone; EWBIK3D solving
+		// from these rings is covered by the module's doctests.
+		FrameRing target_reader;
+		FrameRing pose_writer;
+		target_reader.attach(rings.get_ring(0), rings.ring_size, FrameRing::SIDE_CONSUMER);
+		pose_writer.attach(rings.get_ring(1), rings.ring_size, FrameRing::SIDE_PRODUCER);
+		PingFrame ping;
+		PongFrame pong;
+		uint32_t size = 0;
+		const auto start = std::chrono::steady_clock::now();
+		while (seconds_since(start) < 20.0) {
+			if (target_reader.pop_latest(&ping, sizeof(ping), &size) != FrameRing::RESULT_OK) {
+				std::this_thread::yield();
+				continue;
+			}
+			pong.number = ping.number;
+			for (int32_t bone_i = 0; bone_i < 3; bone_i++) {
+				const float identity[4] = { 0, 0, 0, 1 };
+				std::memcpy(pong.rotations + bone_i * 4, identity, sizeof(identity));
+			}
+			std::memcpy(pong.rotations + 3 * 4, ping.target, 4 * sizeof(float));
+			pose_writer.push(&pong, sizeof(pong));
+			if (ping.number + 1 == round_trips) {
+				_exit(0);
+			}
+		}
+		_exit(5);
+	}
+
+	PingFrame ping = {};
+	PongFrame pong;
+	uint32_t size = 0;
+	bool in_order = true;
+	std::vector<double> latencies;
+	latencies.reserve(round_trips);
+	for (uint64_t trip_i = 0; trip_i < round_trips && in_order; trip_i++) {
+		ping.number = trip_i;
+		const float angle = float(trip_i) * 0.01f;
+		const float target[TRANSFORM_FLOATS] = { 0, 0, 0, 1, std::cos(angle), 2.0f, std::sin(angle) };
+		std::memcpy(ping.target, target, sizeof(target));
+		const auto sent = std::chrono::steady_clock::now();
+		targets.push(&ping, sizeof(ping));
+		while (seconds_since(sent) < 5.0) {
+			if (poses.pop(&pong, sizeof(pong), &size) == FrameRing::RESULT_OK) {
+				break;
+			}
+			std::this_thread::yield();
+		}
+		latencies.push_back(seconds_since(sent));
+		in_order = pong.number == trip_i;
+	}
+	CHECK(in_order);
+	CHECK(wait_for_child(child) == 0);
+	std::sort(latencies.begin(), latencies.end());
+	if (!latencies.empty()) {
+		std::printf("  frame ring: round trip, median %.1f us, p99 %.1f us\n", latencies[latencies.size() / 2] * 1e6, latencies[latencies.size() * 99 / 100] * 1e6);
+	}
+	munmap(rings.memory, rings.size);
+}
+
+#endif
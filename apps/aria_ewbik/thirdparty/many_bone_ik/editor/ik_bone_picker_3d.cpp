@@ -0,0 +1,134 @@
+/**************************************************************************/
+/*  ik_bone_picker_3d.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_bone_picker_3d.h"
+
+#include "scene/3d/skeleton_3d.h"
+
+namespace {
+struct BoneCollector {
+	LocalVector<int32_t> *bones = nullptr;
+
+	_FORCE_INLINE_ bool operator()(void *p_data) {
+		bones->push_back(int32_t(reinterpret_cast<uintptr_t>(p_data)));
+		return false;
+	}
+};
+} // namespace
+
+void IKBonePicker3D::set_radius(real_t p_radius) {
+	ERR_FAIL_COND(p_radius < 0.0);
+	radius = p_radius;
+	for (const Bone &bone : bones) {
+		bvh.update(bone.id, _get_bounds(bone.position));
+	}
+}
+
+void IKBonePicker3D::resize(int32_t p_bone_count) {
+	ERR_FAIL_COND(p_bone_count < 0);
+	const int32_t old_count = bones.size();
+	for (int32_t bone_i = p_bone_count; bone_i < old_count; bone_i++) {
+		bvh.remove(bones[bone_i].id);
+	}
+	bones.resize(p_bone_count);
+	for (int32_t bone_i = old_count; bone_i < p_bone_count; bone_i++) {
+		bones[bone_i].position = Vector3();
+		bones[bone_i].id = bvh.insert(_get_bounds(Vector3()), reinterpret_cast<void *>(uintptr_t(bone_i)));
+	}
+}
+
+void IKBonePicker3D::clear() {
+	bvh.clear();
+	bones.clear();
+	refit_count = 0;
+}
+
+void IKBonePicker3D::set_bone_position(int32_t p_bone, const Vector3 &p_position) {
+	ERR_FAIL_INDEX(p_bone, int32_t(bones.size()));
+	Bone &bone = bones[p_bone];
+	if (bone.position == p_position) {
+		return;
+	}
+	bone.position = p_position;
+	if (bvh.update(bone.id, _get_bounds(p_position))) {
+		refit_count++;
+	}
+}
+
+Vector3 IKBonePicker3D::get_bone_position(int32_t p_bone) const {
+	ERR_FAIL_INDEX_V(p_bone, int32_t(bones.size()), Vector3());
+	return bones[p_bone].position;
+}
+
+void IKBonePicker3D::update(const Skeleton3D *p_skeleton) {
+	ERR_FAIL_NULL(p_skeleton);
+	const int32_t bone_count = p_skeleton->get_bone_count();
+	if (bone_count != int32_t(bones.size())) {
+		resize(bone_count);
+	}
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		set_bone_position(bone_i, p_skeleton->get_bone_global_pose(bone_i).origin);
+	}
+}
+
+void IKBonePicker3D::pick_frustum(const Vector3 p_near[4], const Vector3 p_far[4], LocalVector<int32_t> &r_bones) {
+	Vector3 points[8];
+	Vector3 center;
+	for (int32_t corner_i = 0; corner_i < 4; corner_i++) {
+		points[corner_i] = p_near[corner_i];
+		points[corner_i + 4] = p_far[corner_i];
+		center += p_near[corner_i] + p_far[corner_i];
+	}
+	center /= 8.0;
+
+	// DynamicBVH culls against outward facing planes.
+	Plane planes[6];
+	for (int32_t corner_i = 0; corner_i < 4; corner_i++) {
+		const int32_t next = (corner_i + 1) % 4;
+		planes[corner_i] = Plane(p_near[corner_i], p_far[corner_i], p_near[next]);
+	}
+	planes[4] = Plane(p_near[0], p_near[1], p_near[2]);
+	planes[5] = Plane(p_far[0], p_far[1], p_far[2]);
+	for (Plane &plane : planes) {
+		if (plane.is_point_over(center)) {
+			plane = -plane;
+		}
+	}
+
+	BoneCollector collector;
+	collector.bones = &r_bones;
+	bvh.convex_query(planes, 6, points, 8, collector);
+}
+
+void IKBonePicker3D::pick_segment(const Vector3 &p_from, const Vector3 &p_to, LocalVector<int32_t> &r_bones) {
+	BoneCollector collector;
+	collector.bones = &r_bones;
+	bvh.ray_query(p_from, p_to, collector);
+}
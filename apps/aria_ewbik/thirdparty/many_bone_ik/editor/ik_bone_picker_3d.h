@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*  ik_bone_picker_3d.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/dynamic_bvh.h"
+#include "core/math/plane.h"
+#include "core/templates/local_vector.h"
+
+class Skeleton3D;
+
+// Bounds of every bone's handle and kusudama sphere in skeleton space, kept
+// in a DynamicBVH so a pick only tests the bones near the cursor. Bones are
+// refit one by one as they move; bones that did not move cost a comparison.
+// Needs no renderer, only bone positions and a pick volume.
+class IKBonePicker3D {
+	struct Bone {
+		DynamicBVH::ID id;
+		Vector3 position;
+	};
+
+	DynamicBVH bvh;
+	LocalVector<Bone> bones;
+	// Half the extent of each bone's bounds. Matches the kusudama gizmo sphere.
+	real_t radius = 0.02;
+	uint64_t refit_count = 0;
+
+	_FORCE_INLINE_ AABB _get_bounds(const Vector3 &p_position) const {
+		return AABB(p_position - Vector3(radius, radius, radius), Vector3(radius, radius, radius) * 2.0);
+	}
+
+public:
+	void set_radius(real_t p_radius);
+	real_t get_radius() const { return radius; }
+
+	// Grows or shrinks to p_bone_count bones. New bones start at the origin.
+	void resize(int32_t p_bone_count);
+	int32_t get_bone_count() const { return bones.size(); }
+	void clear();
+
+	void set_bone_position(int32_t p_bone, const Vector3 &p_position);
+	Vector3 get_bone_position(int32_t p_bone) const;
+	// Matches the bones to the skeleton's global poses.
+	void update(const Skeleton3D *p_skeleton);
+	uint64_t get_refit_count() const { return refit_count; }
+
+	// Appends the bones whose bounds touch the volume between four corners on
+	// a near plane and the matching four on a far plane, in skeleton space.
+	// Corners go around the volume in order.
+	void pick_frustum(const Vector3 p_near[4], const Vector3 p_far[4], LocalVector<int32_t> &r_bones);
+	// Appends the bones whose bounds the segment crosses.
+	void pick_segment(const Vector3 &p_from, const Vector3 &p_to, LocalVector<int32_t> &r_bones);
+};
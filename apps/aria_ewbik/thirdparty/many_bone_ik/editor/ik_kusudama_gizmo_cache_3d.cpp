@@ -0,0 +1,168 @@
+/**************************************************************************/
+/*  ik_kusudama_gizmo_cache_3d.cpp                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_kusudama_gizmo_cache_3d.h"
+
+#include "scene/resources/surface_tool.h"
+
+#include "../src/ik_open_cone_3d.h"
+
+Ref<ArrayMesh> IKKusudamaGizmoCache3D::create_unit_sphere_mesh() {
+	// Code copied from the SphereMesh.
+	const int32_t rings = 8;
+	const int32_t radial_segments = 8;
+
+	Ref<SurfaceTool> surface_tool;
+	surface_tool.instantiate();
+	surface_tool->begin(Mesh::PRIMITIVE_TRIANGLES);
+	const int32_t MESH_CUSTOM_0 = 0;
+	surface_tool->set_custom_format(MESH_CUSTOM_0, SurfaceTool::CustomFormat::CUSTOM_RGBA_HALF);
+
+	int32_t point = 0;
+	int32_t thisrow = 0;
+	int32_t prevrow = 0;
+	LocalVector<int32_t> indices;
+	for (int32_t j = 0; j <= (rings + 1); j++) {
+		const float v = float(j) / (rings + 1);
+		const float w = Math::sin(Math::PI * v);
+		const float y = Math::cos(Math::PI * v);
+
+		for (int32_t i = 0; i <= radial_segments; i++) {
+			const float u = float(i) / radial_segments;
+			const float x = Math::sin(u * Math::TAU);
+			const float z = Math::cos(u * Math::TAU);
+
+			const Vector3 normal = Vector3(x * w, y, z * w).normalized();
+			surface_tool->set_custom(MESH_CUSTOM_0, Color(normal.x, normal.y, normal.z, 0));
+			surface_tool->set_normal(normal);
+			surface_tool->add_vertex(Vector3(x * w, y, z * w) * 0.02f);
+			point++;
+
+			if (i > 0 && j > 0) {
+				indices.push_back(prevrow + i - 1);
+				indices.push_back(prevrow + i);
+				indices.push_back(thisrow + i - 1);
+
+				indices.push_back(prevrow + i);
+				indices.push_back(thisrow + i);
+				indices.push_back(thisrow + i - 1);
+			}
+		}
+
+		prevrow = thisrow;
+		thisrow = point;
+	}
+	for (int32_t index : indices) {
+		surface_tool->add_index(index);
+	}
+	return surface_tool->commit(Ref<Mesh>(), RS::ARRAY_CUSTOM_RGBA_HALF << RS::ARRAY_FORMAT_CUSTOM0_SHIFT);
+}
+
+void IKKusudamaGizmoCache3D::write_cone_sequence(const Ref<IKKusudama3D> &p_kusudama, PackedFloat32Array &r_cone_sequence) {
+	const TypedArray<IKLimitCone3D> open_cones = p_kusudama->get_open_cones();
+	r_cone_sequence.resize(open_cones.size() * 12);
+	float *write = r_cone_sequence.ptrw();
+	for (int32_t cone_i = 0; cone_i < open_cones.size(); cone_i++) {
+		Ref<IKLimitCone3D> open_cone = open_cones[cone_i];
+		const Vector3 control_point = open_cone->get_control_point();
+		const Vector3 tangent_center_1 = open_cone->get_tangent_circle_center_next_1();
+		const Vector3 tangent_center_2 = open_cone->get_tangent_circle_center_next_2();
+		const float tangent_radius = open_cone->get_tangent_circle_radius_next();
+		float *cone = write + cone_i * 12;
+		cone[0] = control_point.x;
+		cone[1] = control_point.y;
+		cone[2] = control_point.z;
+		cone[3] = open_cone->get_radius();
+		cone[4] = tangent_center_1.x;
+		cone[5] = tangent_center_1.y;
+		cone[6] = tangent_center_1.z;
+		cone[7] = tangent_radius;
+		cone[8] = tangent_center_2.x;
+		cone[9] = tangent_center_2.y;
+		cone[10] = tangent_center_2.z;
+		cone[11] = tangent_radius;
+	}
+}
+
+void IKKusudamaGizmoCache3D::set_shader(const Ref<Shader> &p_shader) {
+	if (shader == p_shader) {
+		return;
+	}
+	shader = p_shader;
+	clear();
+}
+
+void IKKusudamaGizmoCache3D::begin_pass() {
+	pass++;
+}
+
+Ref<ShaderMaterial> IKKusudamaGizmoCache3D::get_material(BoneId p_bone, const Ref<IKKusudama3D> &p_kusudama, const Color &p_color) {
+	ERR_FAIL_COND_V(p_kusudama.is_null(), Ref<ShaderMaterial>());
+	write_cone_sequence(p_kusudama, scratch_cone_sequence);
+
+	Entry *entry = entries.getptr(p_bone);
+	if (!entry) {
+		entry = &entries.insert(p_bone, Entry())->value;
+		entry->material.instantiate();
+		entry->material->set_shader(shader);
+		counters.materials_created++;
+	} else if (entry->color == p_color && entry->cone_sequence == scratch_cone_sequence) {
+		entry->pass = pass;
+		counters.materials_reused++;
+		return entry->material;
+	} else {
+		counters.materials_updated++;
+	}
+	entry->pass = pass;
+	entry->cone_sequence = scratch_cone_sequence;
+	entry->color = p_color;
+	entry->material->set_shader_parameter("cone_sequence", entry->cone_sequence);
+	entry->material->set_shader_parameter("cone_count", int32_t(entry->cone_sequence.size() / 12));
+	entry->material->set_shader_parameter("kusudama_color", p_color);
+	return entry->material;
+}
+
+void IKKusudamaGizmoCache3D::end_pass() {
+	LocalVector<BoneId> stale;
+	for (const KeyValue<BoneId, Entry> &E : entries) {
+		if (E.value.pass != pass) {
+			stale.push_back(E.key);
+		}
+	}
+	for (BoneId bone : stale) {
+		entries.erase(bone);
+	}
+	counters.materials_evicted += stale.size();
+}
+
+void IKKusudamaGizmoCache3D::clear() {
+	counters.materials_evicted += entries.size();
+	entries.clear();
+}
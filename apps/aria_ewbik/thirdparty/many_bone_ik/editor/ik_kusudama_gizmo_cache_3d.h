@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*  ik_kusudama_gizmo_cache_3d.h                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/color.h"
+#include "core/templates/hash_map.h"
+#include "scene/resources/material.h"
+#include "scene/resources/mesh.h"
+
+#include "../src/ik_kusudama_3d.h"
+
+// Kusudama gizmo materials of one EWBIK3D, keyed by bone. Every bone draws
+// the same unit sphere; only the cone data and color differ, and they live
+// in the bone's material. A redraw is one pass: materials whose cone data
+// and color are unchanged since the last pass are reused as they are, the
+// rest get their shader parameters refreshed, and bones not drawn in the
+// pass are dropped at its end.
+class IKKusudamaGizmoCache3D {
+public:
+	struct Counters {
+		uint64_t materials_created = 0;
+		uint64_t materials_updated = 0;
+		uint64_t materials_reused = 0;
+		uint64_t materials_evicted = 0;
+	};
+
+private:
+	struct Entry {
+		PackedFloat32Array cone_sequence;
+		Color color;
+		Ref<ShaderMaterial> material;
+		uint64_t pass = 0;
+	};
+
+	Ref<Shader> shader;
+	HashMap<BoneId, Entry> entries;
+	PackedFloat32Array scratch_cone_sequence;
+	uint64_t pass = 0;
+	Counters counters;
+
+public:
+	// The sphere every kusudama gizmo draws, with each vertex normal copied to
+	// CUSTOM0 for the kusudama shader.
+	static Ref<ArrayMesh> create_unit_sphere_mesh();
+	// Packs the open cones as the kusudama shader's cone_sequence: per cone,
+	// the control point and radius, then both tangent circles and their radius.
+	static void write_cone_sequence(const Ref<IKKusudama3D> &p_kusudama, PackedFloat32Array &r_cone_sequence);
+
+	void set_shader(const Ref<Shader> &p_shader);
+	Ref<Shader> get_shader() const { return shader; }
+
+	void begin_pass();
+	Ref<ShaderMaterial> get_material(BoneId p_bone, const Ref<IKKusudama3D> &p_kusudama, const Color &p_color);
+	void end_pass();
+	void clear();
+
+	int32_t get_material_count() const { return entries.size(); }
+	const Counters &get_counters() const { return counters; }
+};
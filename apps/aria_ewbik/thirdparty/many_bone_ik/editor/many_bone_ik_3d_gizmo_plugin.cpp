@@ -37,7 +37,6 @@
 #include "editor/scene/3d/node_3d_editor_plugin.h"
 #include "scene/3d/mesh_instance_3d.h"
 #include "scene/3d/skeleton_3d.h"
-#include "scene/resources/surface_tool.h"
 
 #include "../src/ik_bone_3d.h"
 #include "../src/ik_kusudama_3d.h"
@@ -67,6 +66,7 @@ void ManyBoneIK3DGizmoPlugin::redraw(EditorNode3DGizmo *p_gizmo) {
 	p_gizmo->clear();
 	if (!skeleton || !skeleton->get_bone_count()) {
 		current_many_bone_ik_id = ObjectID(); // Reset if no valid skeleton
+		kusudama_caches.erase(many_bone_ik->get_instance_id());
 		return;
 	}
 
@@ -80,9 +80,19 @@ void ManyBoneIK3DGizmoPlugin::redraw(EditorNode3DGizmo *p_gizmo) {
 				}
 				skeleton->call_deferred("add_child", handles_mesh_instance);
 			}
-			handles_mesh_instance->set_skeleton_path(NodePath(".."));
 		}
 		current_many_bone_ik_id = new_ik_id;
+
+		// Drop the materials of nodes that were freed since the last switch.
+		LocalVector<ObjectID> freed_ids;
+		for (const KeyValue<ObjectID, IKKusudamaGizmoCache3D> &E : kusudama_caches) {
+			if (!ObjectDB::get_instance(E.key)) {
+				freed_ids.push_back(E.key);
+			}
+		}
+		for (const ObjectID &freed_id : freed_ids) {
+			kusudama_caches.erase(freed_id);
+		}
 	}
 
 	int selected = -1;
@@ -92,6 +102,16 @@ void ManyBoneIK3DGizmoPlugin::redraw(EditorNode3DGizmo *p_gizmo) {
 	}
 	Color selected_bone_color = EDITOR_GET("editors/3d_gizmos/gizmo_colors/selected_bone");
 
+	if (kusudama_mesh.is_null()) {
+		kusudama_mesh = IKKusudamaGizmoCache3D::create_unit_sphere_mesh();
+	}
+	IKKusudamaGizmoCache3D &kusudama_cache = kusudama_caches[new_ik_id];
+	kusudama_cache.set_shader(kusudama_shader);
+	kusudama_cache.begin_pass();
+
+	// The same for every bone, so only the constraint orientation is left per bone.
+	const Transform3D skeleton_to_gizmo = many_bone_ik->get_relative_transform(many_bone_ik->get_owner()).affine_inverse() * skeleton->get_relative_transform(skeleton->get_owner()) * many_bone_ik->get_godot_skeleton_transform_inverse();
+
 	int current_bone_index = 0;
 	Vector<int> bones_to_process = skeleton->get_parentless_bones();
 
@@ -108,7 +128,7 @@ void ManyBoneIK3DGizmoPlugin::redraw(EditorNode3DGizmo *p_gizmo) {
 			if (ik_bone.is_null() || ik_bone->get_constraint().is_null()) {
 				continue;
 			}
-			create_gizmo_mesh(current_bone_idx, ik_bone, p_gizmo, current_bone_color, skeleton, many_bone_ik);
+			create_gizmo_mesh(current_bone_idx, ik_bone, p_gizmo, current_bone_color, skeleton, skeleton_to_gizmo, kusudama_cache);
 		}
 
 		current_bone_index++;
@@ -125,153 +145,28 @@ void ManyBoneIK3DGizmoPlugin::redraw(EditorNode3DGizmo *p_gizmo) {
 			bones_to_process.push_back(child_bones_vector[i]);
 		}
 	}
+	kusudama_cache.end_pass();
 }
 
-void ManyBoneIK3DGizmoPlugin::create_gizmo_mesh(BoneId current_bone_idx, Ref<IKBone3D> ik_bone, EditorNode3DGizmo *p_gizmo, Color current_bone_color, Skeleton3D *many_bone_ik_skeleton, EWBIK3D *p_many_bone_ik) {
+void ManyBoneIK3DGizmoPlugin::create_gizmo_mesh(BoneId current_bone_idx, Ref<IKBone3D> ik_bone, EditorNode3DGizmo *p_gizmo, Color current_bone_color, Skeleton3D *many_bone_ik_skeleton, const Transform3D &p_skeleton_to_gizmo, IKKusudamaGizmoCache3D &r_kusudama_cache) {
 	Ref<IKKusudama3D> ik_kusudama = ik_bone->get_constraint();
 	if (ik_kusudama.is_null()) {
 		return;
 	}
-	const TypedArray<IKLimitCone3D> &open_cones = ik_kusudama->get_open_cones();
-	if (!open_cones.size()) {
-		return;
-	}
-	BoneId parent_idx = many_bone_ik_skeleton->get_bone_parent(current_bone_idx);
-	LocalVector<int> bones;
-	LocalVector<float> weights;
-	bones.resize(4);
-	weights.resize(4);
-	for (int i = 0; i < 4; i++) {
-		bones[i] = 0;
-		weights[i] = 0;
-	}
-	bones[0] = parent_idx;
-	weights[0] = 1;
-
-	Transform3D constraint_relative_to_the_skeleton = p_many_bone_ik->get_relative_transform(p_many_bone_ik->get_owner()).affine_inverse() * many_bone_ik_skeleton->get_relative_transform(many_bone_ik_skeleton->get_owner()) * p_many_bone_ik->get_godot_skeleton_transform_inverse() * ik_bone->get_constraint_orientation_transform()->get_global_transform();
-	PackedFloat32Array kusudama_open_cones;
-	Ref<IKKusudama3D> kusudama = ik_bone->get_constraint();
-	for (int32_t cone_i = 0; cone_i < open_cones.size(); cone_i++) {
-		Ref<IKLimitCone3D> open_cone = open_cones[cone_i];
-		Vector3 control_point = open_cone->get_control_point();
-		PackedFloat32Array new_kusudama_open_cones;
-		new_kusudama_open_cones.resize(4 * 3);
-		new_kusudama_open_cones.fill(0.0f);
-		new_kusudama_open_cones.write[0] = control_point.x;
-		new_kusudama_open_cones.write[1] = control_point.y;
-		new_kusudama_open_cones.write[2] = control_point.z;
-		float radius = open_cone->get_radius();
-		new_kusudama_open_cones.write[3] = radius;
-
-		Vector3 tangent_center_1 = open_cone->get_tangent_circle_center_next_1();
-		new_kusudama_open_cones.write[4] = tangent_center_1.x;
-		new_kusudama_open_cones.write[5] = tangent_center_1.y;
-		new_kusudama_open_cones.write[6] = tangent_center_1.z;
-		float tangent_radius = open_cone->get_tangent_circle_radius_next();
-		new_kusudama_open_cones.write[7] = tangent_radius;
-
-		Vector3 tangent_center_2 = open_cone->get_tangent_circle_center_next_2();
-		new_kusudama_open_cones.write[8] = tangent_center_2.x;
-		new_kusudama_open_cones.write[9] = tangent_center_2.y;
-		new_kusudama_open_cones.write[10] = tangent_center_2.z;
-		new_kusudama_open_cones.write[11] = tangent_radius;
-
-		kusudama_open_cones.append_array(new_kusudama_open_cones);
-	}
-	if (current_bone_idx >= many_bone_ik_skeleton->get_bone_count()) {
-		return;
-	}
-	if (current_bone_idx == -1) {
-		return;
-	}
-	if (parent_idx >= many_bone_ik_skeleton->get_bone_count()) {
+	if (ik_kusudama->get_open_cones().is_empty()) {
 		return;
 	}
-	if (parent_idx <= -1) {
+	if (current_bone_idx < 0 || current_bone_idx >= many_bone_ik_skeleton->get_bone_count()) {
 		return;
 	}
-	// Code copied from the SphereMesh.
-	int rings = 8;
-
-	int i = 0, j = 0, prevrow = 0, thisrow = 0, point = 0;
-	float x, y, z;
-
-	Vector<Vector3> points;
-	Vector<Vector3> normals;
-	Vector<int> indices;
-	point = 0;
-
-	thisrow = 0;
-	prevrow = 0;
-	for (j = 0; j <= (rings + 1); j++) {
-		int radial_segments = 8;
-		float v = j;
-		float w;
-
-		v /= (rings + 1);
-		w = sin(Math::PI * v);
-		y = cos(Math::PI * v);
-
-		for (i = 0; i <= radial_segments; i++) {
-			float u = i;
-			u /= radial_segments;
-
-			x = sin(u * Math::TAU);
-			z = cos(u * Math::TAU);
-
-			Vector3 p = Vector3(x * w, y, z * w) * 0.02f;
-			points.push_back(p);
-			Vector3 normal = Vector3(x * w, y, z * w);
-			normals.push_back(normal.normalized());
-			point++;
-
-			if (i > 0 && j > 0) {
-				indices.push_back(prevrow + i - 1);
-				indices.push_back(prevrow + i);
-				indices.push_back(thisrow + i - 1);
-
-				indices.push_back(prevrow + i);
-				indices.push_back(thisrow + i);
-				indices.push_back(thisrow + i - 1);
-			};
-		};
-
-		prevrow = thisrow;
-		thisrow = point;
-	}
-	if (!indices.size()) {
+	BoneId parent_idx = many_bone_ik_skeleton->get_bone_parent(current_bone_idx);
+	if (parent_idx <= -1 || parent_idx >= many_bone_ik_skeleton->get_bone_count()) {
 		return;
 	}
-	Ref<SurfaceTool> surface_tool;
-	surface_tool.instantiate();
-	surface_tool->begin(Mesh::PRIMITIVE_TRIANGLES);
-	const int32_t MESH_CUSTOM_0 = 0;
-	surface_tool->set_custom_format(MESH_CUSTOM_0, SurfaceTool::CustomFormat::CUSTOM_RGBA_HALF);
-	for (int32_t point_i = 0; point_i < points.size(); point_i++) {
-		surface_tool->set_bones(bones);
-		surface_tool->set_weights(weights);
-		Color c;
-		c.r = normals[point_i].x;
-		c.g = normals[point_i].y;
-		c.b = normals[point_i].z;
-		c.a = 0;
-		surface_tool->set_custom(MESH_CUSTOM_0, c);
-		surface_tool->set_normal(normals[point_i]);
-		surface_tool->add_vertex(points[point_i]);
-	}
-	for (int32_t index_i : indices) {
-		surface_tool->add_index(index_i);
-	}
-	Ref<ShaderMaterial> kusudama_material;
-	kusudama_material.instantiate();
-	kusudama_material->set_shader(kusudama_shader);
-	kusudama_material->set_shader_parameter("cone_sequence", kusudama_open_cones);
-	int32_t cone_count = kusudama->get_open_cones().size();
-	kusudama_material->set_shader_parameter("cone_count", cone_count);
-	kusudama_material->set_shader_parameter("kusudama_color", current_bone_color);
-	p_gizmo->add_mesh(
-			surface_tool->commit(Ref<Mesh>(), RS::ARRAY_CUSTOM_RGBA_HALF << RS::ARRAY_FORMAT_CUSTOM0_SHIFT),
-			kusudama_material, constraint_relative_to_the_skeleton);
+	Ref<ShaderMaterial> kusudama_material = r_kusudama_cache.get_material(current_bone_idx, ik_kusudama, current_bone_color);
+	ERR_FAIL_COND(kusudama_material.is_null());
+	Transform3D constraint_relative_to_the_skeleton = p_skeleton_to_gizmo * ik_bone->get_constraint_orientation_transform()->get_global_transform();
+	p_gizmo->add_mesh(kusudama_mesh, kusudama_material, constraint_relative_to_the_skeleton);
 }
 
 int32_t ManyBoneIK3DGizmoPlugin::get_priority() const {
@@ -284,6 +179,14 @@ EditorPluginManyBoneIK::EditorPluginManyBoneIK() {
 	Node3DEditor::get_singleton()->add_gizmo_plugin(many_bone_ik_gizmo_plugin);
 }
 
+void ManyBoneIK3DGizmoPlugin::_update_bone_picker(Skeleton3D *p_skeleton) const {
+	if (p_skeleton->get_instance_id() != bone_picker_skeleton_id) {
+		bone_picker.clear();
+		bone_picker_skeleton_id = p_skeleton->get_instance_id();
+	}
+	bone_picker.update(p_skeleton);
+}
+
 int ManyBoneIK3DGizmoPlugin::subgizmos_intersect_ray(const EditorNode3DGizmo *p_gizmo, Camera3D *p_camera, const Vector2 &p_point) const {
 	Skeleton3D *skeleton = Object::cast_to<EWBIK3D>(p_gizmo->get_node_3d())->get_skeleton();
 	ERR_FAIL_COND_V(!skeleton, -1);
@@ -302,14 +205,38 @@ int ManyBoneIK3DGizmoPlugin::subgizmos_intersect_ray(const EditorNode3DGizmo *p_
 	Transform3D gt = skeleton->get_global_transform();
 	int closest_idx = -1;
 	real_t closest_dist = 1e10;
-	const int bone_count = skeleton->get_bone_count();
-
-	for (int i = 0; i < bone_count; i++) {
-		Vector3 joint_pos_3d = gt.xform(skeleton->get_bone_global_pose(i).origin);
+	_update_bone_picker(skeleton);
+
+	// Only the bones whose bounds reach into the grab square around the cursor are tested.
+	const Transform3D to_skeleton = gt.affine_inverse();
+	const Vector2 corner_offsets[4] = { Vector2(-1, -1), Vector2(1, -1), Vector2(1, 1), Vector2(-1, 1) };
+	Vector3 near_corners[4];
+	Vector3 far_corners[4];
+	for (int32_t corner_i = 0; corner_i < 4; corner_i++) {
+		const Vector2 corner = p_point + corner_offsets[corner_i] * grab_threshold;
+		const Vector3 corner_origin = p_camera->project_ray_origin(corner);
+		const Vector3 corner_normal = p_camera->project_ray_normal(corner);
+		near_corners[corner_i] = to_skeleton.xform(corner_origin + corner_normal * p_camera->get_near());
+		far_corners[corner_i] = to_skeleton.xform(corner_origin + corner_normal * p_camera->get_far());
+	}
+	LocalVector<int32_t> candidates;
+	bone_picker.pick_frustum(near_corners, far_corners, candidates);
+
+	// A click on a kusudama sphere selects its bone too.
+	const Vector3 local_ray_origin = to_skeleton.xform(p_camera->project_ray_origin(p_point));
+	const Vector3 local_ray_normal = to_skeleton.basis.xform(p_camera->project_ray_normal(p_point)).normalized();
+	for (int32_t i : candidates) {
+		const Vector3 joint_pos_local = bone_picker.get_bone_position(i);
+		Vector3 joint_pos_3d = gt.xform(joint_pos_local);
 		Vector2 joint_pos_2d = p_camera->unproject_position(joint_pos_3d);
 		real_t dist_3d = ray_from.distance_to(joint_pos_3d);
 		real_t dist_2d = p_point.distance_to(joint_pos_2d);
-		if (dist_2d < grab_threshold && dist_3d < closest_dist) {
+		bool hit = dist_2d < grab_threshold;
+		if (!hit) {
+			const Vector3 to_joint = joint_pos_local - local_ray_origin;
+			hit = to_joint.dot(local_ray_normal) > 0.0 && to_joint.cross(local_ray_normal).length() < bone_picker.get_radius() && many_bone_ik->find_constraint(skeleton->get_bone_name(i)) != -1;
+		}
+		if (hit && dist_3d < closest_dist) {
 			closest_dist = dist_3d;
 			closest_idx = i;
 		}
@@ -396,26 +323,36 @@ void ManyBoneIK3DGizmoPlugin::_draw_handles() {
 	ERR_FAIL_COND(!skeleton);
 	const int bone_count = skeleton->get_bone_count();
 
-	handles_mesh->clear_surfaces();
-
 	if (bone_count) {
 		handles_mesh_instance->show();
+		_update_bone_picker(skeleton);
 
-		handles_mesh->surface_begin(Mesh::PRIMITIVE_POINTS);
-
+		// Per instance: a 3x4 transform by rows, then the color.
+		const int32_t stride = 16;
+		handles_buffer.resize(bone_count * stride);
+		float *write = handles_buffer.ptrw();
+		const int32_t selected_bone = many_bone_ik->get_ui_selected_bone();
 		for (int i = 0; i < bone_count; i++) {
 			Color c;
-			if (i == many_bone_ik->get_ui_selected_bone()) {
+			if (i == selected_bone) {
 				c = Color(1, 1, 0);
 			} else {
 				c = Color(0.1, 0.25, 0.8);
 			}
-			Vector3 point = skeleton->get_bone_global_pose(i).origin;
-			handles_mesh->surface_set_color(c);
-			handles_mesh->surface_add_vertex(point);
+			const Vector3 point = bone_picker.get_bone_position(i);
+			float *instance = write + i * stride;
+			const float instance_data[stride] = {
+				1, 0, 0, float(point.x),
+				0, 1, 0, float(point.y),
+				0, 0, 1, float(point.z),
+				c.r, c.g, c.b, c.a
+			};
+			memcpy(instance, instance_data, sizeof(instance_data));
+		}
+		if (handles_multimesh->get_instance_count() != bone_count) {
+			handles_multimesh->set_instance_count(bone_count);
 		}
-		handles_mesh->surface_end();
-		handles_mesh->surface_set_material(0, handle_material);
+		handles_multimesh->set_buffer(handles_buffer);
 	} else {
 		handles_mesh_instance->hide();
 	}
@@ -567,9 +504,21 @@ ManyBoneIK3DGizmoPlugin::ManyBoneIK3DGizmoPlugin() {
 	handle_material->set_shader_parameter("point_size", handle->get_width());
 	handle_material->set_shader_parameter("texture_albedo", handle);
 
-	handles_mesh_instance = memnew(MeshInstance3D);
+	Array handle_point_arrays;
+	handle_point_arrays.resize(Mesh::ARRAY_MAX);
+	handle_point_arrays[Mesh::ARRAY_VERTEX] = PackedVector3Array({ Vector3() });
+	handle_point_arrays[Mesh::ARRAY_COLOR] = PackedColorArray({ Color(1, 1, 1) });
+	Ref<ArrayMesh> handle_point;
+	handle_point.instantiate();
+	handle_point->add_surface_from_arrays(Mesh::PRIMITIVE_POINTS, handle_point_arrays);
+	handle_point->surface_set_material(0, handle_material);
+	handles_multimesh->set_transform_format(MultiMesh::TRANSFORM_3D);
+	handles_multimesh->set_use_colors(true);
+	handles_multimesh->set_mesh(handle_point);
+
+	handles_mesh_instance = memnew(MultiMeshInstance3D);
 	handles_mesh_instance->set_cast_shadows_setting(GeometryInstance3D::SHADOW_CASTING_SETTING_OFF);
-	handles_mesh_instance->set_mesh(handles_mesh);
+	handles_mesh_instance->set_multimesh(handles_multimesh);
 	edit_mode_button = memnew(Button);
 	edit_mode_button->set_text(TTR("Edit Mode"));
 	edit_mode_button->set_flat(true);
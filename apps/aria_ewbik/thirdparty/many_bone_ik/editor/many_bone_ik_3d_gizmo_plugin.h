@@ -32,16 +32,19 @@
 
 #include "../src/ik_bone_3d.h"
 #include "../src/many_bone_ik_3d.h"
+#include "ik_bone_picker_3d.h"
+#include "ik_kusudama_gizmo_cache_3d.h"
 
 #include "editor/inspector/editor_inspector.h"
 #include "editor/scene/3d/skeleton_3d_editor_plugin.h"
 #include "editor/settings/editor_settings.h"
 #include "scene/3d/camera_3d.h"
 #include "scene/3d/mesh_instance_3d.h"
+#include "scene/3d/multimesh_instance_3d.h"
 #include "scene/3d/node_3d.h"
 #include "scene/3d/skeleton_3d.h"
-#include "scene/resources/immediate_mesh.h"
 #include "scene/resources/material.h"
+#include "scene/resources/multimesh.h"
 
 class Joint;
 class PhysicalBone3D;
@@ -51,13 +54,18 @@ class Button;
 class ManyBoneIK3DGizmoPlugin : public EditorNode3DGizmoPlugin {
 	GDCLASS(ManyBoneIK3DGizmoPlugin, EditorNode3DGizmoPlugin);
 	Ref<Shader> kusudama_shader = memnew(Shader);
+	// Shared by every kusudama gizmo; see IKKusudamaGizmoCache3D.
+	Ref<ArrayMesh> kusudama_mesh;
+	HashMap<ObjectID, IKKusudamaGizmoCache3D> kusudama_caches;
 
 	Ref<StandardMaterial3D> unselected_mat;
 	Ref<ShaderMaterial> selected_mat;
 	Ref<Shader> selected_sh = memnew(Shader);
 
-	MeshInstance3D *handles_mesh_instance = nullptr;
-	Ref<ImmediateMesh> handles_mesh = memnew(ImmediateMesh);
+	// One point sprite per bone, all drawn by a single MultiMesh.
+	MultiMeshInstance3D *handles_mesh_instance = nullptr;
+	Ref<MultiMesh> handles_multimesh = memnew(MultiMesh);
+	PackedFloat32Array handles_buffer;
 	Ref<ShaderMaterial> handle_material = memnew(ShaderMaterial);
 	Ref<Shader> handle_shader;
 	EWBIK3D *many_bone_ik = nullptr;
@@ -66,6 +74,11 @@ class ManyBoneIK3DGizmoPlugin : public EditorNode3DGizmoPlugin {
 
 	ObjectID current_many_bone_ik_id;
 
+	// Picking runs from const overrides, so the picker is refreshed lazily there.
+	mutable IKBonePicker3D bone_picker;
+	mutable ObjectID bone_picker_skeleton_id;
+	void _update_bone_picker(Skeleton3D *p_skeleton) const;
+
 protected:
 	static void _bind_methods();
 	void _notifications(int32_t p_what);
@@ -78,7 +91,7 @@ public:
 	String get_gizmo_name() const override;
 	void redraw(EditorNode3DGizmo *p_gizmo) override;
 	int32_t get_priority() const override;
-	void create_gizmo_mesh(BoneId current_bone_idx, Ref<IKBone3D> ik_bone, EditorNode3DGizmo *p_gizmo, Color current_bone_color, Skeleton3D *many_bone_ik_skeleton, EWBIK3D *p_many_bone_ik);
+	void create_gizmo_mesh(BoneId current_bone_idx, Ref<IKBone3D> ik_bone, EditorNode3DGizmo *p_gizmo, Color current_bone_color, Skeleton3D *many_bone_ik_skeleton, const Transform3D &p_skeleton_to_gizmo, IKKusudamaGizmoCache3D &r_kusudama_cache);
 	int subgizmos_intersect_ray(const EditorNode3DGizmo *p_gizmo, Camera3D *p_camera, const Vector2 &p_point) const override;
 	Transform3D get_subgizmo_transform(const EditorNode3DGizmo *p_gizmo, int p_id) const override;
 	void set_subgizmo_transform(const EditorNode3DGizmo *p_gizmo, int p_id, Transform3D p_transform) override;
@@ -30,10 +30,18 @@
 
 #include "register_types.h"
 
+#include "src/ik_animation_baker_3d.h"
 #include "src/ik_bone_3d.h"
 #include "src/ik_effector_3d.h"
+#include "src/ik_effector_animation_3d.h"
 #include "src/ik_effector_template_3d.h"
 #include "src/ik_kusudama_3d.h"
+#include "src/ik_pose_snapshot_3d.h"
+#include "src/ik_reachability_volume_3d.h"
+#include "src/ik_retargeter_3d.h"
+#include "src/ik_solve_trace_3d.h"
+#include "src/ik_solver_stats_3d.h"
+#include "src/ik_target_recording_3d.h"
 #include "src/many_bone_ik_3d.h"
 
 #ifdef TOOLS_ENABLED
@@ -58,6 +66,13 @@ void initialize_many_bone_ik_module(ModuleInitializationLevel p_level) {
 		GDREGISTER_CLASS(IKKusudama3D);
 		GDREGISTER_CLASS(IKRay3D);
 		GDREGISTER_CLASS(IKLimitCone3D);
+		GDREGISTER_CLASS(IKReachabilityVolume3D);
+		GDREGISTER_CLASS(IKEffectorAnimation3D);
+		GDREGISTER_CLASS(IKAnimationBaker3D);
+		GDREGISTER_CLASS(IKRetargeter3D);
+		GDREGISTER_CLASS(IKPoseSnapshot3D);
+		GDREGISTER_CLASS(IKSolveTrace3D);
+		GDREGISTER_CLASS(IKTargetRecording3D);
 	}
 }
 
@@ -65,4 +80,5 @@ void uninitialize_many_bone_ik_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+	IKSolverStats3D::unregister_monitors();
 }
@@ -0,0 +1,316 @@
+/**************************************************************************/
+/*  ik_animation_baker_3d.cpp                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_animation_baker_3d.h"
+
+#include "core/object/worker_thread_pool.h"
+#include "many_bone_ik_3d.h"
+#include "scene/3d/skeleton_3d.h"
+
+void IKAnimationBaker3D::_bake_chunk(uint32_t p_index, BakeWave *p_wave) {
+	const IKEffectorAnimation3D *source = p_wave->source;
+	const Rig &rig = (*p_wave->rigs)[p_index];
+	const LocalVector<int32_t> &bones = *p_wave->bones;
+	const int32_t chunk = p_wave->first_chunk + p_index;
+	const int32_t start = chunk * chunk_size;
+	const int32_t end = MIN(start + chunk_size, source->get_frame_count());
+	// Every chunk warms up on the frames before it instead of waiting for its
+	// predecessor, so the result does not depend on how chunks are scheduled.
+	const int32_t warm_start = MAX(0, start - preroll_frames);
+	LocalVector<Quaternion> &rotations = p_wave->rotations[p_index];
+	rotations.resize((end - start) * bones.size());
+	for (int32_t frame_i = warm_start; frame_i < end; frame_i++) {
+		source->apply(rig.ik, MIN(frame_i / source->get_sample_rate(), source->get_length()), frame_i == warm_start);
+		if (frame_i < start) {
+			continue;
+		}
+		for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+			rotations[(frame_i - start) * bones.size() + bone_i] = rig.skeleton->get_bone_pose_rotation(bones[bone_i]);
+		}
+	}
+}
+
+void IKAnimationBaker3D::_write_key(TrackWriter &r_writer, double p_time, const Quaternion &p_rotation) const {
+	if (!r_writer.has_emitted) {
+		r_writer.ready_times.push_back(p_time);
+		r_writer.ready_rotations.push_back(p_rotation);
+		r_writer.has_emitted = true;
+		r_writer.emitted_time = p_time;
+		r_writer.emitted_rotation = p_rotation;
+		return;
+	}
+	if (key_reduction_tolerance <= 0.0f) {
+		r_writer.ready_times.push_back(p_time);
+		r_writer.ready_rotations.push_back(p_rotation);
+		return;
+	}
+	// Greedy streaming reduction: the held keys may be dropped as long as
+	// interpolating from the last written key to the new one stays in tolerance.
+	bool fits = r_writer.pending_times.size() < uint32_t(MAX_PENDING_KEYS);
+	for (uint32_t pending_i = 0; fits && pending_i < r_writer.pending_times.size(); pending_i++) {
+		const real_t weight = (r_writer.pending_times[pending_i] - r_writer.emitted_time) / (p_time - r_writer.emitted_time);
+		const Quaternion interpolated = r_writer.emitted_rotation.slerp(p_rotation, weight);
+		fits = interpolated.angle_to(r_writer.pending_rotations[pending_i]) <= key_reduction_tolerance;
+	}
+	if (!fits) {
+		const uint32_t last = r_writer.pending_times.size() - 1;
+		r_writer.emitted_time = r_writer.pending_times[last];
+		r_writer.emitted_rotation = r_writer.pending_rotations[last];
+		r_writer.ready_times.push_back(r_writer.emitted_time);
+		r_writer.ready_rotations.push_back(r_writer.emitted_rotation);
+		r_writer.pending_times.clear();
+		r_writer.pending_rotations.clear();
+	}
+	r_writer.pending_times.push_back(p_time);
+	r_writer.pending_rotations.push_back(p_rotation);
+}
+
+void IKAnimationBaker3D::_flush_keys(TrackWriter &r_writer) const {
+	if (r_writer.pending_times.is_empty()) {
+		return;
+	}
+	const uint32_t last = r_writer.pending_times.size() - 1;
+	r_writer.ready_times.push_back(r_writer.pending_times[last]);
+	r_writer.ready_rotations.push_back(r_writer.pending_rotations[last]);
+	r_writer.pending_times.clear();
+	r_writer.pending_rotations.clear();
+}
+
+Error IKAnimationBaker3D::_emit_keys(LocalVector<TrackWriter> &r_writers, const Ref<Animation> &p_animation, const Callable &p_sink) {
+	Dictionary keys;
+	for (TrackWriter &writer : r_writers) {
+		if (writer.ready_times.is_empty()) {
+			continue;
+		}
+		if (p_animation.is_valid()) {
+			for (uint32_t key_i = 0; key_i < writer.ready_times.size(); key_i++) {
+				p_animation->rotation_track_insert_key(writer.track, writer.ready_times[key_i], writer.ready_rotations[key_i]);
+			}
+		} else {
+			PackedFloat64Array times;
+			PackedFloat32Array rotations;
+			times.resize(writer.ready_times.size());
+			rotations.resize(writer.ready_rotations.size() * 4);
+			double *times_w = times.ptrw();
+			float *rotations_w = rotations.ptrw();
+			for (uint32_t key_i = 0; key_i < writer.ready_times.size(); key_i++) {
+				const Quaternion &rotation = writer.ready_rotations[key_i];
+				times_w[key_i] = writer.ready_times[key_i];
+				rotations_w[key_i * 4 + 0] = rotation.x;
+				rotations_w[key_i * 4 + 1] = rotation.y;
+				rotations_w[key_i * 4 + 2] = rotation.z;
+				rotations_w[key_i * 4 + 3] = rotation.w;
+			}
+			Dictionary track;
+			track["times"] = times;
+			track["rotations"] = rotations;
+			keys[writer.path] = track;
+		}
+		// Released as soon as the sink has them, so no wave outlives its hand-off.
+		writer.ready_times.reset();
+		writer.ready_rotations.reset();
+	}
+	if (p_animation.is_null() && !keys.is_empty()) {
+		Callable::CallError ce;
+		Variant ret;
+		const Variant keys_arg = keys;
+		const Variant *args[1] = { &keys_arg };
+		p_sink.callp(args, 1, ret, ce);
+		ERR_FAIL_COND_V_MSG(ce.error != Callable::CallError::CALL_OK, ERR_INVALID_PARAMETER, "The bake sink could not be called with the keys of a wave.");
+	}
+	return OK;
+}
+
+Error IKAnimationBaker3D::_bake(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik, const Ref<Animation> &p_animation, const Callable &p_sink) {
+	ERR_FAIL_COND_V(p_source.is_null(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_NULL_V(p_ik, ERR_INVALID_PARAMETER);
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, ERR_UNCONFIGURED);
+	const int32_t frame_count = p_source->get_frame_count();
+	ERR_FAIL_COND_V_MSG(frame_count == 0, ERR_INVALID_DATA, "The source has no frames to bake.");
+
+	LocalVector<int32_t> bones;
+	for (const Ref<IKBone3D> &bone : p_ik->get_bone_list()) {
+		if (bone.is_valid() && bone->get_bone_id() != -1) {
+			bones.push_back(bone->get_bone_id());
+		}
+	}
+	bones.sort();
+
+	const String track_prefix = skeleton_track_path.is_empty() ? String(skeleton->get_name()) : String(skeleton_track_path);
+	LocalVector<TrackWriter> writers;
+	writers.resize(bones.size());
+	for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+		writers[bone_i].path = track_prefix + ":" + skeleton->get_bone_name(bones[bone_i]);
+		if (p_animation.is_valid()) {
+			writers[bone_i].track = p_animation->add_track(Animation::TYPE_ROTATION_3D);
+			p_animation->track_set_path(writers[bone_i].track, NodePath(writers[bone_i].path));
+		}
+	}
+
+	const int32_t chunk_total = (frame_count + chunk_size - 1) / chunk_size;
+	int32_t parallel = max_parallel_chunks > 0 ? max_parallel_chunks : WorkerThreadPool::get_singleton()->get_thread_count();
+	parallel = CLAMP(parallel, 1, chunk_total);
+
+	// Each parallel slot owns a detached copy of the rig; nothing outside the tree is shared between workers.
+	LocalVector<Rig> rigs;
+	for (int32_t rig_i = 0; rig_i < parallel; rig_i++) {
+		Rig rig;
+		rig.skeleton = Object::cast_to<Skeleton3D>(skeleton->duplicate());
+		ERR_BREAK(!rig.skeleton);
+		rig.ik = Object::cast_to<EWBIK3D>(rig.skeleton->get_child(p_ik->get_index()));
+		if (!rig.ik) {
+			memdelete(rig.skeleton);
+			ERR_BREAK_MSG(true, "The solver must be a direct child of its skeleton to be baked.");
+		}
+		rigs.push_back(rig);
+	}
+
+	Error err = rigs.size() == uint32_t(parallel) ? OK : ERR_CANT_CREATE;
+	if (err == OK) {
+		BakeWave wave;
+		wave.source = p_source.ptr();
+		wave.rigs = &rigs;
+		wave.bones = &bones;
+		for (int32_t first = 0; err == OK && first < chunk_total; first += parallel) {
+			wave.first_chunk = first;
+			wave.chunk_count = MIN(parallel, chunk_total - first);
+			wave.rotations.resize(wave.chunk_count);
+			WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &IKAnimationBaker3D::_bake_chunk, &wave, wave.chunk_count, -1, true, SNAME("IKAnimationBaker3D"));
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+			for (int32_t chunk_i = 0; chunk_i < wave.chunk_count; chunk_i++) {
+				const int32_t start = (first + chunk_i) * chunk_size;
+				const LocalVector<Quaternion> &rotations = wave.rotations[chunk_i];
+				const int32_t chunk_frames = rotations.size() / MAX(1u, bones.size());
+				for (int32_t frame_i = 0; frame_i < chunk_frames; frame_i++) {
+					const double time = MIN((start + frame_i) / p_source->get_sample_rate(), p_source->get_length());
+					for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+						_write_key(writers[bone_i], time, rotations[frame_i * bones.size() + bone_i]);
+					}
+				}
+			}
+			wave.rotations.clear();
+			if (first + parallel >= chunk_total) {
+				for (TrackWriter &writer : writers) {
+					_flush_keys(writer);
+				}
+			}
+			err = _emit_keys(writers, p_animation, p_sink);
+		}
+	}
+
+	for (Rig &rig : rigs) {
+		memdelete(rig.skeleton);
+	}
+	return err;
+}
+
+Ref<Animation> IKAnimationBaker3D::bake(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik) {
+	ERR_FAIL_COND_V(p_source.is_null(), Ref<Animation>());
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length(p_source->get_length());
+	ERR_FAIL_COND_V(_bake(p_source, p_ik, animation, Callable()) != OK, Ref<Animation>());
+	return animation;
+}
+
+Error IKAnimationBaker3D::bake_streamed(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik, const Callable &p_sink) {
+	ERR_FAIL_COND_V(!p_sink.is_valid(), ERR_INVALID_PARAMETER);
+	return _bake(p_source, p_ik, Ref<Animation>(), p_sink);
+}
+
+Ref<Animation> IKAnimationBaker3D::bake_animation(const Ref<Animation> &p_animation, EWBIK3D *p_ik, double p_sample_rate) {
+	Ref<IKEffectorAnimation3D> source;
+	source.instantiate();
+	ERR_FAIL_COND_V(source->compress(p_animation, p_ik, p_sample_rate) != OK, Ref<Animation>());
+	return bake(source, p_ik);
+}
+
+void IKAnimationBaker3D::set_chunk_size(int32_t p_frames) {
+	chunk_size = MAX(1, p_frames);
+}
+
+int32_t IKAnimationBaker3D::get_chunk_size() const {
+	return chunk_size;
+}
+
+void IKAnimationBaker3D::set_preroll_frames(int32_t p_frames) {
+	preroll_frames = MAX(0, p_frames);
+}
+
+int32_t IKAnimationBaker3D::get_preroll_frames() const {
+	return preroll_frames;
+}
+
+void IKAnimationBaker3D::set_max_parallel_chunks(int32_t p_chunks) {
+	max_parallel_chunks = MAX(0, p_chunks);
+}
+
+int32_t IKAnimationBaker3D::get_max_parallel_chunks() const {
+	return max_parallel_chunks;
+}
+
+void IKAnimationBaker3D::set_key_reduction_tolerance(float p_radians) {
+	key_reduction_tolerance = MAX(0.0f, p_radians);
+}
+
+float IKAnimationBaker3D::get_key_reduction_tolerance() const {
+	return key_reduction_tolerance;
+}
+
+void IKAnimationBaker3D::set_skeleton_track_path(const NodePath &p_path) {
+	skeleton_track_path = p_path;
+}
+
+NodePath IKAnimationBaker3D::get_skeleton_track_path() const {
+	return skeleton_track_path;
+}
+
+void IKAnimationBaker3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_chunk_size", "frames"), &IKAnimationBaker3D::set_chunk_size);
+	ClassDB::bind_method(D_METHOD("get_chunk_size"), &IKAnimationBaker3D::get_chunk_size);
+	ClassDB::bind_method(D_METHOD("set_preroll_frames", "frames"), &IKAnimationBaker3D::set_preroll_frames);
+	ClassDB::bind_method(D_METHOD("get_preroll_frames"), &IKAnimationBaker3D::get_preroll_frames);
+	ClassDB::bind_method(D_METHOD("set_max_parallel_chunks", "chunks"), &IKAnimationBaker3D::set_max_parallel_chunks);
+	ClassDB::bind_method(D_METHOD("get_max_parallel_chunks"), &IKAnimationBaker3D::get_max_parallel_chunks);
+	ClassDB::bind_method(D_METHOD("set_key_reduction_tolerance", "radians"), &IKAnimationBaker3D::set_key_reduction_tolerance);
+	ClassDB::bind_method(D_METHOD("get_key_reduction_tolerance"), &IKAnimationBaker3D::get_key_reduction_tolerance);
+	ClassDB::bind_method(D_METHOD("set_skeleton_track_path", "path"), &IKAnimationBaker3D::set_skeleton_track_path);
+	ClassDB::bind_method(D_METHOD("get_skeleton_track_path"), &IKAnimationBaker3D::get_skeleton_track_path);
+	ClassDB::bind_method(D_METHOD("bake", "source", "ik"), &IKAnimationBaker3D::bake);
+	ClassDB::bind_method(D_METHOD("bake_streamed", "source", "ik", "sink"), &IKAnimationBaker3D::bake_streamed);
+	ClassDB::bind_method(D_METHOD("bake_animation", "animation", "ik", "sample_rate"), &IKAnimationBaker3D::bake_animation, DEFVAL(30.0));
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "chunk_size", PROPERTY_HINT_RANGE, "1,4096,1,or_greater"), "set_chunk_size", "get_chunk_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "preroll_frames", PROPERTY_HINT_RANGE, "0,256,1,or_greater"), "set_preroll_frames", "get_preroll_frames");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_parallel_chunks", PROPERTY_HINT_RANGE, "0,256,1,or_greater"), "set_max_parallel_chunks", "get_max_parallel_chunks");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "key_reduction_tolerance", PROPERTY_HINT_RANGE, "0,0.5,0.0001,radians"), "set_key_reduction_tolerance", "get_key_reduction_tolerance");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "skeleton_track_path"), "set_skeleton_track_path", "get_skeleton_track_path");
+}
@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*  ik_animation_baker_3d.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "ik_effector_animation_3d.h"
+#include "scene/resources/animation.h"
+
+class EWBIK3D;
+class Skeleton3D;
+
+// Runs the solver over a recorded target stream and writes the solved bone
+// rotations as keyframes. Frames are split into chunks that are solved in
+// parallel, each on its own copy of the rig. The keys of each finished wave
+// go to a sink, either an Animation or a callback, and are then released, so
+// with a callback memory stays proportional to the wave, not to the take.
+class IKAnimationBaker3D : public RefCounted {
+	GDCLASS(IKAnimationBaker3D, RefCounted);
+
+	int32_t chunk_size = 256;
+	int32_t preroll_frames = 8;
+	int32_t max_parallel_chunks = 0;
+	float key_reduction_tolerance = 0.0f;
+	NodePath skeleton_track_path;
+
+	struct Rig {
+		Skeleton3D *skeleton = nullptr;
+		EWBIK3D *ik = nullptr;
+	};
+
+	struct BakeWave {
+		const IKEffectorAnimation3D *source = nullptr;
+		const LocalVector<Rig> *rigs = nullptr;
+		const LocalVector<int32_t> *bones = nullptr;
+		int32_t first_chunk = 0;
+		int32_t chunk_count = 0;
+		// Per chunk, frames x bones rotations.
+		LocalVector<LocalVector<Quaternion>> rotations;
+	};
+
+	struct TrackWriter {
+		int32_t track = -1;
+		String path;
+		bool has_emitted = false;
+		double emitted_time = 0.0;
+		Quaternion emitted_rotation;
+		LocalVector<double> pending_times;
+		LocalVector<Quaternion> pending_rotations;
+		// Keys final since the last wave was handed to the sink.
+		LocalVector<double> ready_times;
+		LocalVector<Quaternion> ready_rotations;
+	};
+
+	static constexpr int32_t MAX_PENDING_KEYS = 64;
+
+	void _bake_chunk(uint32_t p_index, BakeWave *p_wave);
+	void _write_key(TrackWriter &r_writer, double p_time, const Quaternion &p_rotation) const;
+	void _flush_keys(TrackWriter &r_writer) const;
+	static Error _emit_keys(LocalVector<TrackWriter> &r_writers, const Ref<Animation> &p_animation, const Callable &p_sink);
+	Error _bake(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik, const Ref<Animation> &p_animation, const Callable &p_sink);
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_chunk_size(int32_t p_frames);
+	int32_t get_chunk_size() const;
+	void set_preroll_frames(int32_t p_frames);
+	int32_t get_preroll_frames() const;
+	void set_max_parallel_chunks(int32_t p_chunks);
+	int32_t get_max_parallel_chunks() const;
+	void set_key_reduction_tolerance(float p_radians);
+	float get_key_reduction_tolerance() const;
+	void set_skeleton_track_path(const NodePath &p_path);
+	NodePath get_skeleton_track_path() const;
+
+	Ref<Animation> bake(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik);
+	Error bake_streamed(const Ref<IKEffectorAnimation3D> &p_source, EWBIK3D *p_ik, const Callable &p_sink);
+	Ref<Animation> bake_animation(const Ref<Animation> &p_animation, EWBIK3D *p_ik, double p_sample_rate = 30.0);
+};
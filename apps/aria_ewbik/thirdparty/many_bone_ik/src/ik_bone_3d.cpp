@@ -29,8 +29,10 @@
 /**************************************************************************/
 
 #include "ik_bone_3d.h"
+#include "ik_damping_tables_3d.h"
 #include "ik_kusudama_3d.h"
 #include "many_bone_ik_3d.h"
+#include "math/ik_deterministic_math.h"
 #include "math/ik_node_3d.h"
 #include <cmath>
 
@@ -200,7 +202,7 @@ IKBone3D::IKBone3D(StringName p_bone, Skeleton3D *p_skeleton, const Ref<IKBone3D
 	ERR_FAIL_NULL(p_skeleton);
 
 	default_dampening = p_default_dampening;
-	cos_half_dampen = cos(default_dampening / real_t(2.0));
+	cos_half_dampen = IKMath::cos(default_dampening / real_t(2.0));
 	set_name(p_bone);
 	bone_id = p_skeleton->find_bone(p_bone);
 	if (p_parent.is_valid()) {
@@ -224,24 +226,16 @@ IKBone3D::IKBone3D(StringName p_bone, Skeleton3D *p_skeleton, const Ref<IKBone3D
 
 	float predamp = 1.0 - get_stiffness();
 	dampening = get_parent().is_null() ? Math::PI : predamp * p_default_dampening;
-	float iterations = p_many_bone_ik->get_iterations_per_frame();
+	int32_t iterations = p_many_bone_ik->get_iterations_per_frame();
 	if (get_constraint().is_null()) {
 		Ref<IKKusudama3D> new_constraint;
 		new_constraint.instantiate();
 		add_constraint(new_constraint);
 	}
 	float returnfulness = get_constraint()->get_resistance();
-	float falloff = 0.2f;
-	half_returnfulness_dampened.resize(iterations);
-	cos_half_returnfulness_dampened.resize(iterations);
-	float iterations_pow = Math::pow(iterations, falloff * iterations * returnfulness);
-	for (float i = 0; i < iterations; i++) {
-		float iteration_scalar = ((iterations_pow)-Math::pow(i, falloff * iterations * returnfulness)) / (iterations_pow);
-		float iteration_return_clamp = iteration_scalar * returnfulness * dampening;
-		float cos_iteration_return_clamp = Math::cos(iteration_return_clamp / 2.0);
-		half_returnfulness_dampened.write[i] = iteration_return_clamp;
-		cos_half_returnfulness_dampened.write[i] = cos_iteration_return_clamp;
-	}
+	IKDampingTables3D::Tables tables = IKDampingTables3D::get(iterations, returnfulness, dampening);
+	half_returnfulness_dampened = tables.half_returnfulness_dampened;
+	cos_half_returnfulness_dampened = tables.cos_half_returnfulness_dampened;
 }
 
 float IKBone3D::get_cos_half_dampen() const {
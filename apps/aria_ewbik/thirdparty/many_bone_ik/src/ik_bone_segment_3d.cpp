@@ -33,7 +33,11 @@
 #include "core/string/string_builder.h"
 #include "ik_effector_3d.h"
 #include "ik_kusudama_3d.h"
+#include "ik_solve_trace_3d.h"
+#include "ik_solver_stats_3d.h"
+#include "ik_trace_3d.h"
 #include "many_bone_ik_3d.h"
+#include "math/ik_deterministic_math.h"
 #include "scene/3d/skeleton_3d.h"
 
 Ref<IKBone3D> IKBoneSegment3D::get_root() const {
@@ -53,6 +57,31 @@ Vector<Ref<IKBoneSegment3D>> IKBoneSegment3D::get_child_segments() const {
 	return child_segments;
 }
 
+double IKBoneSegment3D::get_previous_deviation() const {
+	return previous_deviation;
+}
+
+int64_t IKBoneSegment3D::get_heading_memory() const {
+	return int64_t(target_headings.size() + tip_headings.size() + tip_headings_uniform.size()) * sizeof(Vector3) + int64_t(heading_weights.size()) * sizeof(double);
+}
+
+void IKBoneSegment3D::set_previous_deviation(double p_deviation) {
+	previous_deviation = p_deviation;
+}
+
+bool IKBoneSegment3D::is_constraint_limited() const {
+	return constraint_limited;
+}
+
+bool IKBoneSegment3D::is_chain_constraint_limited() const {
+	for (const IKBoneSegment3D *segment = this; segment; segment = segment->parent_segment.ptr()) {
+		if (segment->constraint_limited) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void IKBoneSegment3D::create_bone_list(Vector<Ref<IKBone3D>> &p_list, bool p_recursive) const {
 	if (p_recursive) {
 		for (int32_t child_i = 0; child_i < child_segments.size(); child_i++) {
@@ -131,34 +160,58 @@ void IKBoneSegment3D::_set_optimal_rotation(Ref<IKBone3D> p_for_bone, PackedVect
 	ERR_FAIL_NULL(r_htip);
 	ERR_FAIL_NULL(r_htarget);
 	ERR_FAIL_NULL(r_weights);
+	IK_TRACE_SCOPE("IKBoneSegment3D::_set_optimal_rotation");
 
 	_update_target_headings(p_for_bone, &heading_weights, &target_headings);
 	Transform3D prev_transform = p_for_bone->get_pose();
 	bool got_closer = true;
 	double bone_damp = p_for_bone->get_cos_half_dampen();
 	int i = 0;
+	IKSolveRecorder3D *recorder = IKSolveRecorder3D::get_active();
 	do {
 		_update_tip_headings(p_for_bone, &tip_headings);
+		Quaternion qcp_rotation;
 		if (!p_constraint_mode) {
+			IKSolverStats3D::PhaseScope qcp_scope(IKSolverStats3D::get_active(), IKSolverStats3D::PHASE_QCP);
 			Array superpose_result = QuaternionCharacteristicPolynomial::weighted_superpose(*r_htip, *r_htarget, *r_weights, p_translate, evec_prec);
 			Quaternion rotation = superpose_result[0];
+			qcp_rotation = rotation;
 			Vector3 translation = superpose_result[1];
 			double dampening = (p_dampening != -1.0) ? p_dampening : bone_damp;
-			rotation = clamp_to_cos_half_angle(rotation, cos(dampening / 2.0));
+			rotation = clamp_to_cos_half_angle(rotation, IKMath::cos(dampening / 2.0));
 			if (current_iteration == 0) {
 				current_iteration = 0.0001;
 			}
-			rotation = rotation.slerp(p_for_bone->get_global_pose().basis.get_rotation_quaternion(), static_cast<double>(total_iterations) / current_iteration);
+			rotation = IKMath::slerp(rotation, p_for_bone->get_global_pose().basis.get_rotation_quaternion(), static_cast<double>(total_iterations) / current_iteration);
 			p_for_bone->get_ik_transform()->rotate_local_with_global(rotation);
 			Transform3D result = Transform3D(p_for_bone->get_global_pose().basis, p_for_bone->get_global_pose().origin + translation);
 			p_for_bone->set_global_pose(result);
 		}
+		Quaternion pre_constraint_rotation;
+		if (unlikely(recorder)) {
+			pre_constraint_rotation = p_for_bone->get_ik_transform()->get_transform().basis.get_rotation_quaternion();
+		}
 		bool is_parent_valid = p_for_bone->get_parent().is_valid();
-		if (is_parent_valid && p_for_bone->is_orientationally_constrained()) {
-			p_for_bone->get_constraint()->snap_to_orientation_limit(p_for_bone->get_bone_direction_transform(), p_for_bone->get_ik_transform(), p_for_bone->get_constraint_orientation_transform(), bone_damp, p_for_bone->get_cos_half_dampen());
+		{
+			IKSolverStats3D::PhaseScope constraint_scope(IKSolverStats3D::get_active(), IKSolverStats3D::PHASE_CONSTRAINTS);
+			if (is_parent_valid && p_for_bone->is_orientationally_constrained()) {
+				if (p_for_bone->get_constraint()->snap_to_orientation_limit(p_for_bone->get_bone_direction_transform(), p_for_bone->get_ik_transform(), p_for_bone->get_constraint_orientation_transform(), bone_damp, p_for_bone->get_cos_half_dampen())) {
+					constraint_limited = true;
+					IKSolverStats3D::count_constraint_snap();
+				}
+			}
+			if (is_parent_valid && p_for_bone->is_axially_constrained()) {
+				if (p_for_bone->get_constraint()->set_snap_to_twist_limit(p_for_bone->get_bone_direction_transform(), p_for_bone->get_ik_transform(), p_for_bone->get_constraint_twist_transform(), bone_damp, p_for_bone->get_cos_half_dampen())) {
+					constraint_limited = true;
+					IKSolverStats3D::count_constraint_snap();
+				}
+			}
 		}
-		if (is_parent_valid && p_for_bone->is_axially_constrained()) {
-			p_for_bone->get_constraint()->set_snap_to_twist_limit(p_for_bone->get_bone_direction_transform(), p_for_bone->get_ik_transform(), p_for_bone->get_constraint_twist_transform(), bone_damp, p_for_bone->get_cos_half_dampen());
+		if (unlikely(recorder)) {
+			const Quaternion post_constraint_rotation = p_for_bone->get_ik_transform()->get_transform().basis.get_rotation_quaternion();
+			_update_tip_headings(p_for_bone, &tip_headings_uniform);
+			const float msd = _get_manual_msd(tip_headings_uniform, *r_htarget, *r_weights);
+			recorder->record_bone(p_for_bone->get_bone_id(), *r_htip, *r_htarget, *r_weights, qcp_rotation, pre_constraint_rotation, post_constraint_rotation, msd);
 		}
 		if (default_stabilizing_pass_count > 0) {
 			_update_tip_headings(p_for_bone, &tip_headings_uniform);
@@ -184,36 +237,48 @@ void IKBoneSegment3D::_update_target_headings(Ref<IKBone3D> p_for_bone, Vector<d
 	ERR_FAIL_COND(p_for_bone.is_null());
 	ERR_FAIL_NULL(r_weights);
 	ERR_FAIL_NULL(r_target_headings);
+	IKSolverStats3D::PhaseScope heading_scope(IKSolverStats3D::get_active(), IKSolverStats3D::PHASE_HEADING_UPDATE);
+	const int32_t heading_count = r_target_headings->size();
+	ERR_FAIL_COND(heading_weights.size() < heading_count);
+	Vector3 *headings = r_target_headings->ptrw();
+	const double *weights = heading_weights.ptr();
 	int32_t last_index = 0;
-	for (int32_t effector_i = 0; effector_i < effector_list.size(); effector_i++) {
-		Ref<IKEffector3D> effector = effector_list[effector_i];
+	for (const Ref<IKEffector3D> &effector : effector_list) {
 		if (effector.is_null()) {
 			continue;
 		}
-		last_index = effector->update_effector_target_headings(r_target_headings, last_index, p_for_bone, &heading_weights);
+		ERR_FAIL_COND(last_index + effector->get_heading_count() > heading_count);
+		last_index = effector->write_target_headings(headings, last_index, weights);
 	}
 }
 
 void IKBoneSegment3D::_update_tip_headings(Ref<IKBone3D> p_for_bone, PackedVector3Array *r_heading_tip) {
 	ERR_FAIL_NULL(r_heading_tip);
 	ERR_FAIL_COND(p_for_bone.is_null());
+	IKSolverStats3D::PhaseScope heading_scope(IKSolverStats3D::get_active(), IKSolverStats3D::PHASE_HEADING_UPDATE);
+	const int32_t heading_count = r_heading_tip->size();
+	Vector3 *headings = r_heading_tip->ptrw();
+	const Vector3 bone_origin = p_for_bone->get_bone_direction_global_pose().origin;
 	int32_t last_index = 0;
-	for (int32_t effector_i = 0; effector_i < effector_list.size(); effector_i++) {
-		Ref<IKEffector3D> effector = effector_list[effector_i];
+	for (const Ref<IKEffector3D> &effector : effector_list) {
 		if (effector.is_null()) {
 			continue;
 		}
-		last_index = effector->update_effector_tip_headings(r_heading_tip, last_index, p_for_bone);
+		ERR_FAIL_COND(last_index + effector->get_heading_count() > heading_count);
+		last_index = effector->write_tip_headings(headings, last_index, bone_origin);
 	}
 }
 
 void IKBoneSegment3D::segment_solver(const Vector<float> &p_damp, float p_default_damp, bool p_constraint_mode, int32_t p_current_iteration, int32_t p_total_iteration) {
+	IK_TRACE_SCOPE("IKBoneSegment3D::segment_solver");
 	for (Ref<IKBoneSegment3D> child : child_segments) {
 		if (child.is_null()) {
 			continue;
 		}
 		child->segment_solver(p_damp, p_default_damp, p_constraint_mode, p_current_iteration, p_total_iteration);
 	}
+	IKSolverStats3D::count_segment();
+	constraint_limited = false;
 	bool is_translate = parent_segment.is_null();
 	if (is_translate) {
 		Vector<float> damp = p_damp;
@@ -235,6 +300,7 @@ void IKBoneSegment3D::_qcp_solver(const Vector<float> &p_damp, float p_default_d
 		if (is_non_default_damp) {
 			damp = p_default_damp;
 		}
+		IKSolverStats3D::count_bone();
 		_update_optimal_rotation(current_bone, damp, p_translate, p_constraint_mode, p_current_iteration, p_total_iterations);
 	}
 }
@@ -60,6 +60,7 @@ class IKBoneSegment3D : public Resource {
 	Skeleton3D *skeleton = nullptr;
 	bool pinned_descendants = false;
 	double previous_deviation = INFINITY;
+	bool constraint_limited = false; // A limit snapped a bone of this segment during its last solve pass.
 	int32_t default_stabilizing_pass_count = 0; // Move to the stabilizing pass to the ik solver. Set it free.
 	bool _has_pinned_descendants();
 	void _enable_pinned_descendants();
@@ -92,6 +93,13 @@ public:
 	Ref<IKBone3D> get_tip() const;
 	bool is_pinned() const;
 	Vector<Ref<IKBoneSegment3D>> get_child_segments() const;
+	double get_previous_deviation() const;
+	// Bytes held by the heading and weight arrays.
+	int64_t get_heading_memory() const;
+	void set_previous_deviation(double p_deviation);
+	bool is_constraint_limited() const;
+	// True if this segment or one of the segments above it hit a limit during the last iteration.
+	bool is_chain_constraint_limited() const;
 	void create_bone_list(Vector<Ref<IKBone3D>> &p_list, bool p_recursive = false) const;
 	Ref<IKBone3D> get_ik_bone(BoneId p_bone) const;
 	void generate_default_segments(Vector<Ref<IKEffectorTemplate3D>> &p_pins, BoneId p_root_bone, BoneId p_tip_bone, EWBIK3D *p_many_bone_ik);
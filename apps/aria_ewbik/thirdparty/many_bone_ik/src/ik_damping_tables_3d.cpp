@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*  ik_damping_tables_3d.cpp                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_damping_tables_3d.h"
+
+#include "math/ik_deterministic_math.h"
+
+Mutex IKDampingTables3D::mutex;
+LRUCache<IKDampingTables3D::Key, IKDampingTables3D::Tables, IKDampingTables3D::KeyHasher> IKDampingTables3D::cache(IKDampingTables3D::MAX_CACHED_TABLES);
+
+IKDampingTables3D::Tables IKDampingTables3D::_build(int32_t p_iterations, float p_returnfulness, float p_dampening) {
+	// Shared tables must not depend on the math policy of whichever solve built them first.
+	IKMath::PolicyScope precise(IKMath::POLICY_PRECISE);
+	Tables tables;
+	const float iterations = p_iterations;
+	const float falloff = 0.2f;
+	tables.half_returnfulness_dampened.resize(p_iterations);
+	tables.cos_half_returnfulness_dampened.resize(p_iterations);
+	float *half_write = tables.half_returnfulness_dampened.ptrw();
+	float *cos_half_write = tables.cos_half_returnfulness_dampened.ptrw();
+	float iterations_pow = IKMath::pow(iterations, falloff * iterations * p_returnfulness);
+	for (int32_t i = 0; i < p_iterations; i++) {
+		float iteration_scalar = ((iterations_pow)-IKMath::pow(float(i), falloff * iterations * p_returnfulness)) / (iterations_pow);
+		float iteration_return_clamp = iteration_scalar * p_returnfulness * p_dampening;
+		float cos_iteration_return_clamp = IKMath::cos(iteration_return_clamp / 2.0);
+		half_write[i] = iteration_return_clamp;
+		cos_half_write[i] = cos_iteration_return_clamp;
+	}
+	return tables;
+}
+
+IKDampingTables3D::Tables IKDampingTables3D::get(int32_t p_iterations, float p_returnfulness, float p_dampening) {
+	ERR_FAIL_COND_V(p_iterations < 0, Tables());
+	Key key;
+	key.iterations = p_iterations;
+	key.returnfulness = p_returnfulness;
+	key.dampening = p_dampening;
+
+	MutexLock lock(mutex);
+	const Tables *cached = cache.getptr(key);
+	if (cached) {
+		return *cached;
+	}
+	return *cache.insert(key, _build(p_iterations, p_returnfulness, p_dampening));
+}
+
+int32_t IKDampingTables3D::get_cached_count() {
+	MutexLock lock(mutex);
+	return cache.get_size();
+}
+
+void IKDampingTables3D::clear_cache() {
+	MutexLock lock(mutex);
+	cache.clear();
+}
@@ -0,0 +1,83 @@
+/**************************************************************************/
+/*  ik_damping_tables_3d.h                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/os/mutex.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/lru.h"
+#include "core/templates/vector.h"
+
+// Per-iteration returnfulness damping tables. A table depends only on the
+// iteration count, the constraint resistance and the bone dampening, so every
+// bone with the same three values, in any EWBIK3D, holds a copy-on-write
+// reference to one shared pair of buffers instead of its own.
+class IKDampingTables3D {
+public:
+	struct Tables {
+		Vector<float> half_returnfulness_dampened;
+		Vector<float> cos_half_returnfulness_dampened;
+	};
+
+private:
+	struct Key {
+		int32_t iterations = 0;
+		float returnfulness = 0.0f;
+		float dampening = 0.0f;
+
+		bool operator==(const Key &p_other) const {
+			return iterations == p_other.iterations && returnfulness == p_other.returnfulness && dampening == p_other.dampening;
+		}
+	};
+
+	struct KeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const Key &p_key) {
+			uint32_t h = hash_murmur3_one_32(p_key.iterations);
+			h = hash_murmur3_one_float(p_key.returnfulness, h);
+			h = hash_murmur3_one_float(p_key.dampening, h);
+			return hash_fmix32(h);
+		}
+	};
+
+	static Mutex mutex;
+	static LRUCache<Key, Tables, KeyHasher> cache;
+
+	static Tables _build(int32_t p_iterations, float p_returnfulness, float p_dampening);
+
+public:
+	// Past this many distinct settings the least recently requested table is
+	// evicted. Tables already handed out stay valid; only bones built later
+	// with those settings get a fresh copy.
+	static constexpr int32_t MAX_CACHED_TABLES = 256;
+
+	static Tables get(int32_t p_iterations, float p_returnfulness, float p_dampening);
+	static int32_t get_cached_count();
+	static void clear_cache();
+};
@@ -36,6 +36,14 @@
 #include "math/ik_node_3d.h"
 #include "scene/3d/node_3d.h"
 
+#if !defined(REAL_T_IS_DOUBLE) && defined(__SSE2__)
+#include <emmintrin.h>
+#define IK_HEADING_PAIR_SSE2
+#elif !defined(REAL_T_IS_DOUBLE) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define IK_HEADING_PAIR_NEON
+#endif
+
 #ifdef TOOLS_ENABLED
 #include "editor/editor_data.h"
 #include "editor/editor_node.h"
@@ -62,12 +70,19 @@ Ref<IKBone3D> IKEffector3D::get_ik_bone_3d() const {
 	return for_bone;
 }
 
+int64_t IKEffector3D::get_heading_memory() const {
+	return int64_t(target_headings.size() + tip_headings.size()) * sizeof(Vector3) + int64_t(heading_weights.size()) * sizeof(real_t);
+}
+
 bool IKEffector3D::is_following_translation_only() const {
 	return Math::is_zero_approx(direction_priorities.length_squared());
 }
 
 void IKEffector3D::set_direction_priorities(Vector3 p_direction_priorities) {
 	direction_priorities = p_direction_priorities;
+	priority_mask = make_priority_mask(direction_priorities);
+	target_heading_kernel = get_target_heading_kernel(priority_mask);
+	tip_heading_kernel = get_tip_heading_kernel(priority_mask);
 }
 
 Vector3 IKEffector3D::get_direction_priorities() const {
@@ -77,75 +92,186 @@ Vector3 IKEffector3D::get_direction_priorities() const {
 void IKEffector3D::update_target_global_transform(Skeleton3D *p_skeleton, EWBIK3D *p_many_bone_ik) {
 	ERR_FAIL_NULL(p_skeleton);
 	ERR_FAIL_COND(for_bone.is_null());
+	target_relative_to_skeleton_origin = resolve_target_global_transform(p_skeleton, p_many_bone_ik);
+}
+
+Transform3D IKEffector3D::resolve_target_global_transform(const Skeleton3D *p_skeleton, const EWBIK3D *p_many_bone_ik) const {
+	ERR_FAIL_NULL_V(p_skeleton, target_relative_to_skeleton_origin);
+	ERR_FAIL_NULL_V(p_many_bone_ik, target_relative_to_skeleton_origin);
 	Node3D *current_target_node = cast_to<Node3D>(p_many_bone_ik->get_node_or_null(target_node_path));
 	if (current_target_node && current_target_node->is_visible_in_tree()) {
-		target_relative_to_skeleton_origin = p_skeleton->get_global_transform().affine_inverse() * current_target_node->get_global_transform();
+		return p_skeleton->get_global_transform().affine_inverse() * current_target_node->get_global_transform();
 	}
+	return target_relative_to_skeleton_origin;
 }
 
 Transform3D IKEffector3D::get_target_global_transform() const {
 	return target_relative_to_skeleton_origin;
 }
 
-int32_t IKEffector3D::update_effector_target_headings(PackedVector3Array *p_headings, int32_t p_index, Ref<IKBone3D> p_for_bone, const Vector<double> *p_weights) const {
-	ERR_FAIL_COND_V(p_index == -1, -1);
-	ERR_FAIL_NULL_V(p_headings, -1);
-	ERR_FAIL_COND_V(p_for_bone.is_null(), -1);
-	ERR_FAIL_NULL_V(p_weights, -1);
+void IKEffector3D::set_target_global_transform(const Transform3D &p_transform) {
+	target_relative_to_skeleton_origin = p_transform;
+}
+
+// The kernels keep the operation order of the per-axis loop they replace,
+// so headings are bit-identical to it. Only the branching is resolved at
+// compile time, and the two headings of a pair share their loads. With
+// single-precision reals, a pair is computed in one SIMD register per
+// heading: each lane runs the same add, subtract and multiply as the scalar
+// code, and nothing can be fused, so the results do not change.
+namespace {
 
+#if defined(IK_HEADING_PAIR_SSE2)
+_FORCE_INLINE_ __m128 load_vector3(const Vector3 &p_vector) {
+	return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(&p_vector.x)), _mm_load_ss(&p_vector.z));
+}
+#elif defined(IK_HEADING_PAIR_NEON)
+_FORCE_INLINE_ float32x4_t load_vector3(const Vector3 &p_vector) {
+	return vcombine_f32(vld1_f32(&p_vector.x), vld1_lane_f32(&p_vector.z, vdup_n_f32(0.0f), 0));
+}
+#endif
+
+// Writes ((p_column + p_origin) - p_bone_origin) * p_scale and
+// ((p_origin - p_column) - p_bone_origin) * p_scale to r_pair[0] and r_pair[1].
+_FORCE_INLINE_ void write_heading_pair(const Vector3 &p_column, const Vector3 &p_origin, const Vector3 &p_bone_origin, real_t p_scale, Vector3 *r_pair) {
+#if defined(IK_HEADING_PAIR_SSE2)
+	static_assert(sizeof(Vector3) == 3 * sizeof(float));
+	const __m128 column = load_vector3(p_column);
+	const __m128 origin = load_vector3(p_origin);
+	const __m128 bone_origin = load_vector3(p_bone_origin);
+	const __m128 scale = _mm_set1_ps(p_scale);
+	const __m128 plus = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(column, origin), bone_origin), scale);
+	const __m128 minus = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(origin, column), bone_origin), scale);
+	// The pair is six consecutive floats: plus.xyz, minus.xyz.
+	float *out = &r_pair[0].x;
+	const __m128 seam = _mm_shuffle_ps(plus, minus, _MM_SHUFFLE(0, 0, 2, 2));
+	_mm_storeu_ps(out, _mm_shuffle_ps(plus, seam, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storel_pi(reinterpret_cast<__m64 *>(out + 4), _mm_shuffle_ps(minus, minus, _MM_SHUFFLE(3, 3, 2, 1)));
+#elif defined(IK_HEADING_PAIR_NEON)
+	static_assert(sizeof(Vector3) == 3 * sizeof(float));
+	const float32x4_t column = load_vector3(p_column);
+	const float32x4_t origin = load_vector3(p_origin);
+	const float32x4_t bone_origin = load_vector3(p_bone_origin);
+	const float32x4_t scale = vdupq_n_f32(p_scale);
+	const float32x4_t plus = vmulq_f32(vsubq_f32(vaddq_f32(column, origin), bone_origin), scale);
+	const float32x4_t minus = vmulq_f32(vsubq_f32(vsubq_f32(origin, column), bone_origin), scale);
+	// The pair is six consecutive floats: plus.xyz, minus.xyz.
+	float *out = &r_pair[0].x;
+	vst1q_f32(out, vsetq_lane_f32(vgetq_lane_f32(minus, 0), plus, 3));
+	vst1_f32(out + 4, vget_low_f32(vextq_f32(minus, minus, 1)));
+#else
+	const Vector3 scale(p_scale, p_scale, p_scale);
+	r_pair[0] = ((p_column + p_origin) - p_bone_origin) * scale;
+	r_pair[1] = ((p_origin - p_column) - p_bone_origin) * scale;
+#endif
+}
+
+template <int AXIS>
+_FORCE_INLINE_ void write_target_pair(const Transform3D &p_target, const Vector3 &p_bone_origin, const double *p_weights, Vector3 *r_headings, int32_t &r_index) {
+	write_heading_pair(p_target.basis.get_column(AXIS), p_target.origin, p_bone_origin, p_weights[r_index], r_headings + r_index);
+	r_index += 2;
+}
+
+template <int AXIS>
+_FORCE_INLINE_ void write_tip_pair(const Transform3D &p_tip, real_t p_priority, const Vector3 &p_bone_origin, real_t p_scale, Vector3 *r_headings, int32_t &r_index) {
+	write_heading_pair(p_tip.basis.get_column(AXIS) * p_priority, p_tip.origin, p_bone_origin, p_scale, r_headings + r_index);
+	r_index += 2;
+}
+
+template <uint8_t MASK>
+int32_t write_target_headings_kernel(const Transform3D &p_target, const Vector3 &p_bone_origin, const double *p_weights, Vector3 *r_headings, int32_t p_index) {
 	int32_t index = p_index;
-	Vector3 bone_origin_relative_to_skeleton_origin = for_bone->get_bone_direction_global_pose().origin;
-	p_headings->write[index] = target_relative_to_skeleton_origin.origin - bone_origin_relative_to_skeleton_origin;
-	index++;
-	Vector3 priority = get_direction_priorities();
-	for (int axis = Vector3::AXIS_X; axis <= Vector3::AXIS_Z; ++axis) {
-		if (priority[axis] > 0.0) {
-			real_t w = p_weights->get(index);
-			Vector3 column = target_relative_to_skeleton_origin.basis.get_column(axis);
-
-			p_headings->write[index] = (column + target_relative_to_skeleton_origin.origin) - bone_origin_relative_to_skeleton_origin;
-			p_headings->write[index] *= Vector3(w, w, w);
-			index++;
-			p_headings->write[index] = (target_relative_to_skeleton_origin.origin - column) - bone_origin_relative_to_skeleton_origin;
-			p_headings->write[index] *= Vector3(w, w, w);
-			index++;
-		}
+	r_headings[index++] = p_target.origin - p_bone_origin;
+	if constexpr (MASK & (1 << Vector3::AXIS_X)) {
+		write_target_pair<Vector3::AXIS_X>(p_target, p_bone_origin, p_weights, r_headings, index);
+	}
+	if constexpr (MASK & (1 << Vector3::AXIS_Y)) {
+		write_target_pair<Vector3::AXIS_Y>(p_target, p_bone_origin, p_weights, r_headings, index);
 	}
+	if constexpr (MASK & (1 << Vector3::AXIS_Z)) {
+		write_target_pair<Vector3::AXIS_Z>(p_target, p_bone_origin, p_weights, r_headings, index);
+	}
+	return index;
+}
 
+template <uint8_t MASK>
+int32_t write_tip_headings_kernel(const Transform3D &p_tip, const Vector3 &p_priorities, const Vector3 &p_bone_origin, real_t p_scale, Vector3 *r_headings, int32_t p_index) {
+	int32_t index = p_index;
+	r_headings[index++] = p_tip.origin - p_bone_origin;
+	if constexpr (MASK & (1 << Vector3::AXIS_X)) {
+		write_tip_pair<Vector3::AXIS_X>(p_tip, p_priorities.x, p_bone_origin, p_scale, r_headings, index);
+	}
+	if constexpr (MASK & (1 << Vector3::AXIS_Y)) {
+		write_tip_pair<Vector3::AXIS_Y>(p_tip, p_priorities.y, p_bone_origin, p_scale, r_headings, index);
+	}
+	if constexpr (MASK & (1 << Vector3::AXIS_Z)) {
+		write_tip_pair<Vector3::AXIS_Z>(p_tip, p_priorities.z, p_bone_origin, p_scale, r_headings, index);
+	}
 	return index;
 }
 
-int32_t IKEffector3D::update_effector_tip_headings(PackedVector3Array *p_headings, int32_t p_index, Ref<IKBone3D> p_for_bone) const {
-	ERR_FAIL_COND_V(p_index == -1, -1);
-	ERR_FAIL_NULL_V(p_headings, -1);
-	ERR_FAIL_COND_V(p_for_bone.is_null(), -1);
+const IKEffector3D::TargetHeadingKernel target_heading_kernels[8] = {
+	write_target_headings_kernel<0>,
+	write_target_headings_kernel<1>,
+	write_target_headings_kernel<2>,
+	write_target_headings_kernel<3>,
+	write_target_headings_kernel<4>,
+	write_target_headings_kernel<5>,
+	write_target_headings_kernel<6>,
+	write_target_headings_kernel<7>,
+};
 
-	Transform3D tip_xform_relative_to_skeleton_origin = for_bone->get_bone_direction_global_pose();
-	Basis tip_basis = tip_xform_relative_to_skeleton_origin.basis;
-	Vector3 bone_origin_relative_to_skeleton_origin = p_for_bone->get_bone_direction_global_pose().origin;
+const IKEffector3D::TipHeadingKernel tip_heading_kernels[8] = {
+	write_tip_headings_kernel<0>,
+	write_tip_headings_kernel<1>,
+	write_tip_headings_kernel<2>,
+	write_tip_headings_kernel<3>,
+	write_tip_headings_kernel<4>,
+	write_tip_headings_kernel<5>,
+	write_tip_headings_kernel<6>,
+	write_tip_headings_kernel<7>,
+};
 
-	int32_t index = p_index;
-	p_headings->write[index] = tip_xform_relative_to_skeleton_origin.origin - bone_origin_relative_to_skeleton_origin;
-	index++;
-	double distance = target_relative_to_skeleton_origin.origin.distance_to(bone_origin_relative_to_skeleton_origin);
-	double scale_by = MIN(distance, 1.0f);
-	const Vector3 priority = get_direction_priorities();
+} // namespace
 
+uint8_t IKEffector3D::make_priority_mask(const Vector3 &p_direction_priorities) {
+	uint8_t mask = 0;
 	for (int axis = Vector3::AXIS_X; axis <= Vector3::AXIS_Z; ++axis) {
-		if (priority[axis] > 0.0) {
-			Vector3 column = tip_basis.get_column(axis) * priority[axis];
-
-			p_headings->write[index] = (column + tip_xform_relative_to_skeleton_origin.origin) - bone_origin_relative_to_skeleton_origin;
-			p_headings->write[index] *= scale_by;
-			index++;
-
-			p_headings->write[index] = (tip_xform_relative_to_skeleton_origin.origin - column) - bone_origin_relative_to_skeleton_origin;
-			p_headings->write[index] *= scale_by;
-			index++;
+		if (p_direction_priorities[axis] > 0.0) {
+			mask |= 1 << axis;
 		}
 	}
+	return mask;
+}
 
-	return index;
+IKEffector3D::TargetHeadingKernel IKEffector3D::get_target_heading_kernel(uint8_t p_priority_mask) {
+	ERR_FAIL_UNSIGNED_INDEX_V(p_priority_mask, 8, target_heading_kernels[0]);
+	return target_heading_kernels[p_priority_mask];
+}
+
+IKEffector3D::TipHeadingKernel IKEffector3D::get_tip_heading_kernel(uint8_t p_priority_mask) {
+	ERR_FAIL_UNSIGNED_INDEX_V(p_priority_mask, 8, tip_heading_kernels[0]);
+	return tip_heading_kernels[p_priority_mask];
+}
+
+int32_t IKEffector3D::get_heading_count(uint8_t p_priority_mask) {
+	return 1 + 2 * ((p_priority_mask & 1) + ((p_priority_mask >> 1) & 1) + ((p_priority_mask >> 2) & 1));
+}
+
+int32_t IKEffector3D::get_heading_count() const {
+	return get_heading_count(priority_mask);
+}
+
+int32_t IKEffector3D::write_target_headings(Vector3 *r_headings, int32_t p_index, const double *p_weights) const {
+	const Vector3 bone_origin_relative_to_skeleton_origin = for_bone->get_bone_direction_global_pose().origin;
+	return target_heading_kernel(target_relative_to_skeleton_origin, bone_origin_relative_to_skeleton_origin, p_weights, r_headings, p_index);
+}
+
+int32_t IKEffector3D::write_tip_headings(Vector3 *r_headings, int32_t p_index, const Vector3 &p_bone_origin) const {
+	const Transform3D tip_xform_relative_to_skeleton_origin = for_bone->get_bone_direction_global_pose();
+	const double distance = target_relative_to_skeleton_origin.origin.distance_to(p_bone_origin);
+	const double scale_by = MIN(distance, 1.0f);
+	return tip_heading_kernel(tip_xform_relative_to_skeleton_origin, direction_priorities, p_bone_origin, scale_by, r_headings, p_index);
 }
 
 void IKEffector3D::_bind_methods() {
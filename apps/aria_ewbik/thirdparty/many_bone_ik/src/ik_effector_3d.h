@@ -45,6 +45,14 @@ class IKEffector3D : public Resource {
 	friend class IKBone3D;
 	friend class IKBoneSegment3D;
 
+public:
+	// Heading kernels, one per priority mask. Each writes the heading toward
+	// the origin, then a +axis, -axis pair for every prioritized axis, and
+	// returns the index after the last heading written.
+	typedef int32_t (*TargetHeadingKernel)(const Transform3D &p_target, const Vector3 &p_bone_origin, const double *p_weights, Vector3 *r_headings, int32_t p_index);
+	typedef int32_t (*TipHeadingKernel)(const Transform3D &p_tip, const Vector3 &p_priorities, const Vector3 &p_bone_origin, real_t p_scale, Vector3 *r_headings, int32_t p_index);
+
+private:
 	Ref<IKBone3D> for_bone;
 	bool use_target_node_rotation = true;
 	NodePath target_node_path;
@@ -62,6 +70,10 @@ class IKEffector3D : public Resource {
 	PackedVector3Array tip_headings;
 	Vector<real_t> heading_weights;
 	Vector3 direction_priorities;
+	// Bit n is set when direction_priorities[n] > 0.
+	uint8_t priority_mask = 0;
+	TargetHeadingKernel target_heading_kernel = get_target_heading_kernel(0);
+	TipHeadingKernel tip_heading_kernel = get_tip_heading_kernel(0);
 
 protected:
 	static void _bind_methods();
@@ -73,17 +85,30 @@ public:
 	void set_direction_priorities(Vector3 p_direction_priorities);
 	Vector3 get_direction_priorities() const;
 	void update_target_global_transform(Skeleton3D *p_skeleton, EWBIK3D *p_modification = nullptr);
+	// The target update_target_global_transform() would store, without storing it.
+	Transform3D resolve_target_global_transform(const Skeleton3D *p_skeleton, const EWBIK3D *p_modification) const;
 	const float MAX_KUSUDAMA_OPEN_CONES = 30;
 	float get_motion_propagation_factor() const;
 	void set_motion_propagation_factor(float p_motion_propagation_factor);
 	void set_target_node(Skeleton3D *p_skeleton, const NodePath &p_target_node_path);
 	NodePath get_target_node() const;
 	Transform3D get_target_global_transform() const;
+	void set_target_global_transform(const Transform3D &p_transform);
 	void set_target_node_rotation(bool p_use);
 	bool get_target_node_rotation() const;
 	Ref<IKBone3D> get_ik_bone_3d() const;
 	bool is_following_translation_only() const;
-	int32_t update_effector_target_headings(PackedVector3Array *p_headings, int32_t p_index, Ref<IKBone3D> p_for_bone, const Vector<double> *p_weights) const;
-	int32_t update_effector_tip_headings(PackedVector3Array *p_headings, int32_t p_index, Ref<IKBone3D> p_for_bone) const;
+	static uint8_t make_priority_mask(const Vector3 &p_direction_priorities);
+	static TargetHeadingKernel get_target_heading_kernel(uint8_t p_priority_mask);
+	static TipHeadingKernel get_tip_heading_kernel(uint8_t p_priority_mask);
+	uint8_t get_priority_mask() const { return priority_mask; }
+	// One heading toward the origin and two per prioritized axis: 1, 3, 5 or 7.
+	static int32_t get_heading_count(uint8_t p_priority_mask);
+	int32_t get_heading_count() const;
+	// Write into a segment's heading buffers from p_index on and return the next free index.
+	int32_t write_target_headings(Vector3 *r_headings, int32_t p_index, const double *p_weights) const;
+	int32_t write_tip_headings(Vector3 *r_headings, int32_t p_index, const Vector3 &p_bone_origin) const;
+	// Bytes held by the heading and weight arrays.
+	int64_t get_heading_memory() const;
 	IKEffector3D(const Ref<IKBone3D> &p_current_bone);
 };
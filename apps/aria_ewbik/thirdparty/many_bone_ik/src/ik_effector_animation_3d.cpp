@@ -0,0 +1,492 @@
+/**************************************************************************/
+/*  ik_effector_animation_3d.cpp                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_effector_animation_3d.h"
+
+#include "many_bone_ik_3d.h"
+#include "scene/3d/skeleton_3d.h"
+
+Quaternion IKEffectorAnimation3D::_read_rotation(const PackedFloat32Array &p_rotations, int32_t p_index) {
+	const float *r = p_rotations.ptr() + p_index * 4;
+	return Quaternion(r[0], r[1], r[2], r[3]);
+}
+
+void IKEffectorAnimation3D::_write_rotation(PackedFloat32Array &r_rotations, int32_t p_index, const Quaternion &p_rotation) {
+	float *w = r_rotations.ptrw() + p_index * 4;
+	w[0] = p_rotation.x;
+	w[1] = p_rotation.y;
+	w[2] = p_rotation.z;
+	w[3] = p_rotation.w;
+}
+
+void IKEffectorAnimation3D::_apply_source_pose(const Ref<Animation> &p_animation, Skeleton3D *p_skeleton, double p_time) {
+	p_skeleton->reset_bone_poses();
+	for (int32_t track_i = 0; track_i < p_animation->get_track_count(); track_i++) {
+		const NodePath path = p_animation->track_get_path(track_i);
+		if (path.get_subname_count() == 0) {
+			continue;
+		}
+		const int32_t bone = p_skeleton->find_bone(path.get_concatenated_subnames());
+		if (bone == -1) {
+			continue;
+		}
+		switch (p_animation->track_get_type(track_i)) {
+			case Animation::TYPE_POSITION_3D: {
+				Vector3 position;
+				if (p_animation->try_position_track_interpolate(track_i, p_time, &position) == OK) {
+					p_skeleton->set_bone_pose_position(bone, position);
+				}
+			} break;
+			case Animation::TYPE_ROTATION_3D: {
+				Quaternion rotation;
+				if (p_animation->try_rotation_track_interpolate(track_i, p_time, &rotation) == OK) {
+					p_skeleton->set_bone_pose_rotation(bone, rotation);
+				}
+			} break;
+			case Animation::TYPE_SCALE_3D: {
+				Vector3 scale;
+				if (p_animation->try_scale_track_interpolate(track_i, p_time, &scale) == OK) {
+					p_skeleton->set_bone_pose_scale(bone, scale);
+				}
+			} break;
+			default:
+				break;
+		}
+	}
+}
+
+int64_t IKEffectorAnimation3D::_get_source_memory_usage(const Ref<Animation> &p_animation) {
+	// Key time plus components, matching how uncompressed transform tracks are stored.
+	int64_t bytes = 0;
+	for (int32_t track_i = 0; track_i < p_animation->get_track_count(); track_i++) {
+		const int64_t key_count = p_animation->track_get_key_count(track_i);
+		switch (p_animation->track_get_type(track_i)) {
+			case Animation::TYPE_POSITION_3D:
+			case Animation::TYPE_SCALE_3D:
+				bytes += key_count * sizeof(float) * 4;
+				break;
+			case Animation::TYPE_ROTATION_3D:
+				bytes += key_count * sizeof(float) * 5;
+				break;
+			default:
+				break;
+		}
+	}
+	return bytes;
+}
+
+Error IKEffectorAnimation3D::compress(const Ref<Animation> &p_animation, EWBIK3D *p_ik, double p_sample_rate, const PackedStringArray &p_hint_bones, double p_hint_interval) {
+	ERR_FAIL_COND_V(p_animation.is_null(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_NULL_V(p_ik, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_sample_rate <= 0.0, ERR_INVALID_PARAMETER);
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, ERR_UNCONFIGURED);
+
+	effector_tracks.clear();
+	hint_tracks.clear();
+	length = p_animation->get_length();
+	sample_rate = p_sample_rate;
+	frame_count = int32_t(Math::floor(length * sample_rate + CMP_EPSILON)) + 1;
+
+	Vector<int32_t> effector_bones;
+	for (int32_t pin_i = 0; pin_i < p_ik->get_pin_count(); pin_i++) {
+		const StringName bone_name = p_ik->get_pin_bone_name(pin_i);
+		const int32_t bone = skeleton->find_bone(bone_name);
+		if (bone == -1) {
+			continue;
+		}
+		EffectorTrack track;
+		track.bone = bone_name;
+		track.use_rotation = !p_ik->get_pin_direction_priorities(pin_i).is_zero_approx();
+		track.positions.resize(frame_count);
+		if (track.use_rotation) {
+			track.rotations.resize(frame_count * 4);
+		}
+		effector_tracks.push_back(track);
+		effector_bones.push_back(bone);
+	}
+	Vector<int32_t> hint_bones;
+	for (const String &bone_name : p_hint_bones) {
+		const int32_t bone = skeleton->find_bone(bone_name);
+		ERR_CONTINUE_MSG(bone == -1, vformat("Hint bone %s is not in the skeleton.", bone_name));
+		HintTrack track;
+		track.bone = bone_name;
+		hint_tracks.push_back(track);
+		hint_bones.push_back(bone);
+	}
+	const int32_t hint_stride = p_hint_interval > 0.0 ? MAX(1, int32_t(Math::round(p_hint_interval * sample_rate))) : frame_count;
+
+	const int32_t bone_count = skeleton->get_bone_count();
+	Vector<Vector3> saved_positions, saved_scales;
+	Vector<Quaternion> saved_rotations;
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		saved_positions.push_back(skeleton->get_bone_pose_position(bone_i));
+		saved_rotations.push_back(skeleton->get_bone_pose_rotation(bone_i));
+		saved_scales.push_back(skeleton->get_bone_pose_scale(bone_i));
+	}
+
+	for (int32_t frame_i = 0; frame_i < frame_count; frame_i++) {
+		_apply_source_pose(p_animation, skeleton, MIN(frame_i / sample_rate, length));
+		for (int32_t track_i = 0; track_i < effector_tracks.size(); track_i++) {
+			EffectorTrack &track = effector_tracks.write[track_i];
+			const Transform3D global_pose = skeleton->get_bone_global_pose(effector_bones[track_i]);
+			track.positions.write[frame_i] = global_pose.origin;
+			if (track.use_rotation) {
+				_write_rotation(track.rotations, frame_i, global_pose.basis.get_rotation_quaternion());
+			}
+		}
+		if (frame_i % hint_stride && frame_i != frame_count - 1) {
+			continue;
+		}
+		for (int32_t track_i = 0; track_i < hint_tracks.size(); track_i++) {
+			HintTrack &track = hint_tracks.write[track_i];
+			track.frames.push_back(frame_i);
+			track.rotations.resize(track.frames.size() * 4);
+			_write_rotation(track.rotations, track.frames.size() - 1, skeleton->get_bone_pose_rotation(hint_bones[track_i]));
+		}
+	}
+
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		skeleton->set_bone_pose_position(bone_i, saved_positions[bone_i]);
+		skeleton->set_bone_pose_rotation(bone_i, saved_rotations[bone_i]);
+		skeleton->set_bone_pose_scale(bone_i, saved_scales[bone_i]);
+	}
+	emit_changed();
+	return OK;
+}
+
+Transform3D IKEffectorAnimation3D::get_effector_target(int32_t p_track, double p_time) const {
+	ERR_FAIL_INDEX_V(p_track, effector_tracks.size(), Transform3D());
+	ERR_FAIL_COND_V(frame_count == 0, Transform3D());
+	const EffectorTrack &track = effector_tracks[p_track];
+	const double frame = CLAMP(p_time * sample_rate, 0.0, double(frame_count - 1));
+	const int32_t from = int32_t(frame);
+	const int32_t to = MIN(from + 1, frame_count - 1);
+	const real_t weight = frame - from;
+	Transform3D target;
+	target.origin = track.positions[from].lerp(track.positions[to], weight);
+	if (track.use_rotation) {
+		target.basis = Basis(_read_rotation(track.rotations, from).slerp(_read_rotation(track.rotations, to), weight));
+	}
+	return target;
+}
+
+void IKEffectorAnimation3D::set_effector_track_positions(int32_t p_track, const PackedVector3Array &p_positions) {
+	ERR_FAIL_INDEX(p_track, effector_tracks.size());
+	ERR_FAIL_COND(p_positions.size() != frame_count);
+	effector_tracks.write[p_track].positions = p_positions;
+	emit_changed();
+}
+
+void IKEffectorAnimation3D::_apply_hints(Skeleton3D *p_skeleton, double p_frame) const {
+	if (hint_tracks.is_empty()) {
+		return;
+	}
+	// Baking applies one animation to several rigs at once, so the cache is shared under a lock.
+	MutexLock lock(hint_bone_cache_mutex);
+	if (hint_bone_cache.skeleton != p_skeleton->get_instance_id() || hint_bone_cache.skeleton_version != p_skeleton->get_version() || hint_bone_cache.bones.size() != uint32_t(hint_tracks.size())) {
+		hint_bone_cache.skeleton = p_skeleton->get_instance_id();
+		hint_bone_cache.skeleton_version = p_skeleton->get_version();
+		hint_bone_cache.bones.resize(hint_tracks.size());
+		for (int32_t track_i = 0; track_i < hint_tracks.size(); track_i++) {
+			hint_bone_cache.bones[track_i] = p_skeleton->find_bone(hint_tracks[track_i].bone);
+		}
+	}
+	for (int32_t track_i = 0; track_i < hint_tracks.size(); track_i++) {
+		const HintTrack &track = hint_tracks[track_i];
+		const int32_t bone = hint_bone_cache.bones[track_i];
+		if (bone == -1 || track.frames.is_empty()) {
+			continue;
+		}
+		int32_t key = 0;
+		while (key + 1 < track.frames.size() && track.frames[key + 1] <= p_frame) {
+			key++;
+		}
+		Quaternion rotation = _read_rotation(track.rotations, key);
+		if (key + 1 < track.frames.size()) {
+			const real_t weight = (p_frame - track.frames[key]) / double(track.frames[key + 1] - track.frames[key]);
+			rotation = rotation.slerp(_read_rotation(track.rotations, key + 1), weight);
+		}
+		p_skeleton->set_bone_pose_rotation(bone, rotation);
+	}
+}
+
+void IKEffectorAnimation3D::apply(EWBIK3D *p_ik, double p_time, bool p_seek) const {
+	ERR_FAIL_NULL(p_ik);
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL(skeleton);
+	if (frame_count == 0) {
+		return;
+	}
+	for (int32_t track_i = 0; track_i < effector_tracks.size(); track_i++) {
+		const int32_t pin = p_ik->find_pin(effector_tracks[track_i].bone);
+		if (pin == -1) {
+			continue;
+		}
+		p_ik->set_pin_target_transform_override(pin, get_effector_target(track_i, p_time));
+	}
+	// Sequential playback starts from the previous solved pose. A seek has no usable
+	// history, so it starts from rest and spends extra passes converging.
+	if (p_seek) {
+		skeleton->reset_bone_poses();
+	}
+	_apply_hints(skeleton, CLAMP(p_time * sample_rate, 0.0, double(frame_count - 1)));
+	const int32_t passes = p_seek ? warm_start_passes + 1 : 1;
+	for (int32_t pass_i = 0; pass_i < passes; pass_i++) {
+		p_ik->solve();
+	}
+}
+
+void IKEffectorAnimation3D::release(EWBIK3D *p_ik) const {
+	ERR_FAIL_NULL(p_ik);
+	for (const EffectorTrack &track : effector_tracks) {
+		const int32_t pin = p_ik->find_pin(track.bone);
+		if (pin != -1) {
+			p_ik->clear_pin_target_transform_override(pin);
+		}
+	}
+}
+
+void IKEffectorAnimation3D::clear() {
+	effector_tracks.clear();
+	hint_tracks.clear();
+	length = 0.0;
+	frame_count = 0;
+	emit_changed();
+}
+
+double IKEffectorAnimation3D::get_length() const {
+	return length;
+}
+
+double IKEffectorAnimation3D::get_sample_rate() const {
+	return sample_rate;
+}
+
+int32_t IKEffectorAnimation3D::get_frame_count() const {
+	return frame_count;
+}
+
+int32_t IKEffectorAnimation3D::get_effector_track_count() const {
+	return effector_tracks.size();
+}
+
+StringName IKEffectorAnimation3D::get_effector_track_bone(int32_t p_track) const {
+	ERR_FAIL_INDEX_V(p_track, effector_tracks.size(), StringName());
+	return effector_tracks[p_track].bone;
+}
+
+int32_t IKEffectorAnimation3D::get_hint_track_count() const {
+	return hint_tracks.size();
+}
+
+void IKEffectorAnimation3D::set_warm_start_passes(int32_t p_passes) {
+	warm_start_passes = MAX(0, p_passes);
+}
+
+int32_t IKEffectorAnimation3D::get_warm_start_passes() const {
+	return warm_start_passes;
+}
+
+int64_t IKEffectorAnimation3D::get_memory_usage() const {
+	int64_t bytes = 0;
+	for (const EffectorTrack &track : effector_tracks) {
+		bytes += track.positions.size() * sizeof(Vector3) + track.rotations.size() * sizeof(float);
+	}
+	for (const HintTrack &track : hint_tracks) {
+		bytes += track.frames.size() * sizeof(int32_t) + track.rotations.size() * sizeof(float);
+	}
+	return bytes;
+}
+
+Dictionary IKEffectorAnimation3D::measure_library(const TypedArray<Animation> &p_animations, EWBIK3D *p_ik, double p_sample_rate, const PackedStringArray &p_hint_bones, double p_hint_interval) {
+	ERR_FAIL_NULL_V(p_ik, Dictionary());
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, Dictionary());
+
+	const int32_t bone_count = skeleton->get_bone_count();
+	Vector<double> error_sum, error_max;
+	error_sum.resize(bone_count);
+	error_max.resize(bone_count);
+	error_sum.fill(0.0);
+	error_max.fill(0.0);
+	int64_t error_samples = 0, source_bytes = 0, compressed_bytes = 0;
+	Vector<Vector3> solved_positions;
+	Vector<Quaternion> solved_rotations;
+	solved_positions.resize(bone_count);
+	solved_rotations.resize(bone_count);
+
+	Array clips;
+	for (int32_t animation_i = 0; animation_i < p_animations.size(); animation_i++) {
+		Ref<Animation> animation = p_animations[animation_i];
+		if (animation.is_null()) {
+			continue;
+		}
+		Ref<IKEffectorAnimation3D> compressed;
+		compressed.instantiate();
+		if (compressed->compress(animation, p_ik, p_sample_rate, p_hint_bones, p_hint_interval) != OK) {
+			continue;
+		}
+		double clip_error_max = 0.0;
+		for (int32_t frame_i = 0; frame_i < compressed->frame_count; frame_i++) {
+			const double time = MIN(frame_i / p_sample_rate, compressed->length);
+			// Restore the previous reconstruction so playback stays warm-started as it would at runtime.
+			for (int32_t bone_i = 0; frame_i > 0 && bone_i < bone_count; bone_i++) {
+				skeleton->set_bone_pose_position(bone_i, solved_positions[bone_i]);
+				skeleton->set_bone_pose_rotation(bone_i, solved_rotations[bone_i]);
+			}
+			compressed->apply(p_ik, time, frame_i == 0);
+			for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+				solved_positions.write[bone_i] = skeleton->get_bone_pose_position(bone_i);
+				solved_rotations.write[bone_i] = skeleton->get_bone_pose_rotation(bone_i);
+			}
+			_apply_source_pose(animation, skeleton, time);
+			for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+				const double error = skeleton->get_bone_pose_rotation(bone_i).normalized().angle_to(solved_rotations[bone_i].normalized());
+				error_sum.write[bone_i] += error;
+				error_max.write[bone_i] = MAX(error_max[bone_i], error);
+				clip_error_max = MAX(clip_error_max, error);
+			}
+			error_samples++;
+		}
+		const int64_t clip_source_bytes = _get_source_memory_usage(animation);
+		const int64_t clip_compressed_bytes = compressed->get_memory_usage();
+		source_bytes += clip_source_bytes;
+		compressed_bytes += clip_compressed_bytes;
+
+		Dictionary clip;
+		clip["name"] = animation->get_name();
+		clip["frames"] = compressed->frame_count;
+		clip["source_bytes"] = clip_source_bytes;
+		clip["compressed_bytes"] = clip_compressed_bytes;
+		clip["max_error"] = clip_error_max;
+		clips.push_back(clip);
+	}
+	p_ik->clear_pin_target_transform_overrides();
+	skeleton->reset_bone_poses();
+
+	Dictionary bone_errors;
+	for (int32_t bone_i = 0; bone_i < bone_count && error_samples; bone_i++) {
+		Dictionary bone_error;
+		bone_error["mean_error"] = error_sum[bone_i] / error_samples;
+		bone_error["max_error"] = error_max[bone_i];
+		bone_errors[skeleton->get_bone_name(bone_i)] = bone_error;
+	}
+	Dictionary report;
+	report["clips"] = clips;
+	report["source_bytes"] = source_bytes;
+	report["compressed_bytes"] = compressed_bytes;
+	report["saved_bytes"] = source_bytes - compressed_bytes;
+	report["compression_ratio"] = compressed_bytes > 0 ? double(source_bytes) / compressed_bytes : 0.0;
+	report["bone_errors"] = bone_errors;
+	return report;
+}
+
+void IKEffectorAnimation3D::_set_data(const Dictionary &p_data) {
+	effector_tracks.clear();
+	hint_tracks.clear();
+	length = p_data.get("length", 0.0);
+	sample_rate = p_data.get("sample_rate", 30.0);
+	frame_count = p_data.get("frame_count", 0);
+	Array effectors = p_data.get("effectors", Array());
+	for (int32_t effector_i = 0; effector_i < effectors.size(); effector_i++) {
+		Dictionary effector = effectors[effector_i];
+		EffectorTrack track;
+		track.bone = effector.get("bone", StringName());
+		track.use_rotation = effector.get("use_rotation", false);
+		track.positions = effector.get("positions", PackedVector3Array());
+		track.rotations = effector.get("rotations", PackedFloat32Array());
+		ERR_CONTINUE(track.positions.size() != frame_count);
+		ERR_CONTINUE(track.use_rotation && track.rotations.size() != frame_count * 4);
+		effector_tracks.push_back(track);
+	}
+	Array hints = p_data.get("hints", Array());
+	for (int32_t hint_i = 0; hint_i < hints.size(); hint_i++) {
+		Dictionary hint = hints[hint_i];
+		HintTrack track;
+		track.bone = hint.get("bone", StringName());
+		track.frames = hint.get("frames", PackedInt32Array());
+		track.rotations = hint.get("rotations", PackedFloat32Array());
+		ERR_CONTINUE(track.rotations.size() != track.frames.size() * 4);
+		hint_tracks.push_back(track);
+	}
+	emit_changed();
+}
+
+Dictionary IKEffectorAnimation3D::_get_data() const {
+	Array effectors;
+	for (const EffectorTrack &track : effector_tracks) {
+		Dictionary effector;
+		effector["bone"] = track.bone;
+		effector["use_rotation"] = track.use_rotation;
+		effector["positions"] = track.positions;
+		effector["rotations"] = track.rotations;
+		effectors.push_back(effector);
+	}
+	Array hints;
+	for (const HintTrack &track : hint_tracks) {
+		Dictionary hint;
+		hint["bone"] = track.bone;
+		hint["frames"] = track.frames;
+		hint["rotations"] = track.rotations;
+		hints.push_back(hint);
+	}
+	Dictionary data;
+	data["length"] = length;
+	data["sample_rate"] = sample_rate;
+	data["frame_count"] = frame_count;
+	data["effectors"] = effectors;
+	data["hints"] = hints;
+	return data;
+}
+
+void IKEffectorAnimation3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_set_data", "data"), &IKEffectorAnimation3D::_set_data);
+	ClassDB::bind_method(D_METHOD("_get_data"), &IKEffectorAnimation3D::_get_data);
+	ClassDB::bind_method(D_METHOD("compress", "animation", "ik", "sample_rate", "hint_bones", "hint_interval"), &IKEffectorAnimation3D::compress, DEFVAL(30.0), DEFVAL(PackedStringArray()), DEFVAL(0.5));
+	ClassDB::bind_method(D_METHOD("apply", "ik", "time", "seek"), &IKEffectorAnimation3D::apply, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("release", "ik"), &IKEffectorAnimation3D::release);
+	ClassDB::bind_method(D_METHOD("clear"), &IKEffectorAnimation3D::clear);
+	ClassDB::bind_method(D_METHOD("get_length"), &IKEffectorAnimation3D::get_length);
+	ClassDB::bind_method(D_METHOD("get_sample_rate"), &IKEffectorAnimation3D::get_sample_rate);
+	ClassDB::bind_method(D_METHOD("get_frame_count"), &IKEffectorAnimation3D::get_frame_count);
+	ClassDB::bind_method(D_METHOD("get_effector_track_count"), &IKEffectorAnimation3D::get_effector_track_count);
+	ClassDB::bind_method(D_METHOD("get_effector_track_bone", "track"), &IKEffectorAnimation3D::get_effector_track_bone);
+	ClassDB::bind_method(D_METHOD("get_effector_target", "track", "time"), &IKEffectorAnimation3D::get_effector_target);
+	ClassDB::bind_method(D_METHOD("set_effector_track_positions", "track", "positions"), &IKEffectorAnimation3D::set_effector_track_positions);
+	ClassDB::bind_method(D_METHOD("get_hint_track_count"), &IKEffectorAnimation3D::get_hint_track_count);
+	ClassDB::bind_method(D_METHOD("set_warm_start_passes", "passes"), &IKEffectorAnimation3D::set_warm_start_passes);
+	ClassDB::bind_method(D_METHOD("get_warm_start_passes"), &IKEffectorAnimation3D::get_warm_start_passes);
+	ClassDB::bind_method(D_METHOD("get_memory_usage"), &IKEffectorAnimation3D::get_memory_usage);
+	ClassDB::bind_static_method("IKEffectorAnimation3D", D_METHOD("measure_library", "animations", "ik", "sample_rate", "hint_bones", "hint_interval"), &IKEffectorAnimation3D::measure_library, DEFVAL(30.0), DEFVAL(PackedStringArray()), DEFVAL(0.5));
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "warm_start_passes", PROPERTY_HINT_RANGE, "0,64,1,or_greater"), "set_warm_start_passes", "get_warm_start_passes");
+	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "_data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL), "_set_data", "_get_data");
+}
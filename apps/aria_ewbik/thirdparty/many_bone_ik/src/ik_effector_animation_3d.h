@@ -0,0 +1,107 @@
+/**************************************************************************/
+/*  ik_effector_animation_3d.h                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/resource.h"
+#include "core/math/quaternion.h"
+#include "core/os/mutex.h"
+#include "core/variant/typed_array.h"
+#include "scene/resources/animation.h"
+
+class EWBIK3D;
+class Skeleton3D;
+
+// An animation stored as pin target tracks only. Playback rebuilds the full
+// pose with the solver, warm-started from the previous frame's result, with
+// optional sparse rotation hints to steer it toward the source's solution.
+class IKEffectorAnimation3D : public Resource {
+	GDCLASS(IKEffectorAnimation3D, Resource);
+
+	struct EffectorTrack {
+		StringName bone;
+		bool use_rotation = false;
+		PackedVector3Array positions;
+		PackedFloat32Array rotations; // Four components per frame, only when use_rotation is set.
+	};
+
+	struct HintTrack {
+		StringName bone;
+		PackedInt32Array frames;
+		PackedFloat32Array rotations; // Four components per key.
+	};
+
+	// Hint bone indices for the skeleton they were last resolved against.
+	struct HintBoneCache {
+		ObjectID skeleton;
+		uint64_t skeleton_version = 0;
+		LocalVector<int32_t> bones;
+	};
+
+	Vector<EffectorTrack> effector_tracks;
+	Vector<HintTrack> hint_tracks;
+	mutable HintBoneCache hint_bone_cache;
+	mutable Mutex hint_bone_cache_mutex;
+	double length = 0.0;
+	double sample_rate = 30.0;
+	int32_t frame_count = 0;
+	int32_t warm_start_passes = 4;
+
+	static Quaternion _read_rotation(const PackedFloat32Array &p_rotations, int32_t p_index);
+	static void _write_rotation(PackedFloat32Array &r_rotations, int32_t p_index, const Quaternion &p_rotation);
+	static void _apply_source_pose(const Ref<Animation> &p_animation, Skeleton3D *p_skeleton, double p_time);
+	static int64_t _get_source_memory_usage(const Ref<Animation> &p_animation);
+	void _apply_hints(Skeleton3D *p_skeleton, double p_frame) const;
+
+protected:
+	static void _bind_methods();
+	void _set_data(const Dictionary &p_data);
+	Dictionary _get_data() const;
+
+public:
+	Error compress(const Ref<Animation> &p_animation, EWBIK3D *p_ik, double p_sample_rate = 30.0, const PackedStringArray &p_hint_bones = PackedStringArray(), double p_hint_interval = 0.5);
+	void apply(EWBIK3D *p_ik, double p_time, bool p_seek = false) const;
+	void release(EWBIK3D *p_ik) const;
+	void clear();
+
+	double get_length() const;
+	double get_sample_rate() const;
+	int32_t get_frame_count() const;
+	int32_t get_effector_track_count() const;
+	StringName get_effector_track_bone(int32_t p_track) const;
+	Transform3D get_effector_target(int32_t p_track, double p_time) const;
+	void set_effector_track_positions(int32_t p_track, const PackedVector3Array &p_positions);
+	int32_t get_hint_track_count() const;
+	void set_warm_start_passes(int32_t p_passes);
+	int32_t get_warm_start_passes() const;
+	int64_t get_memory_usage() const;
+
+	static Dictionary measure_library(const TypedArray<Animation> &p_animations, EWBIK3D *p_ik, double p_sample_rate = 30.0, const PackedStringArray &p_hint_bones = PackedStringArray(), double p_hint_interval = 0.5);
+};
@@ -32,6 +32,8 @@
 
 #include "core/math/quaternion.h"
 #include "ik_open_cone_3d.h"
+#include "ik_trace_3d.h"
+#include "math/ik_deterministic_math.h"
 #include "math/ik_node_3d.h"
 #include "math/interval_math.h"
 
@@ -55,7 +57,7 @@ void IKKusudama3D::_update_constraint(Ref<IKNode3D> p_limiting_axes) {
 			Quaternion this_to_next = Quaternion(this_control_point, next_control_point);
 
 			Vector3 axis = this_to_next.get_axis();
-			double angle = this_to_next.get_angle() / 2.0;
+			double angle = IKMath::get_angle(this_to_next) / 2.0;
 
 			Vector3 half_angle;
 			if (Math::is_zero_approx(axis.length_squared())) {
@@ -63,7 +65,7 @@ void IKKusudama3D::_update_constraint(Ref<IKNode3D> p_limiting_axes) {
 			} else {
 				half_angle = this_control_point.rotated(axis, angle);
 			}
-			half_angle *= this_to_next.get_angle();
+			half_angle *= IKMath::get_angle(this_to_next);
 			half_angle.normalize();
 
 			directions.push_back(half_angle);
@@ -122,14 +124,15 @@ void IKKusudama3D::set_axial_limits(real_t min_angle, real_t in_range) {
 	twist_min_vec = twist_min_rot.xform(z_axis).normalized();
 	twist_center_vec = twist_min_rot.xform(twist_min_vec).normalized();
 	twist_center_rot = Quaternion(z_axis, twist_center_vec);
-	twist_half_range_half_cos = Math::cos(in_range / real_t(4.0)); // For the quadrance angle. We need half the range angle since starting from the center, and half of that since quadrance takes cos(angle/2).
+	twist_half_range_half_cos = IKMath::cos(in_range / real_t(4.0)); // For the quadrance angle. We need half the range angle since starting from the center, and half of that since quadrance takes cos(angle/2).
 	twist_max_vec = IKKusudama3D::get_quaternion_axis_angle(y_axis, in_range).xform(twist_min_vec).normalized();
 	twist_max_rot = Quaternion(z_axis, twist_max_vec);
 }
 
-void IKKusudama3D::set_snap_to_twist_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_constraint_axes, real_t p_dampening, real_t p_cos_half_dampen) {
+bool IKKusudama3D::set_snap_to_twist_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_constraint_axes, real_t p_dampening, real_t p_cos_half_dampen) {
+	IK_TRACE_SCOPE("IKKusudama3D::set_snap_to_twist_limit");
 	if (!is_axially_constrained()) {
-		return;
+		return false;
 	}
 	Transform3D global_transform_constraint = p_constraint_axes->get_global_transform();
 	Transform3D global_transform_to_set = p_to_set->get_global_transform();
@@ -138,10 +141,12 @@ void IKKusudama3D::set_snap_to_twist_limit(Ref<IKNode3D> p_bone_direction, Ref<I
 	Basis align_rot = (global_twist_center.inverse() * global_transform_to_set.basis).orthonormalized();
 	Quaternion twist_rotation, swing_rotation; // Hold the ik transform's decomposed swing and twist away from global_twist_centers's global basis.
 	get_swing_twist(align_rot.get_rotation_quaternion(), Vector3(0, 1, 0), swing_rotation, twist_rotation);
+	bool snapped = Math::abs(twist_rotation.w) < twist_half_range_half_cos;
 	twist_rotation = IKBoneSegment3D::clamp_to_cos_half_angle(twist_rotation, twist_half_range_half_cos);
 	Basis recomposition = (global_twist_center * (swing_rotation * twist_rotation)).orthonormalized();
 	Basis rotation = parent_global_inverse * recomposition;
 	p_to_set->set_transform(Transform3D(rotation, p_to_set->get_transform().origin));
+	return snapped;
 }
 
 void IKKusudama3D::get_swing_twist(
@@ -159,6 +164,10 @@ void IKKusudama3D::get_swing_twist(
 		r_twist = Quaternion();
 		return;
 	}
+	if (IKMath::get_policy() == IKMath::POLICY_APPROXIMATE) {
+		IKApproximateMath::swing_twist(p_rotation, p_axis, r_swing, r_twist);
+		return;
+	}
 
 	// Use interval arithmetic for robust swing-twist decomposition
 	IntervalQuaternion rotation_interval(p_rotation);
@@ -379,15 +388,16 @@ void IKKusudama3D::set_open_cones(TypedArray<IKLimitCone3D> p_cones) {
 	}
 }
 
-void IKKusudama3D::snap_to_orientation_limit(Ref<IKNode3D> bone_direction, Ref<IKNode3D> to_set, Ref<IKNode3D> limiting_axes, real_t p_dampening, real_t p_cos_half_angle_dampen) {
+bool IKKusudama3D::snap_to_orientation_limit(Ref<IKNode3D> bone_direction, Ref<IKNode3D> to_set, Ref<IKNode3D> limiting_axes, real_t p_dampening, real_t p_cos_half_angle_dampen) {
+	IK_TRACE_SCOPE("IKKusudama3D::snap_to_orientation_limit");
 	if (bone_direction.is_null()) {
-		return;
+		return false;
 	}
 	if (to_set.is_null()) {
-		return;
+		return false;
 	}
 	if (limiting_axes.is_null()) {
-		return;
+		return false;
 	}
 	Vector<double> in_bounds;
 	in_bounds.resize(1);
@@ -395,19 +405,17 @@ void IKKusudama3D::snap_to_orientation_limit(Ref<IKNode3D> bone_direction, Ref<I
 	Vector3 limiting_origin = limiting_axes->get_global_transform().origin;
 	Vector3 bone_dir_xform = bone_direction->get_global_transform().xform(Vector3(0.0, 1.0, 0.0));
 
-	bone_ray->set_point_1(limiting_origin);
-	bone_ray->set_point_2(bone_dir_xform);
-
-	Vector3 bone_tip = limiting_axes->to_local(bone_ray->get_point_2());
+	Vector3 bone_tip = limiting_axes->to_local(bone_dir_xform);
 	Vector3 in_limits = get_local_point_in_limits(bone_tip, &in_bounds);
 
 	if (in_bounds[0] < 0) {
-		constrained_ray->set_point_1(bone_ray->get_point_1());
-		constrained_ray->set_point_2(limiting_axes->to_global(in_limits));
+		Vector3 constrained_tip = limiting_axes->to_global(in_limits);
 
-		Quaternion rectified_rot = Quaternion(bone_ray->get_heading(), constrained_ray->get_heading());
+		Quaternion rectified_rot = Quaternion(bone_dir_xform - limiting_origin, constrained_tip - limiting_origin);
 		to_set->rotate_local_with_global(rectified_rot);
+		return true;
 	}
+	return false;
 }
 
 bool IKKusudama3D::is_nan_vector(const Vector3 &vec) {
@@ -442,7 +450,7 @@ Quaternion IKKusudama3D::clamp_to_quadrance_angle(Quaternion p_rotation, double
 	if (!rotation.is_finite() || !clamped_rotation.is_finite()) {
 		return Quaternion();
 	}
-	return rotation.slerp(clamped_rotation, over_limit);
+	return IKMath::slerp(rotation, clamped_rotation, over_limit);
 }
 
 void IKKusudama3D::clear_open_cones() {
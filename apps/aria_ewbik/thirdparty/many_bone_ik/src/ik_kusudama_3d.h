@@ -95,11 +95,6 @@ public:
 
 	void update_tangent_radii();
 
-	Ref<IKRay3D> bone_ray = Ref<IKRay3D>(memnew(IKRay3D()));
-	Ref<IKRay3D> constrained_ray = Ref<IKRay3D>(memnew(IKRay3D()));
-	double unit_hyper_area = 2 * Math::pow(Math::PI, 2);
-	double unit_area = 4 * Math::PI;
-
 	/**
 	 * Get the swing rotation and twist rotation for the specified axis. The twist rotation represents the rotation around the specified axis. The swing rotation represents the rotation of the specified
 	 * axis itself, which is the rotation around an axis perpendicular to the specified axis. The swing and twist rotation can be
@@ -124,8 +119,9 @@ public:
 	 * them to satisfy the snap limits.
 	 *
 	 * @param to_set
+	 * @return true if the bone was outside the limits and got rotated back in
 	 */
-	void snap_to_orientation_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_limiting_axes, real_t p_dampening, real_t p_cos_half_angle_dampen);
+	bool snap_to_orientation_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_limiting_axes, real_t p_dampening, real_t p_cos_half_angle_dampen);
 
 	bool is_nan_vector(const Vector3 &vec);
 
@@ -146,9 +142,9 @@ public:
 	 *
 	 * @param to_set
 	 * @param limiting_axes
-	 * @return radians of the twist required to snap bone into twist limits (0 if bone is already in twist limits)
+	 * @return true if the twist was outside the limits and got clamped
 	 */
-	void set_snap_to_twist_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_limiting_axes, real_t p_dampening, real_t p_cos_half_dampen);
+	bool set_snap_to_twist_limit(Ref<IKNode3D> p_bone_direction, Ref<IKNode3D> p_to_set, Ref<IKNode3D> p_limiting_axes, real_t p_dampening, real_t p_cos_half_dampen);
 
 	/**
 	 * Given a point (in local coordinates), checks to see if a ray can be extended from the Kusudama's
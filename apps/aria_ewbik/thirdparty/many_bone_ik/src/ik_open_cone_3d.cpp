@@ -32,6 +32,7 @@
 
 #include "core/math/quaternion.h"
 #include "ik_kusudama_3d.h"
+#include "math/ik_deterministic_math.h"
 #include "math/interval_math.h"
 
 using namespace IntervalMath;
@@ -95,7 +96,7 @@ void IKLimitCone3D::update_tangent_handles(Ref<IKLimitCone3D> p_next) {
 	double boundaryPlusTangentRadiusB = radB + tRadius;
 
 	// the axis of this cone, scaled to minimize its distance to the tangent contact points.
-	Vector3 scaledAxisA = A * Math::cos(boundaryPlusTangentRadiusA);
+	Vector3 scaledAxisA = A * IKMath::cos(boundaryPlusTangentRadiusA);
 	// a point on the plane running through the tangent contact points
 	Vector3 safe_arc_normal = arc_normal;
 	if (Math::is_zero_approx(safe_arc_normal.length_squared())) {
@@ -111,7 +112,7 @@ void IKLimitCone3D::update_tangent_handles(Ref<IKLimitCone3D> p_next) {
 	Quaternion tempVar2 = IKKusudama3D::get_quaternion_axis_angle(safe_A, Math::PI / 2);
 	Vector3 planeDir2A = tempVar2.xform(planeDir1A);
 
-	Vector3 scaledAxisB = B * cos(boundaryPlusTangentRadiusB);
+	Vector3 scaledAxisB = B * IKMath::cos(boundaryPlusTangentRadiusB);
 	// a point on the plane running through the tangent contact points
 	Quaternion tempVar3 = IKKusudama3D::get_quaternion_axis_angle(safe_arc_normal, boundaryPlusTangentRadiusB);
 	Vector3 planeDir1B = tempVar3.xform(B);
@@ -161,14 +162,11 @@ void IKLimitCone3D::update_tangent_handles(Ref<IKLimitCone3D> p_next) {
 		}
 		tangent_circle_center_next_2.normalize();
 	}
-	if (p_next.is_valid()) {
-		compute_triangles(p_next);
-	}
 }
 
 void IKLimitCone3D::set_tangent_circle_radius_next(double rad) {
 	tangent_circle_radius_next = rad;
-	tangent_circle_radius_next_cos = cos(tangent_circle_radius_next);
+	tangent_circle_radius_next_cos = IKMath::cos(tangent_circle_radius_next);
 }
 
 Vector3 IKLimitCone3D::get_tangent_circle_center_next_1() {
@@ -187,19 +185,6 @@ Vector3 IKLimitCone3D::get_tangent_circle_center_next_2() {
 	return tangent_circle_center_next_2;
 }
 
-void IKLimitCone3D::compute_triangles(Ref<IKLimitCone3D> p_next) {
-	if (p_next.is_null()) {
-		return;
-	}
-	first_triangle_next.write[1] = tangent_circle_center_next_1.normalized();
-	first_triangle_next.write[0] = get_control_point().normalized();
-	first_triangle_next.write[2] = p_next->get_control_point().normalized();
-
-	second_triangle_next.write[1] = tangent_circle_center_next_2.normalized();
-	second_triangle_next.write[0] = get_control_point().normalized();
-	second_triangle_next.write[2] = p_next->get_control_point().normalized();
-}
-
 Vector3 IKLimitCone3D::get_control_point() const {
 	return control_point;
 }
@@ -223,7 +208,7 @@ double IKLimitCone3D::get_radius_cosine() const {
 
 void IKLimitCone3D::set_radius(double p_radius) {
 	radius = p_radius;
-	radius_cosine = cos(p_radius);
+	radius_cosine = IKMath::cos(p_radius);
 }
 
 bool IKLimitCone3D::_determine_if_in_bounds(Ref<IKLimitCone3D> next, Vector3 input) const {
@@ -354,7 +339,7 @@ Vector3 IKLimitCone3D::get_on_great_tangent_triangle(Ref<IKLimitCone3D> next, Ve
 					plane_normal = Vector3(0, 1, 0);
 				}
 				plane_normal.normalize();
-				Quaternion rotate_about_by = Quaternion(plane_normal, tangent_circle_radius_next);
+				Quaternion rotate_about_by = IKMath::axis_angle(plane_normal, tangent_circle_radius_next);
 				return rotate_about_by.xform(tangent_circle_center_next_1);
 			} else {
 				return input;
@@ -373,7 +358,7 @@ Vector3 IKLimitCone3D::get_on_great_tangent_triangle(Ref<IKLimitCone3D> next, Ve
 					plane_normal = Vector3(0, 1, 0);
 				}
 				plane_normal.normalize();
-				Quaternion rotate_about_by = Quaternion(plane_normal, tangent_circle_radius_next);
+				Quaternion rotate_about_by = IKMath::axis_angle(plane_normal, tangent_circle_radius_next);
 				return rotate_about_by.xform(tangent_circle_center_next_2);
 			} else {
 				return input;
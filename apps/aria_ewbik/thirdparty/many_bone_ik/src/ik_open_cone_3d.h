@@ -37,7 +37,6 @@
 class IKKusudama3D;
 class IKLimitCone3D : public Resource {
 	GDCLASS(IKLimitCone3D, Resource);
-	void compute_triangles(Ref<IKLimitCone3D> p_next);
 
 	Vector3 control_point = Vector3(0, 1, 0);
 	Vector3 radial_point;
@@ -54,14 +53,6 @@ class IKLimitCone3D : public Resource {
 	double tangent_circle_radius_next = 0;
 	double tangent_circle_radius_next_cos = 0;
 
-	/**
-	 * A triangle where the [1] is the tangent_circle_next_n, and [0] and [2]
-	 * are the points at which the tangent circle intersects this IKLimitCone and the
-	 * next IKLimitCone.
-	 */
-	Vector<Vector3> first_triangle_next = { Vector3(), Vector3(), Vector3() };
-	Vector<Vector3> second_triangle_next = { Vector3(), Vector3(), Vector3() };
-
 	/**
 	 *
 	 * @param next
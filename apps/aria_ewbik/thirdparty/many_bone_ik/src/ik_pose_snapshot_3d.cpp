@@ -0,0 +1,407 @@
+/**************************************************************************/
+/*  ik_pose_snapshot_3d.cpp                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_pose_snapshot_3d.h"
+
+#include "many_bone_ik_3d.h"
+#include "scene/3d/skeleton_3d.h"
+
+// The three smallest components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)].
+static constexpr double SMALLEST_THREE_RANGE = 0.70710678118654752440;
+
+struct IKSnapshotBitWriter {
+	LocalVector<uint8_t> bytes;
+	uint32_t bit_count = 0;
+
+	void write(uint32_t p_value, int32_t p_bits) {
+		for (int32_t bit_i = 0; bit_i < p_bits; bit_i++, bit_count++) {
+			if ((bit_count & 7) == 0) {
+				bytes.push_back(0);
+			}
+			if ((p_value >> bit_i) & 1) {
+				bytes[bit_count >> 3] |= uint8_t(1 << (bit_count & 7));
+			}
+		}
+	}
+};
+
+struct IKSnapshotBitReader {
+	const uint8_t *bytes = nullptr;
+	uint32_t bit_size = 0;
+	uint32_t bit_count = 0;
+	bool overflowed = false;
+
+	uint32_t read(int32_t p_bits) {
+		uint32_t value = 0;
+		for (int32_t bit_i = 0; bit_i < p_bits; bit_i++, bit_count++) {
+			if (bit_count >= bit_size) {
+				overflowed = true;
+				return 0;
+			}
+			value |= uint32_t((bytes[bit_count >> 3] >> (bit_count & 7)) & 1) << bit_i;
+		}
+		return value;
+	}
+};
+
+bool IKPoseSnapshot3D::BoneState::operator==(const BoneState &p_other) const {
+	return largest == p_other.largest && components[0] == p_other.components[0] && components[1] == p_other.components[1] && components[2] == p_other.components[2] && position[0] == p_other.position[0] && position[1] == p_other.position[1] && position[2] == p_other.position[2];
+}
+
+int32_t IKPoseSnapshot3D::_get_class_bits(uint8_t p_bone_class) const {
+	switch (p_bone_class) {
+		case BONE_CLASS_ROOT:
+			return root_rotation_bits;
+		case BONE_CLASS_EFFECTOR:
+			return effector_rotation_bits;
+		default:
+			return chain_rotation_bits;
+	}
+}
+
+bool IKPoseSnapshot3D::_is_compatible_baseline(const IKPoseSnapshot3D *p_baseline) const {
+	if (p_baseline->root_rotation_bits != root_rotation_bits || p_baseline->chain_rotation_bits != chain_rotation_bits || p_baseline->effector_rotation_bits != effector_rotation_bits) {
+		return false;
+	}
+	if (p_baseline->position_bits != position_bits || p_baseline->position_range != position_range) {
+		return false;
+	}
+	if (p_baseline->bones.size() != bones.size()) {
+		return false;
+	}
+	for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+		if (p_baseline->bones[bone_i].bone != bones[bone_i].bone || p_baseline->bones[bone_i].bone_class != bones[bone_i].bone_class) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void IKPoseSnapshot3D::_quantize_rotation(const Quaternion &p_rotation, BoneState &r_state) const {
+	const Quaternion rotation = p_rotation.normalized();
+	const real_t values[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+	uint8_t largest = 0;
+	for (uint8_t value_i = 1; value_i < 4; value_i++) {
+		if (Math::abs(values[value_i]) > Math::abs(values[largest])) {
+			largest = value_i;
+		}
+	}
+	// q and -q are the same rotation, so flip to make the dropped component positive.
+	const double sign = values[largest] < 0.0f ? -1.0 : 1.0;
+	const double max_code = double((1 << _get_class_bits(r_state.bone_class)) - 1);
+	r_state.largest = largest;
+	for (uint8_t value_i = 0, component_i = 0; value_i < 4; value_i++) {
+		if (value_i == largest) {
+			continue;
+		}
+		const double unit = (sign * values[value_i] / SMALLEST_THREE_RANGE + 1.0) * 0.5;
+		r_state.components[component_i++] = uint16_t(CLAMP(Math::round(unit * max_code), 0.0, max_code));
+	}
+}
+
+Quaternion IKPoseSnapshot3D::_dequantize_rotation(const BoneState &p_state) const {
+	const double max_code = double((1 << _get_class_bits(p_state.bone_class)) - 1);
+	real_t values[4];
+	double sum_of_squares = 0.0;
+	for (uint8_t value_i = 0, component_i = 0; value_i < 4; value_i++) {
+		if (value_i == p_state.largest) {
+			continue;
+		}
+		const double value = (p_state.components[component_i++] / max_code * 2.0 - 1.0) * SMALLEST_THREE_RANGE;
+		values[value_i] = value;
+		sum_of_squares += value * value;
+	}
+	values[p_state.largest] = Math::sqrt(MAX(0.0, 1.0 - sum_of_squares));
+	return Quaternion(values[0], values[1], values[2], values[3]).normalized();
+}
+
+void IKPoseSnapshot3D::_encode(const IKPoseSnapshot3D *p_baseline) {
+	IKSnapshotBitWriter writer;
+	writer.write(FORMAT_VERSION, 8);
+	writer.write(delta, 1);
+	writer.write(bones.size(), 16);
+	if (!delta) {
+		writer.write(root_rotation_bits - 1, 4);
+		writer.write(chain_rotation_bits - 1, 4);
+		writer.write(effector_rotation_bits - 1, 4);
+		writer.write(position_bits - 1, 5);
+		uint32_t range_bits;
+		memcpy(&range_bits, &position_range, sizeof(range_bits));
+		writer.write(range_bits, 32);
+		for (const BoneState &state : bones) {
+			writer.write(state.bone, 16);
+			writer.write(state.bone_class, 2);
+		}
+	}
+	for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+		const BoneState &state = bones[bone_i];
+		if (delta) {
+			const bool changed = !(state == p_baseline->bones[bone_i]);
+			writer.write(changed, 1);
+			if (!changed) {
+				continue;
+			}
+		}
+		const int32_t bits = _get_class_bits(state.bone_class);
+		writer.write(state.largest, 2);
+		for (int32_t component_i = 0; component_i < 3; component_i++) {
+			writer.write(state.components[component_i], bits);
+		}
+		if (state.bone_class == BONE_CLASS_ROOT) {
+			for (int32_t axis_i = 0; axis_i < 3; axis_i++) {
+				writer.write(state.position[axis_i], position_bits);
+			}
+		}
+	}
+	data.resize(writer.bytes.size());
+	memcpy(data.ptrw(), writer.bytes.ptr(), writer.bytes.size());
+}
+
+Error IKPoseSnapshot3D::capture(EWBIK3D *p_ik, const Ref<IKPoseSnapshot3D> &p_baseline) {
+	ERR_FAIL_NULL_V(p_ik, ERR_INVALID_PARAMETER);
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, ERR_UNCONFIGURED);
+	const double max_position_code = double((uint64_t(1) << position_bits) - 1);
+	bones.clear();
+	for (const Ref<IKBone3D> &ik_bone : p_ik->get_bone_list()) {
+		if (ik_bone.is_null() || ik_bone->get_bone_id() == -1) {
+			continue;
+		}
+		BoneState state;
+		state.bone = ik_bone->get_bone_id();
+		if (ik_bone->get_parent().is_null()) {
+			state.bone_class = BONE_CLASS_ROOT;
+		} else if (ik_bone->is_pinned()) {
+			state.bone_class = BONE_CLASS_EFFECTOR;
+		}
+		_quantize_rotation(skeleton->get_bone_pose_rotation(state.bone), state);
+		if (state.bone_class == BONE_CLASS_ROOT) {
+			const Vector3 position = skeleton->get_bone_pose_position(state.bone);
+			for (int32_t axis_i = 0; axis_i < 3; axis_i++) {
+				const double unit = (CLAMP(double(position[axis_i]), -double(position_range), double(position_range)) / position_range + 1.0) * 0.5;
+				state.position[axis_i] = uint32_t(Math::round(unit * max_position_code));
+			}
+		}
+		bones.push_back(state);
+	}
+	ERR_FAIL_COND_V_MSG(bones.is_empty(), ERR_UNCONFIGURED, "The solver has no bones yet. Solve at least once before capturing a snapshot.");
+	// Fall back to a full snapshot when the baseline was taken with other settings or bones.
+	delta = p_baseline.is_valid() && _is_compatible_baseline(p_baseline.ptr());
+	_encode(delta ? p_baseline.ptr() : nullptr);
+	return OK;
+}
+
+Error IKPoseSnapshot3D::decode(const PackedByteArray &p_data, const Ref<IKPoseSnapshot3D> &p_baseline) {
+	IKSnapshotBitReader reader;
+	reader.bytes = p_data.ptr();
+	reader.bit_size = p_data.size() * 8;
+	ERR_FAIL_COND_V_MSG(reader.read(8) != FORMAT_VERSION || reader.overflowed, ERR_INVALID_DATA, "Unsupported pose snapshot format.");
+	const bool is_delta_data = reader.read(1);
+	const uint32_t bone_count = reader.read(16);
+	if (is_delta_data) {
+		ERR_FAIL_COND_V_MSG(p_baseline.is_null(), ERR_INVALID_PARAMETER, "A delta snapshot needs the baseline it was encoded against.");
+		ERR_FAIL_COND_V(p_baseline->bones.size() != bone_count, ERR_INVALID_DATA);
+		root_rotation_bits = p_baseline->root_rotation_bits;
+		chain_rotation_bits = p_baseline->chain_rotation_bits;
+		effector_rotation_bits = p_baseline->effector_rotation_bits;
+		position_bits = p_baseline->position_bits;
+		position_range = p_baseline->position_range;
+		bones = p_baseline->bones;
+	} else {
+		root_rotation_bits = reader.read(4) + 1;
+		chain_rotation_bits = reader.read(4) + 1;
+		effector_rotation_bits = reader.read(4) + 1;
+		position_bits = reader.read(5) + 1;
+		const uint32_t range_bits = reader.read(32);
+		memcpy(&position_range, &range_bits, sizeof(position_range));
+		bones.resize(bone_count);
+		for (BoneState &state : bones) {
+			state.bone = reader.read(16);
+			state.bone_class = reader.read(2);
+		}
+	}
+	for (BoneState &state : bones) {
+		if (is_delta_data && !reader.read(1)) {
+			continue;
+		}
+		const int32_t bits = _get_class_bits(state.bone_class);
+		state.largest = reader.read(2);
+		for (int32_t component_i = 0; component_i < 3; component_i++) {
+			state.components[component_i] = reader.read(bits);
+		}
+		if (state.bone_class == BONE_CLASS_ROOT) {
+			for (int32_t axis_i = 0; axis_i < 3; axis_i++) {
+				state.position[axis_i] = reader.read(position_bits);
+			}
+		}
+	}
+	if (reader.overflowed) {
+		bones.clear();
+		data.clear();
+		ERR_FAIL_V_MSG(ERR_INVALID_DATA, "Truncated pose snapshot.");
+	}
+	delta = is_delta_data;
+	data = p_data;
+	return OK;
+}
+
+void IKPoseSnapshot3D::apply(Skeleton3D *p_skeleton) const {
+	ERR_FAIL_NULL(p_skeleton);
+	for (uint32_t bone_i = 0; bone_i < bones.size(); bone_i++) {
+		const BoneState &state = bones[bone_i];
+		ERR_CONTINUE(state.bone >= p_skeleton->get_bone_count());
+		p_skeleton->set_bone_pose_rotation(state.bone, _dequantize_rotation(state));
+		if (state.bone_class == BONE_CLASS_ROOT) {
+			p_skeleton->set_bone_pose_position(state.bone, get_bone_position(bone_i));
+		}
+	}
+}
+
+PackedByteArray IKPoseSnapshot3D::get_data() const {
+	return data;
+}
+
+bool IKPoseSnapshot3D::is_delta() const {
+	return delta;
+}
+
+int32_t IKPoseSnapshot3D::get_bone_count() const {
+	return bones.size();
+}
+
+int32_t IKPoseSnapshot3D::get_bone_index(int32_t p_index) const {
+	ERR_FAIL_INDEX_V(p_index, int32_t(bones.size()), -1);
+	return bones[p_index].bone;
+}
+
+Quaternion IKPoseSnapshot3D::get_bone_rotation(int32_t p_index) const {
+	ERR_FAIL_INDEX_V(p_index, int32_t(bones.size()), Quaternion());
+	return _dequantize_rotation(bones[p_index]);
+}
+
+Vector3 IKPoseSnapshot3D::get_bone_position(int32_t p_index) const {
+	ERR_FAIL_INDEX_V(p_index, int32_t(bones.size()), Vector3());
+	const BoneState &state = bones[p_index];
+	if (state.bone_class != BONE_CLASS_ROOT) {
+		return Vector3();
+	}
+	const double max_code = double((uint64_t(1) << position_bits) - 1);
+	Vector3 position;
+	for (int32_t axis_i = 0; axis_i < 3; axis_i++) {
+		position[axis_i] = (state.position[axis_i] / max_code * 2.0 - 1.0) * position_range;
+	}
+	return position;
+}
+
+bool IKPoseSnapshot3D::is_bone_root(int32_t p_index) const {
+	ERR_FAIL_INDEX_V(p_index, int32_t(bones.size()), false);
+	return bones[p_index].bone_class == BONE_CLASS_ROOT;
+}
+
+double IKPoseSnapshot3D::get_rotation_error_bound(int32_t p_bits) {
+	ERR_FAIL_COND_V(p_bits < 1, Math::PI);
+	// Each component is off by at most half a step. The dropped component is
+	// at least 1/2, so rebuilding it at most doubles the chord between the
+	// quaternions, and a chord c is a rotation of 4 * asin(c / 2).
+	const double half_step = SMALLEST_THREE_RANGE / double((1 << p_bits) - 1);
+	const double chord = 2.0 * Math::sqrt(3.0) * half_step;
+	return 4.0 * Math::asin(MIN(1.0, chord * 0.5));
+}
+
+void IKPoseSnapshot3D::set_root_rotation_bits(int32_t p_bits) {
+	root_rotation_bits = CLAMP(p_bits, 4, 16);
+}
+
+int32_t IKPoseSnapshot3D::get_root_rotation_bits() const {
+	return root_rotation_bits;
+}
+
+void IKPoseSnapshot3D::set_chain_rotation_bits(int32_t p_bits) {
+	chain_rotation_bits = CLAMP(p_bits, 4, 16);
+}
+
+int32_t IKPoseSnapshot3D::get_chain_rotation_bits() const {
+	return chain_rotation_bits;
+}
+
+void IKPoseSnapshot3D::set_effector_rotation_bits(int32_t p_bits) {
+	effector_rotation_bits = CLAMP(p_bits, 4, 16);
+}
+
+int32_t IKPoseSnapshot3D::get_effector_rotation_bits() const {
+	return effector_rotation_bits;
+}
+
+void IKPoseSnapshot3D::set_position_bits(int32_t p_bits) {
+	position_bits = CLAMP(p_bits, 4, 24);
+}
+
+int32_t IKPoseSnapshot3D::get_position_bits() const {
+	return position_bits;
+}
+
+void IKPoseSnapshot3D::set_position_range(float p_range) {
+	ERR_FAIL_COND(p_range <= 0.0f);
+	position_range = p_range;
+}
+
+float IKPoseSnapshot3D::get_position_range() const {
+	return position_range;
+}
+
+void IKPoseSnapshot3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_root_rotation_bits", "bits"), &IKPoseSnapshot3D::set_root_rotation_bits);
+	ClassDB::bind_method(D_METHOD("get_root_rotation_bits"), &IKPoseSnapshot3D::get_root_rotation_bits);
+	ClassDB::bind_method(D_METHOD("set_chain_rotation_bits", "bits"), &IKPoseSnapshot3D::set_chain_rotation_bits);
+	ClassDB::bind_method(D_METHOD("get_chain_rotation_bits"), &IKPoseSnapshot3D::get_chain_rotation_bits);
+	ClassDB::bind_method(D_METHOD("set_effector_rotation_bits", "bits"), &IKPoseSnapshot3D::set_effector_rotation_bits);
+	ClassDB::bind_method(D_METHOD("get_effector_rotation_bits"), &IKPoseSnapshot3D::get_effector_rotation_bits);
+	ClassDB::bind_method(D_METHOD("set_position_bits", "bits"), &IKPoseSnapshot3D::set_position_bits);
+	ClassDB::bind_method(D_METHOD("get_position_bits"), &IKPoseSnapshot3D::get_position_bits);
+	ClassDB::bind_method(D_METHOD("set_position_range", "range"), &IKPoseSnapshot3D::set_position_range);
+	ClassDB::bind_method(D_METHOD("get_position_range"), &IKPoseSnapshot3D::get_position_range);
+	ClassDB::bind_method(D_METHOD("capture", "ik", "baseline"), &IKPoseSnapshot3D::capture, DEFVAL(Ref<IKPoseSnapshot3D>()));
+	ClassDB::bind_method(D_METHOD("decode", "data", "baseline"), &IKPoseSnapshot3D::decode, DEFVAL(Ref<IKPoseSnapshot3D>()));
+	ClassDB::bind_method(D_METHOD("apply", "skeleton"), &IKPoseSnapshot3D::apply);
+	ClassDB::bind_method(D_METHOD("get_data"), &IKPoseSnapshot3D::get_data);
+	ClassDB::bind_method(D_METHOD("is_delta"), &IKPoseSnapshot3D::is_delta);
+	ClassDB::bind_method(D_METHOD("get_bone_count"), &IKPoseSnapshot3D::get_bone_count);
+	ClassDB::bind_method(D_METHOD("get_bone_index", "index"), &IKPoseSnapshot3D::get_bone_index);
+	ClassDB::bind_method(D_METHOD("get_bone_rotation", "index"), &IKPoseSnapshot3D::get_bone_rotation);
+	ClassDB::bind_method(D_METHOD("get_bone_position", "index"), &IKPoseSnapshot3D::get_bone_position);
+	ClassDB::bind_method(D_METHOD("is_bone_root", "index"), &IKPoseSnapshot3D::is_bone_root);
+	ClassDB::bind_static_method("IKPoseSnapshot3D", D_METHOD("get_rotation_error_bound", "bits"), &IKPoseSnapshot3D::get_rotation_error_bound);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "root_rotation_bits", PROPERTY_HINT_RANGE, "4,16,1"), "set_root_rotation_bits", "get_root_rotation_bits");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "chain_rotation_bits", PROPERTY_HINT_RANGE, "4,16,1"), "set_chain_rotation_bits", "get_chain_rotation_bits");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "effector_rotation_bits", PROPERTY_HINT_RANGE, "4,16,1"), "set_effector_rotation_bits", "get_effector_rotation_bits");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "position_bits", PROPERTY_HINT_RANGE, "4,24,1"), "set_position_bits", "get_position_bits");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "position_range", PROPERTY_HINT_RANGE, "0.01,1000,0.01,or_greater,suffix:m"), "set_position_range", "get_position_range");
+}
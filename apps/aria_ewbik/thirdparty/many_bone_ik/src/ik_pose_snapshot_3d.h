@@ -0,0 +1,111 @@
+/**************************************************************************/
+/*  ik_pose_snapshot_3d.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/quaternion.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+
+class EWBIK3D;
+class Skeleton3D;
+
+// A compact copy of the solved pose for network replication. Rotations are
+// stored smallest-three: the largest quaternion component is dropped and the
+// other three are quantized with the bit budget of the bone's class. Root
+// bones, the solved bones with no solved parent, also carry a quantized
+// position; the roots of nested segments do not. A snapshot can be encoded as
+// a delta against an earlier one, in which case unchanged bones cost a single bit.
+class IKPoseSnapshot3D : public RefCounted {
+	GDCLASS(IKPoseSnapshot3D, RefCounted);
+
+	enum BoneClass {
+		BONE_CLASS_ROOT,
+		BONE_CLASS_CHAIN,
+		BONE_CLASS_EFFECTOR,
+	};
+
+	struct BoneState {
+		int32_t bone = -1;
+		uint8_t bone_class = BONE_CLASS_CHAIN;
+		uint8_t largest = 3;
+		uint16_t components[3] = {};
+		uint32_t position[3] = {};
+
+		bool operator==(const BoneState &p_other) const;
+	};
+
+	static constexpr uint8_t FORMAT_VERSION = 1;
+
+	int32_t root_rotation_bits = 14;
+	int32_t chain_rotation_bits = 10;
+	int32_t effector_rotation_bits = 12;
+	int32_t position_bits = 16;
+	float position_range = 8.0f;
+
+	LocalVector<BoneState> bones;
+	PackedByteArray data;
+	bool delta = false;
+
+	int32_t _get_class_bits(uint8_t p_bone_class) const;
+	bool _is_compatible_baseline(const IKPoseSnapshot3D *p_baseline) const;
+	void _quantize_rotation(const Quaternion &p_rotation, BoneState &r_state) const;
+	Quaternion _dequantize_rotation(const BoneState &p_state) const;
+	void _encode(const IKPoseSnapshot3D *p_baseline);
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_root_rotation_bits(int32_t p_bits);
+	int32_t get_root_rotation_bits() const;
+	void set_chain_rotation_bits(int32_t p_bits);
+	int32_t get_chain_rotation_bits() const;
+	void set_effector_rotation_bits(int32_t p_bits);
+	int32_t get_effector_rotation_bits() const;
+	void set_position_bits(int32_t p_bits);
+	int32_t get_position_bits() const;
+	void set_position_range(float p_range);
+	float get_position_range() const;
+
+	Error capture(EWBIK3D *p_ik, const Ref<IKPoseSnapshot3D> &p_baseline = Ref<IKPoseSnapshot3D>());
+	Error decode(const PackedByteArray &p_data, const Ref<IKPoseSnapshot3D> &p_baseline = Ref<IKPoseSnapshot3D>());
+	void apply(Skeleton3D *p_skeleton) const;
+
+	PackedByteArray get_data() const;
+	bool is_delta() const;
+	int32_t get_bone_count() const;
+	int32_t get_bone_index(int32_t p_index) const;
+	Quaternion get_bone_rotation(int32_t p_index) const;
+	Vector3 get_bone_position(int32_t p_index) const;
+	bool is_bone_root(int32_t p_index) const;
+
+	static double get_rotation_error_bound(int32_t p_bits);
+};
@@ -0,0 +1,328 @@
+/**************************************************************************/
+/*  ik_reachability_volume_3d.cpp                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_reachability_volume_3d.h"
+
+#include "core/math/random_pcg.h"
+#include "core/object/worker_thread_pool.h"
+#include "ik_kusudama_3d.h"
+#include "math/ik_deterministic_math.h"
+
+void IKReachabilityVolume3D::clear() {
+	volumes.clear();
+	volume_indices.clear();
+	emit_changed();
+}
+
+Basis IKReachabilityVolume3D::_sample_link_basis(const Link &p_link, RandomPCG &r_rng) {
+	const real_t u1 = r_rng.randd();
+	const real_t u2 = r_rng.randd();
+	const real_t u3 = r_rng.randd();
+	if (p_link.constraint.is_null() || !p_link.constraint->is_enabled()) {
+		// Shoemake's uniform rotation; an unconstrained joint may face anywhere.
+		const real_t a = Math::sqrt(1.0 - u1);
+		const real_t b = Math::sqrt(u1);
+		Quaternion rotation(a * IKMath::sin(Math::TAU * u2), a * IKMath::cos(Math::TAU * u2), b * IKMath::sin(Math::TAU * u3), b * IKMath::cos(Math::TAU * u3));
+		return Basis(rotation.normalized());
+	}
+
+	// Sample the swing as a direction in the limiting axes, then pull it back into the open cones.
+	const real_t z = 2.0 * u1 - 1.0;
+	const real_t r = Math::sqrt(MAX(0.0, 1.0 - z * z));
+	Vector3 direction = Vector3(r * IKMath::cos(Math::TAU * u2), z, r * IKMath::sin(Math::TAU * u2));
+	if (p_link.constraint->is_orientationally_constrained() && p_link.constraint->get_open_cones().size()) {
+		Vector<double> in_bounds;
+		in_bounds.resize(2);
+		in_bounds.write[0] = 1.0;
+		in_bounds.write[1] = 0.0;
+		direction = p_link.constraint->get_local_point_in_limits(direction, &in_bounds).normalized();
+	}
+	real_t twist = Math::TAU * u3;
+	if (p_link.constraint->is_axially_constrained()) {
+		twist = p_link.constraint->get_min_axial_angle() + u3 * p_link.constraint->get_range_angle();
+	}
+	Quaternion swing = Quaternion(Vector3(0, 1, 0), direction);
+	Quaternion rotation = swing * IKMath::axis_angle(Vector3(0, 1, 0), twist);
+	// Map the constrained bone direction back into the link's parent space.
+	return p_link.constraint_frame.basis * Basis(rotation) * p_link.bone_direction.inverse();
+}
+
+void IKReachabilityVolume3D::_bake_batch(uint32_t p_batch, BakeJob *p_job) {
+	RandomPCG rng(p_job->seed + p_batch, RandomPCG::DEFAULT_INC + p_batch * 2);
+	const Vector<Link> &links = *p_job->links;
+	LocalVector<int32_t> &hits = p_job->hits[p_batch];
+	for (uint32_t sample_i = 0; sample_i < hits.size(); sample_i++) {
+		Transform3D global;
+		for (int32_t link_i = 0; link_i < links.size(); link_i++) {
+			Transform3D local = links[link_i].rest;
+			local.basis = _sample_link_basis(links[link_i], rng);
+			global = global * local;
+		}
+		hits[sample_i] = _get_cell(*p_job->volume, global.origin);
+	}
+}
+
+int32_t IKReachabilityVolume3D::bake_effector(const StringName &p_bone, const Vector<Link> &p_links, int32_t p_resolution, int32_t p_samples, uint64_t p_seed) {
+	ERR_FAIL_COND_V(p_links.is_empty(), -1);
+	ERR_FAIL_COND_V(p_resolution < 2 || p_resolution > 256, -1);
+	ERR_FAIL_COND_V(p_samples < BAKE_BATCH_COUNT, -1);
+
+	EffectorVolume volume;
+	volume.bone = p_bone;
+	volume.resolution = p_resolution;
+	real_t reach = 0.0;
+	for (int32_t link_i = 1; link_i < p_links.size(); link_i++) {
+		reach += p_links[link_i].rest.origin.length();
+	}
+	reach = MAX(reach, real_t(CMP_EPSILON));
+	const Vector3 center = p_links[0].rest.origin;
+	volume.bounds = AABB(center - Vector3(reach, reach, reach), Vector3(reach, reach, reach) * 2.0);
+	volume.cell_size = volume.bounds.size / p_resolution;
+
+	BakeJob job;
+	job.links = &p_links;
+	job.volume = &volume;
+	job.seed = p_seed;
+	job.hits.resize(BAKE_BATCH_COUNT);
+	// The first p_samples % BAKE_BATCH_COUNT batches take one extra sample each.
+	for (int32_t batch_i = 0; batch_i < BAKE_BATCH_COUNT; batch_i++) {
+		job.hits[batch_i].resize(p_samples / BAKE_BATCH_COUNT + (batch_i < p_samples % BAKE_BATCH_COUNT ? 1 : 0));
+	}
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &IKReachabilityVolume3D::_bake_batch, &job, BAKE_BATCH_COUNT, -1, true, SNAME("IKReachabilityVolume3DBake"));
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+	// Batches are merged in index order, so the result never depends on thread scheduling.
+	const int32_t cell_count = p_resolution * p_resolution * p_resolution;
+	LocalVector<uint32_t> counts;
+	counts.resize(cell_count);
+	memset(counts.ptr(), 0, sizeof(uint32_t) * cell_count);
+	uint32_t max_count = 0;
+	for (const LocalVector<int32_t> &hits : job.hits) {
+		for (int32_t cell : hits) {
+			if (cell < 0) {
+				continue;
+			}
+			counts[cell]++;
+			max_count = MAX(max_count, counts[cell]);
+		}
+	}
+	volume.quality.resize(cell_count);
+	uint8_t *quality_w = volume.quality.ptrw();
+	for (int32_t cell_i = 0; cell_i < cell_count; cell_i++) {
+		quality_w[cell_i] = counts[cell_i] ? uint8_t(1 + (254 * uint64_t(counts[cell_i])) / max_count) : 0;
+	}
+	_build_nearest(volume);
+
+	int32_t index = find_effector(p_bone);
+	if (index == -1) {
+		index = volumes.size();
+		volumes.push_back(volume);
+	} else {
+		volumes.write[index] = volume;
+	}
+	_rebuild_indices();
+	emit_changed();
+	return index;
+}
+
+void IKReachabilityVolume3D::_build_nearest(EffectorVolume &r_volume) {
+	// Multi-source breadth-first flood from every reachable cell. Seeds are queued in
+	// cell order, which keeps the approximate nearest assignment deterministic.
+	const int32_t res = r_volume.resolution;
+	const int32_t cell_count = res * res * res;
+	r_volume.nearest.resize(cell_count);
+	int32_t *nearest_w = r_volume.nearest.ptrw();
+	const uint8_t *quality_r = r_volume.quality.ptr();
+	LocalVector<int32_t> queue;
+	queue.reserve(cell_count);
+	for (int32_t cell_i = 0; cell_i < cell_count; cell_i++) {
+		nearest_w[cell_i] = quality_r[cell_i] ? cell_i : -1;
+		if (quality_r[cell_i]) {
+			queue.push_back(cell_i);
+		}
+	}
+	const int32_t offsets[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (uint32_t head = 0; head < queue.size(); head++) {
+		const int32_t cell = queue[head];
+		const int32_t x = cell % res;
+		const int32_t y = (cell / res) % res;
+		const int32_t z = cell / (res * res);
+		for (const int32_t *offset : offsets) {
+			const int32_t nx = x + offset[0], ny = y + offset[1], nz = z + offset[2];
+			if (nx < 0 || ny < 0 || nz < 0 || nx >= res || ny >= res || nz >= res) {
+				continue;
+			}
+			const int32_t neighbor = nx + ny * res + nz * res * res;
+			if (nearest_w[neighbor] != -1) {
+				continue;
+			}
+			nearest_w[neighbor] = nearest_w[cell];
+			queue.push_back(neighbor);
+		}
+	}
+}
+
+int32_t IKReachabilityVolume3D::_get_cell(const EffectorVolume &p_volume, const Vector3 &p_point) const {
+	const Vector3 local = (p_point - p_volume.bounds.position) / p_volume.cell_size;
+	const int32_t x = Math::floor(local.x), y = Math::floor(local.y), z = Math::floor(local.z);
+	const int32_t res = p_volume.resolution;
+	if (x < 0 || y < 0 || z < 0 || x >= res || y >= res || z >= res) {
+		return -1;
+	}
+	return x + y * res + z * res * res;
+}
+
+Vector3 IKReachabilityVolume3D::_get_cell_center(const EffectorVolume &p_volume, int32_t p_cell) const {
+	const int32_t res = p_volume.resolution;
+	const Vector3 cell(p_cell % res, (p_cell / res) % res, p_cell / (res * res));
+	return p_volume.bounds.position + (cell + Vector3(0.5, 0.5, 0.5)) * p_volume.cell_size;
+}
+
+int32_t IKReachabilityVolume3D::get_effector_count() const {
+	return volumes.size();
+}
+
+int32_t IKReachabilityVolume3D::find_effector(const StringName &p_bone) const {
+	const int32_t *index = volume_indices.getptr(p_bone);
+	return index ? *index : -1;
+}
+
+StringName IKReachabilityVolume3D::get_effector_bone(int32_t p_effector) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), StringName());
+	return volumes[p_effector].bone;
+}
+
+AABB IKReachabilityVolume3D::get_effector_bounds(int32_t p_effector) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), AABB());
+	return volumes[p_effector].bounds;
+}
+
+int32_t IKReachabilityVolume3D::get_effector_resolution(int32_t p_effector) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), 0);
+	return volumes[p_effector].resolution;
+}
+
+PackedByteArray IKReachabilityVolume3D::get_effector_quality(int32_t p_effector) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), PackedByteArray());
+	return volumes[p_effector].quality;
+}
+
+float IKReachabilityVolume3D::get_reachability(int32_t p_effector, const Vector3 &p_local_point) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), 0.0f);
+	const EffectorVolume &volume = volumes[p_effector];
+	const int32_t cell = _get_cell(volume, p_local_point);
+	if (cell == -1) {
+		return 0.0f;
+	}
+	return volume.quality[cell] / 255.0f;
+}
+
+bool IKReachabilityVolume3D::is_reachable(int32_t p_effector, const Vector3 &p_local_point) const {
+	return get_reachability(p_effector, p_local_point) > 0.0f;
+}
+
+Vector3 IKReachabilityVolume3D::get_nearest_reachable(int32_t p_effector, const Vector3 &p_local_point) const {
+	ERR_FAIL_INDEX_V(p_effector, volumes.size(), p_local_point);
+	const EffectorVolume &volume = volumes[p_effector];
+	if (volume.nearest.is_empty()) {
+		return p_local_point;
+	}
+	const Vector3 half_cell = volume.cell_size * 0.5;
+	const Vector3 clamped = p_local_point.clamp(volume.bounds.position + half_cell, volume.bounds.get_end() - half_cell);
+	const int32_t cell = _get_cell(volume, clamped);
+	ERR_FAIL_COND_V(cell == -1, p_local_point);
+	const int32_t nearest = volume.nearest[cell];
+	if (nearest == -1) {
+		return p_local_point;
+	}
+	if (nearest == cell && clamped == p_local_point) {
+		return p_local_point;
+	}
+	return _get_cell_center(volume, nearest);
+}
+
+void IKReachabilityVolume3D::_rebuild_indices() {
+	volume_indices.clear();
+	for (int32_t volume_i = 0; volume_i < volumes.size(); volume_i++) {
+		volume_indices[volumes[volume_i].bone] = volume_i;
+	}
+}
+
+void IKReachabilityVolume3D::_set_data(const Dictionary &p_data) {
+	volumes.clear();
+	Array effectors = p_data.get("effectors", Array());
+	for (int32_t effector_i = 0; effector_i < effectors.size(); effector_i++) {
+		Dictionary effector = effectors[effector_i];
+		EffectorVolume volume;
+		volume.bone = effector.get("bone", StringName());
+		volume.bounds = effector.get("bounds", AABB());
+		volume.resolution = effector.get("resolution", 0);
+		volume.quality = effector.get("quality", PackedByteArray());
+		const int32_t cell_count = volume.resolution * volume.resolution * volume.resolution;
+		ERR_CONTINUE(volume.resolution < 2 || volume.quality.size() != cell_count);
+		volume.cell_size = volume.bounds.size / volume.resolution;
+		_build_nearest(volume);
+		volumes.push_back(volume);
+	}
+	_rebuild_indices();
+	emit_changed();
+}
+
+Dictionary IKReachabilityVolume3D::_get_data() const {
+	Array effectors;
+	for (const EffectorVolume &volume : volumes) {
+		Dictionary effector;
+		effector["bone"] = volume.bone;
+		effector["bounds"] = volume.bounds;
+		effector["resolution"] = volume.resolution;
+		effector["quality"] = volume.quality;
+		effectors.push_back(effector);
+	}
+	Dictionary data;
+	data["effectors"] = effectors;
+	return data;
+}
+
+void IKReachabilityVolume3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_set_data", "data"), &IKReachabilityVolume3D::_set_data);
+	ClassDB::bind_method(D_METHOD("_get_data"), &IKReachabilityVolume3D::_get_data);
+	ClassDB::bind_method(D_METHOD("clear"), &IKReachabilityVolume3D::clear);
+	ClassDB::bind_method(D_METHOD("get_effector_count"), &IKReachabilityVolume3D::get_effector_count);
+	ClassDB::bind_method(D_METHOD("find_effector", "bone"), &IKReachabilityVolume3D::find_effector);
+	ClassDB::bind_method(D_METHOD("get_effector_bone", "effector"), &IKReachabilityVolume3D::get_effector_bone);
+	ClassDB::bind_method(D_METHOD("get_effector_bounds", "effector"), &IKReachabilityVolume3D::get_effector_bounds);
+	ClassDB::bind_method(D_METHOD("get_effector_resolution", "effector"), &IKReachabilityVolume3D::get_effector_resolution);
+	ClassDB::bind_method(D_METHOD("get_effector_quality", "effector"), &IKReachabilityVolume3D::get_effector_quality);
+	ClassDB::bind_method(D_METHOD("get_reachability", "effector", "local_point"), &IKReachabilityVolume3D::get_reachability);
+	ClassDB::bind_method(D_METHOD("is_reachable", "effector", "local_point"), &IKReachabilityVolume3D::is_reachable);
+	ClassDB::bind_method(D_METHOD("get_nearest_reachable", "effector", "local_point"), &IKReachabilityVolume3D::get_nearest_reachable);
+
+	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "_data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR | PROPERTY_USAGE_INTERNAL), "_set_data", "_get_data");
+}
@@ -0,0 +1,104 @@
+/**************************************************************************/
+/*  ik_reachability_volume_3d.h                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/resource.h"
+#include "core/math/aabb.h"
+#include "core/math/transform_3d.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+
+class IKKusudama3D;
+class RandomPCG;
+
+// Baked, per-effector occupancy of the positions an effector can reach relative
+// to the parent frame of its segment root. Cells hold a quality byte (0 means
+// unreachable) and the index of the nearest reachable cell, so feasibility and
+// clamping are both a single lookup at solve time.
+class IKReachabilityVolume3D : public Resource {
+	GDCLASS(IKReachabilityVolume3D, Resource);
+
+public:
+	struct Link {
+		Transform3D rest; // Relative to the previous link (or the volume frame for the first link).
+		Transform3D constraint_frame; // Kusudama limiting axes, relative to the previous link.
+		Basis bone_direction; // Bone direction basis, relative to this link.
+		Ref<IKKusudama3D> constraint;
+	};
+
+private:
+	struct EffectorVolume {
+		StringName bone;
+		AABB bounds;
+		int32_t resolution = 0;
+		Vector3 cell_size;
+		PackedByteArray quality;
+		PackedInt32Array nearest;
+	};
+
+	struct BakeJob {
+		const Vector<Link> *links = nullptr;
+		const EffectorVolume *volume = nullptr;
+		uint64_t seed = 0;
+		// One cell per sample, sized to each batch's share of the samples.
+		LocalVector<LocalVector<int32_t>> hits;
+	};
+
+	Vector<EffectorVolume> volumes;
+	HashMap<StringName, int32_t> volume_indices;
+
+	void _bake_batch(uint32_t p_batch, BakeJob *p_job);
+	static Basis _sample_link_basis(const Link &p_link, RandomPCG &r_rng);
+	static void _build_nearest(EffectorVolume &r_volume);
+	int32_t _get_cell(const EffectorVolume &p_volume, const Vector3 &p_point) const;
+	Vector3 _get_cell_center(const EffectorVolume &p_volume, int32_t p_cell) const;
+	void _rebuild_indices();
+
+protected:
+	static void _bind_methods();
+	void _set_data(const Dictionary &p_data);
+	Dictionary _get_data() const;
+
+public:
+	static constexpr int32_t BAKE_BATCH_COUNT = 64;
+
+	void clear();
+	int32_t bake_effector(const StringName &p_bone, const Vector<Link> &p_links, int32_t p_resolution, int32_t p_samples, uint64_t p_seed = 0);
+	int32_t get_effector_count() const;
+	int32_t find_effector(const StringName &p_bone) const;
+	StringName get_effector_bone(int32_t p_effector) const;
+	AABB get_effector_bounds(int32_t p_effector) const;
+	int32_t get_effector_resolution(int32_t p_effector) const;
+	PackedByteArray get_effector_quality(int32_t p_effector) const;
+	float get_reachability(int32_t p_effector, const Vector3 &p_local_point) const;
+	bool is_reachable(int32_t p_effector, const Vector3 &p_local_point) const;
+	Vector3 get_nearest_reachable(int32_t p_effector, const Vector3 &p_local_point) const;
+};
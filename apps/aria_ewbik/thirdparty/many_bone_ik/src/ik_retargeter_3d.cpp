@@ -0,0 +1,426 @@
+/**************************************************************************/
+/*  ik_retargeter_3d.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_retargeter_3d.h"
+
+#include "core/object/worker_thread_pool.h"
+#include "ik_animation_baker_3d.h"
+#include "ik_effector_animation_3d.h"
+#include "many_bone_ik_3d.h"
+#include "math/qcp.h"
+#include "scene/3d/skeleton_3d.h"
+
+void IKRetargeter3D::_snapshot(Skeleton3D *p_skeleton, LocalVector<BoneRest> &r_bones, LocalVector<int32_t> &r_order) {
+	const int32_t bone_count = p_skeleton->get_bone_count();
+	r_bones.resize(bone_count);
+	r_order.clear();
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		r_bones[bone_i].name = p_skeleton->get_bone_name(bone_i);
+		r_bones[bone_i].parent = p_skeleton->get_bone_parent(bone_i);
+		r_bones[bone_i].rest = p_skeleton->get_bone_rest(bone_i);
+	}
+	// Parents before children, so global transforms can be built in a single pass.
+	LocalVector<int32_t> stack;
+	for (int32_t root : p_skeleton->get_parentless_bones()) {
+		stack.push_back(root);
+	}
+	while (!stack.is_empty()) {
+		const int32_t bone = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+		r_order.push_back(bone);
+		const int32_t parent = r_bones[bone].parent;
+		r_bones[bone].global_rest = parent == -1 ? r_bones[bone].rest : r_bones[parent].global_rest * r_bones[bone].rest;
+		Vector<int32_t> children = p_skeleton->get_bone_children(bone);
+		for (int32_t child_i = children.size(); child_i-- > 0;) {
+			stack.push_back(children[child_i]);
+		}
+	}
+}
+
+Quaternion IKRetargeter3D::_solve_alignment(int32_t p_target_bone) const {
+	const int32_t source_bone = target_to_source[p_target_bone];
+	const Vector3 source_origin = source_bones[source_bone].global_rest.origin;
+	const Vector3 target_origin = target_bones[p_target_bone].global_rest.origin;
+	PackedVector3Array moved, target;
+	Vector<double> weights;
+	const auto add_pair = [&](const Vector3 &p_source_direction, const Vector3 &p_target_direction, double p_weight) {
+		if (p_source_direction.is_zero_approx() || p_target_direction.is_zero_approx()) {
+			return;
+		}
+		moved.push_back(p_source_direction.normalized());
+		target.push_back(p_target_direction.normalized());
+		weights.push_back(p_weight);
+	};
+	// Directions are normalized so differing bone lengths do not bias the fit.
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		if (target_bones[bone_i].parent != p_target_bone || target_to_source[bone_i] == -1) {
+			continue;
+		}
+		add_pair(source_bones[target_to_source[bone_i]].global_rest.origin - source_origin, target_bones[bone_i].global_rest.origin - target_origin, 1.0);
+	}
+	const int32_t parent = target_bones[p_target_bone].parent;
+	if (moved.is_empty() && parent != -1 && target_to_source[parent] != -1) {
+		// Leaf bones fall back to the direction back toward their parent.
+		add_pair(source_bones[target_to_source[parent]].global_rest.origin - source_origin, target_bones[parent].global_rest.origin - target_origin, 1.0);
+	}
+	const int32_t direction_count = moved.size();
+	if (direction_count < 2) {
+		// A single direction leaves the twist free; the rest frames settle it.
+		const Basis source_basis = source_bones[source_bone].global_rest.basis.orthonormalized();
+		const Basis target_basis = target_bones[p_target_bone].global_rest.basis.orthonormalized();
+		const double axis_weight = direction_count ? 0.1 : 1.0;
+		for (int32_t axis = 0; axis < 3; axis++) {
+			add_pair(source_basis.get_column(axis), target_basis.get_column(axis), axis_weight);
+		}
+	}
+	Array result = QuaternionCharacteristicPolynomial::weighted_superpose(moved, target, weights, false);
+	ERR_FAIL_COND_V(result.is_empty(), Quaternion());
+	Quaternion alignment = Quaternion(result[0]).normalized();
+	if (direction_count == 1) {
+		// Keep the twist from the fit but make the only bone direction match exactly.
+		alignment = (Quaternion(alignment.xform(moved[0]), target[0]) * alignment).normalized();
+	}
+	return alignment;
+}
+
+Error IKRetargeter3D::setup(Skeleton3D *p_source, Skeleton3D *p_target, const Dictionary &p_bone_map) {
+	ERR_FAIL_NULL_V(p_source, ERR_INVALID_PARAMETER);
+	ERR_FAIL_NULL_V(p_target, ERR_INVALID_PARAMETER);
+	_snapshot(p_source, source_bones, source_order);
+	_snapshot(p_target, target_bones, target_order);
+	target_track_path = NodePath(String(p_target->get_name()));
+	source_indices.clear();
+	for (uint32_t bone_i = 0; bone_i < source_bones.size(); bone_i++) {
+		source_indices[source_bones[bone_i].name] = bone_i;
+	}
+
+	target_to_source.resize(target_bones.size());
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		target_to_source[bone_i] = -1;
+	}
+	int32_t mapped = 0;
+	for (const KeyValue<Variant, Variant> &pair : p_bone_map) {
+		const int32_t source_bone = p_source->find_bone(pair.key);
+		const int32_t target_bone = p_target->find_bone(pair.value);
+		ERR_CONTINUE_MSG(source_bone == -1 || target_bone == -1, vformat("Bone map entry %s -> %s does not match both skeletons.", pair.key, pair.value));
+		target_to_source[target_bone] = source_bone;
+		mapped++;
+	}
+	ERR_FAIL_COND_V_MSG(mapped == 0, ERR_INVALID_PARAMETER, "The bone map has no entries shared by both skeletons.");
+
+	target_alignment.resize(target_bones.size());
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		if (target_to_source[bone_i] == -1) {
+			continue;
+		}
+		const Quaternion alignment = _solve_alignment(bone_i);
+		target_alignment[bone_i] = (alignment.inverse() * target_bones[bone_i].global_rest.basis.get_rotation_quaternion()).normalized();
+	}
+
+	// Overall proportion from the lengths of the mapped bone links.
+	real_t source_length = 0.0, target_length = 0.0;
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		const int32_t parent = target_bones[bone_i].parent;
+		if (parent == -1 || target_to_source[bone_i] == -1 || target_to_source[parent] == -1) {
+			continue;
+		}
+		target_length += target_bones[bone_i].global_rest.origin.distance_to(target_bones[parent].global_rest.origin);
+		source_length += source_bones[target_to_source[bone_i]].global_rest.origin.distance_to(source_bones[target_to_source[parent]].global_rest.origin);
+	}
+	scale = source_length > CMP_EPSILON ? target_length / source_length : 1.0;
+	return OK;
+}
+
+bool IKRetargeter3D::is_setup() const {
+	return !target_alignment.is_empty();
+}
+
+Quaternion IKRetargeter3D::get_bone_alignment(const StringName &p_target_bone) const {
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		if (target_bones[bone_i].name != p_target_bone) {
+			continue;
+		}
+		ERR_FAIL_COND_V(target_to_source[bone_i] == -1, Quaternion());
+		return target_bones[bone_i].global_rest.basis.get_rotation_quaternion() * target_alignment[bone_i].inverse();
+	}
+	ERR_FAIL_V_MSG(Quaternion(), vformat("Bone %s is not in the target skeleton.", p_target_bone));
+}
+
+void IKRetargeter3D::_evaluate_source(const Ref<Animation> &p_animation, const LocalVector<int32_t> &p_track_bones, double p_time, SourcePose &r_pose) const {
+	LocalVector<Vector3> &positions = r_pose.positions;
+	LocalVector<Quaternion> &rotations = r_pose.rotations;
+	LocalVector<Vector3> &scales = r_pose.scales;
+	LocalVector<Transform3D> &global = r_pose.global;
+	positions.resize(source_bones.size());
+	rotations.resize(source_bones.size());
+	scales.resize(source_bones.size());
+	for (uint32_t bone_i = 0; bone_i < source_bones.size(); bone_i++) {
+		positions[bone_i] = source_bones[bone_i].rest.origin;
+		rotations[bone_i] = source_bones[bone_i].rest.basis.get_rotation_quaternion();
+		scales[bone_i] = source_bones[bone_i].rest.basis.get_scale();
+	}
+	for (uint32_t track_i = 0; track_i < p_track_bones.size(); track_i++) {
+		const int32_t bone = p_track_bones[track_i];
+		if (bone == -1) {
+			continue;
+		}
+		switch (p_animation->track_get_type(track_i)) {
+			case Animation::TYPE_POSITION_3D:
+				p_animation->try_position_track_interpolate(track_i, p_time, &positions[bone]);
+				break;
+			case Animation::TYPE_ROTATION_3D:
+				p_animation->try_rotation_track_interpolate(track_i, p_time, &rotations[bone]);
+				break;
+			case Animation::TYPE_SCALE_3D:
+				p_animation->try_scale_track_interpolate(track_i, p_time, &scales[bone]);
+				break;
+			default:
+				break;
+		}
+	}
+	global.resize(source_bones.size());
+	for (int32_t bone : source_order) {
+		const Transform3D local(Basis(rotations[bone]).scaled_local(scales[bone]), positions[bone]);
+		const int32_t parent = source_bones[bone].parent;
+		global[bone] = parent == -1 ? local : global[parent] * local;
+	}
+}
+
+int32_t IKRetargeter3D::_get_chain_root(int32_t p_target_bone) const {
+	int32_t bone = p_target_bone;
+	while (target_bones[bone].parent != -1 && target_to_source[target_bones[bone].parent] != -1) {
+		bone = target_bones[bone].parent;
+	}
+	return bone;
+}
+
+Ref<Animation> IKRetargeter3D::_retarget_tracks(const Ref<Animation> &p_animation) const {
+	LocalVector<int32_t> track_bones;
+	track_bones.resize(p_animation->get_track_count());
+	for (int32_t track_i = 0; track_i < p_animation->get_track_count(); track_i++) {
+		const NodePath path = p_animation->track_get_path(track_i);
+		const int32_t *bone = path.get_subname_count() ? source_indices.getptr(path.get_concatenated_subnames()) : nullptr;
+		track_bones[track_i] = bone ? *bone : -1;
+	}
+
+	Ref<Animation> result;
+	result.instantiate();
+	result->set_name(p_animation->get_name());
+	result->set_length(p_animation->get_length());
+	result->set_loop_mode(p_animation->get_loop_mode());
+	LocalVector<int32_t> rotation_tracks, position_tracks;
+	rotation_tracks.resize(target_bones.size());
+	position_tracks.resize(target_bones.size());
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		rotation_tracks[bone_i] = -1;
+		position_tracks[bone_i] = -1;
+		if (target_to_source[bone_i] == -1) {
+			continue;
+		}
+		const NodePath path = NodePath(String(target_track_path) + ":" + target_bones[bone_i].name);
+		rotation_tracks[bone_i] = result->add_track(Animation::TYPE_ROTATION_3D);
+		result->track_set_path(rotation_tracks[bone_i], path);
+		// Translation is only carried for the top of each mapped chain, such as the hips.
+		const int32_t parent = target_bones[bone_i].parent;
+		if (parent == -1 || target_to_source[parent] == -1) {
+			position_tracks[bone_i] = result->add_track(Animation::TYPE_POSITION_3D);
+			result->track_set_path(position_tracks[bone_i], path);
+		}
+	}
+
+	const int32_t frame_count = int32_t(Math::floor(p_animation->get_length() * sample_rate + CMP_EPSILON)) + 1;
+	SourcePose source_pose;
+	const LocalVector<Transform3D> &source_global = source_pose.global;
+	LocalVector<Quaternion> target_global;
+	target_global.resize(target_bones.size());
+	for (int32_t frame_i = 0; frame_i < frame_count; frame_i++) {
+		const double time = MIN(frame_i / sample_rate, p_animation->get_length());
+		_evaluate_source(p_animation, track_bones, time, source_pose);
+		for (int32_t bone : target_order) {
+			const int32_t parent = target_bones[bone].parent;
+			const Quaternion parent_global = parent == -1 ? Quaternion() : target_global[parent];
+			const int32_t source_bone = target_to_source[bone];
+			if (source_bone == -1) {
+				target_global[bone] = parent_global * target_bones[bone].rest.basis.get_rotation_quaternion();
+				continue;
+			}
+			const Quaternion source_delta = source_global[source_bone].basis.get_rotation_quaternion() * source_bones[source_bone].global_rest.basis.get_rotation_quaternion().inverse();
+			target_global[bone] = (source_delta * target_alignment[bone]).normalized();
+			result->rotation_track_insert_key(rotation_tracks[bone], time, (parent_global.inverse() * target_global[bone]).normalized());
+			if (position_tracks[bone] != -1) {
+				const int32_t source_parent = source_bones[source_bone].parent;
+				const Vector3 source_local = source_parent == -1 ? source_global[source_bone].origin : source_global[source_parent].affine_inverse().xform(source_global[source_bone].origin);
+				const Vector3 offset = (source_local - source_bones[source_bone].rest.origin) * scale;
+				result->position_track_insert_key(position_tracks[bone], time, target_bones[bone].rest.origin + offset);
+			}
+		}
+	}
+	return result;
+}
+
+Ref<Animation> IKRetargeter3D::_correct_drift(const Ref<Animation> &p_source, const Ref<Animation> &p_retargeted, EWBIK3D *p_ik) const {
+	Skeleton3D *skeleton = p_ik->get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, p_retargeted);
+	// Every mapped bone is a hint on every frame, so the solver starts from the
+	// retargeted pose and only corrects where the end effectors have drifted.
+	PackedStringArray hint_bones;
+	for (uint32_t bone_i = 0; bone_i < target_bones.size(); bone_i++) {
+		if (target_to_source[bone_i] != -1) {
+			hint_bones.push_back(target_bones[bone_i].name);
+		}
+	}
+	Ref<IKEffectorAnimation3D> effectors;
+	effectors.instantiate();
+	ERR_FAIL_COND_V(effectors->compress(p_retargeted, p_ik, sample_rate, hint_bones, 1.0 / sample_rate) != OK, p_retargeted);
+
+	LocalVector<int32_t> track_bones;
+	track_bones.resize(p_source->get_track_count());
+	for (int32_t track_i = 0; track_i < p_source->get_track_count(); track_i++) {
+		const NodePath path = p_source->track_get_path(track_i);
+		const int32_t *bone = path.get_subname_count() ? source_indices.getptr(path.get_concatenated_subnames()) : nullptr;
+		track_bones[track_i] = bone ? *bone : -1;
+	}
+	// Source effector positions are carried into the target skeleton the same
+	// way as the rotations: relative to the rest origin of their chain root,
+	// turned by that root's rest alignment and scaled to the target's size.
+	struct DriftTrack {
+		int32_t track = -1;
+		int32_t source_bone = -1;
+		Vector3 source_root_origin;
+		Vector3 target_root_origin;
+		Quaternion root_alignment;
+		PackedVector3Array positions;
+	};
+	LocalVector<DriftTrack> drift_tracks;
+	for (int32_t track_i = 0; track_i < effectors->get_effector_track_count(); track_i++) {
+		const int32_t target_bone = skeleton->find_bone(effectors->get_effector_track_bone(track_i));
+		if (target_bone == -1 || target_bone >= int32_t(target_to_source.size()) || target_to_source[target_bone] == -1) {
+			continue;
+		}
+		const int32_t root = _get_chain_root(target_bone);
+		DriftTrack drift;
+		drift.track = track_i;
+		drift.source_bone = target_to_source[target_bone];
+		drift.source_root_origin = source_bones[target_to_source[root]].global_rest.origin;
+		drift.target_root_origin = target_bones[root].global_rest.origin;
+		drift.root_alignment = target_bones[root].global_rest.basis.get_rotation_quaternion() * target_alignment[root].inverse();
+		drift.positions.resize(effectors->get_frame_count());
+		drift_tracks.push_back(drift);
+	}
+	SourcePose source_pose;
+	for (int32_t frame_i = 0; frame_i < effectors->get_frame_count(); frame_i++) {
+		_evaluate_source(p_source, track_bones, MIN(frame_i / sample_rate, p_source->get_length()), source_pose);
+		for (DriftTrack &drift : drift_tracks) {
+			const Vector3 offset = source_pose.global[drift.source_bone].origin - drift.source_root_origin;
+			drift.positions.write[frame_i] = drift.target_root_origin + drift.root_alignment.xform(offset * scale);
+		}
+	}
+	for (const DriftTrack &drift : drift_tracks) {
+		effectors->set_effector_track_positions(drift.track, drift.positions);
+	}
+
+	Ref<IKAnimationBaker3D> baker;
+	baker.instantiate();
+	baker->set_skeleton_track_path(target_track_path);
+	Ref<Animation> baked = baker->bake(effectors, p_ik);
+	ERR_FAIL_COND_V(baked.is_null(), p_retargeted);
+	Ref<Animation> result = p_retargeted->duplicate();
+	for (int32_t track_i = 0; track_i < baked->get_track_count(); track_i++) {
+		const int32_t existing = result->find_track(baked->track_get_path(track_i), Animation::TYPE_ROTATION_3D);
+		if (existing != -1) {
+			result->remove_track(existing);
+		}
+		baked->copy_track(track_i, result);
+	}
+	return result;
+}
+
+Ref<Animation> IKRetargeter3D::retarget(const Ref<Animation> &p_animation, EWBIK3D *p_drift_correction) const {
+	ERR_FAIL_COND_V(p_animation.is_null(), Ref<Animation>());
+	ERR_FAIL_COND_V_MSG(!is_setup(), Ref<Animation>(), "Call setup() before retargeting.");
+	Ref<Animation> result = _retarget_tracks(p_animation);
+	if (p_drift_correction) {
+		result = _correct_drift(p_animation, result, p_drift_correction);
+	}
+	return result;
+}
+
+void IKRetargeter3D::_retarget_clip(uint32_t p_index, LibraryJob *p_job) {
+	Ref<Animation> animation = (*p_job->animations)[p_index];
+	if (animation.is_valid()) {
+		p_job->results[p_index] = _retarget_tracks(animation);
+	}
+}
+
+TypedArray<Animation> IKRetargeter3D::retarget_library(const TypedArray<Animation> &p_animations, EWBIK3D *p_drift_correction) {
+	ERR_FAIL_COND_V_MSG(!is_setup(), TypedArray<Animation>(), "Call setup() before retargeting.");
+	LibraryJob job;
+	job.animations = &p_animations;
+	job.results.resize(p_animations.size());
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &IKRetargeter3D::_retarget_clip, &job, p_animations.size(), -1, true, SNAME("IKRetargeter3D"));
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+	TypedArray<Animation> results;
+	for (uint32_t clip_i = 0; clip_i < job.results.size(); clip_i++) {
+		Ref<Animation> result = job.results[clip_i];
+		// The drift pass drives scene nodes, so it runs per clip here; the baker parallelizes within the clip.
+		if (p_drift_correction && result.is_valid()) {
+			result = _correct_drift(p_animations[clip_i], result, p_drift_correction);
+		}
+		results.push_back(result);
+	}
+	return results;
+}
+
+real_t IKRetargeter3D::get_scale() const {
+	return scale;
+}
+
+void IKRetargeter3D::set_sample_rate(double p_sample_rate) {
+	ERR_FAIL_COND(p_sample_rate <= 0.0);
+	sample_rate = p_sample_rate;
+}
+
+double IKRetargeter3D::get_sample_rate() const {
+	return sample_rate;
+}
+
+void IKRetargeter3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("setup", "source", "target", "bone_map"), &IKRetargeter3D::setup);
+	ClassDB::bind_method(D_METHOD("is_setup"), &IKRetargeter3D::is_setup);
+	ClassDB::bind_method(D_METHOD("get_bone_alignment", "target_bone"), &IKRetargeter3D::get_bone_alignment);
+	ClassDB::bind_method(D_METHOD("get_scale"), &IKRetargeter3D::get_scale);
+	ClassDB::bind_method(D_METHOD("set_sample_rate", "sample_rate"), &IKRetargeter3D::set_sample_rate);
+	ClassDB::bind_method(D_METHOD("get_sample_rate"), &IKRetargeter3D::get_sample_rate);
+	ClassDB::bind_method(D_METHOD("retarget", "animation", "drift_correction"), &IKRetargeter3D::retarget, DEFVAL(Variant()));
+	ClassDB::bind_method(D_METHOD("retarget_library", "animations", "drift_correction"), &IKRetargeter3D::retarget_library, DEFVAL(Variant()));
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sample_rate", PROPERTY_HINT_RANGE, "1,240,1,or_greater"), "set_sample_rate", "get_sample_rate");
+}
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*  ik_retargeter_3d.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/ref_counted.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/typed_array.h"
+#include "scene/resources/animation.h"
+
+class EWBIK3D;
+class Skeleton3D;
+
+// Converts animations between two skeletons with different rest poses. Each
+// mapped bone gets a rest alignment from a weighted QCP superposition of the
+// directions to its mapped neighbours, so a retargeted bone points where the
+// source bone points. Setup snapshots both skeletons, after which clips are
+// converted without touching any node and can run in parallel.
+class IKRetargeter3D : public RefCounted {
+	GDCLASS(IKRetargeter3D, RefCounted);
+
+	struct BoneRest {
+		StringName name;
+		int32_t parent = -1;
+		Transform3D rest;
+		Transform3D global_rest;
+	};
+
+	// Scratch buffers for sampling the source, reused across frames.
+	struct SourcePose {
+		LocalVector<Vector3> positions;
+		LocalVector<Quaternion> rotations;
+		LocalVector<Vector3> scales;
+		LocalVector<Transform3D> global;
+	};
+
+	struct LibraryJob {
+		const TypedArray<Animation> *animations = nullptr;
+		LocalVector<Ref<Animation>> results;
+	};
+
+	LocalVector<BoneRest> source_bones;
+	LocalVector<BoneRest> target_bones;
+	LocalVector<int32_t> source_order;
+	LocalVector<int32_t> target_order;
+	LocalVector<int32_t> target_to_source;
+	// Maps the source global rotation delta onto the target: G_t = D * alignment.
+	LocalVector<Quaternion> target_alignment;
+	HashMap<StringName, int32_t> source_indices;
+	NodePath target_track_path;
+	real_t scale = 1.0;
+	double sample_rate = 30.0;
+
+	static void _snapshot(Skeleton3D *p_skeleton, LocalVector<BoneRest> &r_bones, LocalVector<int32_t> &r_order);
+	Quaternion _solve_alignment(int32_t p_target_bone) const;
+	void _evaluate_source(const Ref<Animation> &p_animation, const LocalVector<int32_t> &p_track_bones, double p_time, SourcePose &r_pose) const;
+	int32_t _get_chain_root(int32_t p_target_bone) const;
+	Ref<Animation> _retarget_tracks(const Ref<Animation> &p_animation) const;
+	void _retarget_clip(uint32_t p_index, LibraryJob *p_job);
+	Ref<Animation> _correct_drift(const Ref<Animation> &p_source, const Ref<Animation> &p_retargeted, EWBIK3D *p_ik) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error setup(Skeleton3D *p_source, Skeleton3D *p_target, const Dictionary &p_bone_map);
+	bool is_setup() const;
+	Quaternion get_bone_alignment(const StringName &p_target_bone) const;
+	real_t get_scale() const;
+	void set_sample_rate(double p_sample_rate);
+	double get_sample_rate() const;
+
+	Ref<Animation> retarget(const Ref<Animation> &p_animation, EWBIK3D *p_drift_correction = nullptr) const;
+	TypedArray<Animation> retarget_library(const TypedArray<Animation> &p_animations, EWBIK3D *p_drift_correction = nullptr);
+};
@@ -0,0 +1,277 @@
+/**************************************************************************/
+/*  ik_solve_trace_3d.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_solve_trace_3d.h"
+
+#include "core/io/marshalls.h"
+#include "core/object/class_db.h"
+
+thread_local IKSolveRecorder3D *IKSolveRecorder3D::active = nullptr;
+
+static _FORCE_INLINE_ void ik_trace_write_u32(LocalVector<uint8_t> &r_bytes, uint32_t p_value) {
+	const uint32_t offset = r_bytes.size();
+	r_bytes.resize(offset + 4);
+	encode_uint32(p_value, &r_bytes[offset]);
+}
+
+static _FORCE_INLINE_ void ik_trace_write_float(LocalVector<uint8_t> &r_bytes, float p_value) {
+	const uint32_t offset = r_bytes.size();
+	r_bytes.resize(offset + 4);
+	encode_float(p_value, &r_bytes[offset]);
+}
+
+static _FORCE_INLINE_ void ik_trace_write_quaternion(LocalVector<uint8_t> &r_bytes, const Quaternion &p_value) {
+	ik_trace_write_float(r_bytes, p_value.x);
+	ik_trace_write_float(r_bytes, p_value.y);
+	ik_trace_write_float(r_bytes, p_value.z);
+	ik_trace_write_float(r_bytes, p_value.w);
+}
+
+static _FORCE_INLINE_ Quaternion ik_trace_read_quaternion(const uint8_t *p_bytes) {
+	return Quaternion(decode_float(p_bytes), decode_float(p_bytes + 4), decode_float(p_bytes + 8), decode_float(p_bytes + 12));
+}
+
+void IKSolveRecorder3D::set_capacity(int32_t p_frames) {
+	ERR_FAIL_COND(p_frames < 0);
+	frames.resize(p_frames);
+	clear();
+}
+
+void IKSolveRecorder3D::clear() {
+	for (LocalVector<uint8_t> &frame : frames) {
+		frame.clear();
+	}
+	next_frame = 0;
+	filled_frames = 0;
+	current = nullptr;
+}
+
+void IKSolveRecorder3D::begin_frame() {
+	if (frames.is_empty()) {
+		return;
+	}
+	current = &frames[next_frame];
+	current->clear();
+	current->resize(FRAME_HEADER_SIZE);
+	encode_uint64(frame_number, current->ptr());
+	current_iteration = 0;
+	current_iteration_count = 0;
+	current_record_count = 0;
+}
+
+void IKSolveRecorder3D::set_iteration(uint32_t p_iteration) {
+	current_iteration = p_iteration;
+	current_iteration_count = MAX(current_iteration_count, p_iteration + 1);
+}
+
+void IKSolveRecorder3D::record_bone(int32_t p_bone, const PackedVector3Array &p_tip_headings, const PackedVector3Array &p_target_headings, const Vector<double> &p_weights,
+		const Quaternion &p_qcp_rotation, const Quaternion &p_pre_constraint_rotation, const Quaternion &p_post_constraint_rotation, float p_msd) {
+	if (!current) {
+		return;
+	}
+	const uint32_t heading_count = MIN(p_tip_headings.size(), MIN(p_target_headings.size(), p_weights.size()));
+	current->reserve(current->size() + RECORD_HEADER_SIZE + heading_count * HEADING_SIZE);
+	ik_trace_write_u32(*current, current_iteration);
+	ik_trace_write_u32(*current, uint32_t(p_bone));
+	ik_trace_write_u32(*current, heading_count);
+	ik_trace_write_float(*current, p_msd);
+	ik_trace_write_quaternion(*current, p_qcp_rotation);
+	ik_trace_write_quaternion(*current, p_pre_constraint_rotation);
+	ik_trace_write_quaternion(*current, p_post_constraint_rotation);
+	for (uint32_t heading_i = 0; heading_i < heading_count; heading_i++) {
+		const Vector3 &tip = p_tip_headings[heading_i];
+		const Vector3 &target = p_target_headings[heading_i];
+		ik_trace_write_float(*current, tip.x);
+		ik_trace_write_float(*current, tip.y);
+		ik_trace_write_float(*current, tip.z);
+		ik_trace_write_float(*current, target.x);
+		ik_trace_write_float(*current, target.y);
+		ik_trace_write_float(*current, target.z);
+		ik_trace_write_float(*current, p_weights[heading_i]);
+	}
+	current_record_count++;
+}
+
+void IKSolveRecorder3D::end_frame() {
+	if (!current) {
+		return;
+	}
+	uint8_t *header = current->ptr();
+	encode_uint32(current_iteration_count, header + 8);
+	encode_uint32(current_record_count, header + 12);
+	encode_uint32(current->size() - FRAME_HEADER_SIZE, header + 16);
+	current = nullptr;
+	frame_number++;
+	next_frame = (next_frame + 1) % frames.size();
+	filled_frames = MIN(filled_frames + 1, frames.size());
+}
+
+PackedByteArray IKSolveRecorder3D::serialize() const {
+	uint32_t size = 12;
+	for (const LocalVector<uint8_t> &frame : frames) {
+		size += frame.size();
+	}
+	PackedByteArray bytes;
+	bytes.resize(size);
+	uint8_t *write = bytes.ptrw();
+	write += encode_uint32(IK_SOLVE_TRACE_MAGIC, write);
+	write += encode_uint32(IK_SOLVE_TRACE_VERSION, write);
+	write += encode_uint32(filled_frames, write);
+	const uint32_t oldest = (next_frame + frames.size() - filled_frames) % MAX(frames.size(), 1u);
+	uint32_t written = 12;
+	for (uint32_t frame_i = 0; frame_i < filled_frames; frame_i++) {
+		const LocalVector<uint8_t> &frame = frames[(oldest + frame_i) % frames.size()];
+		memcpy(write, frame.ptr(), frame.size());
+		write += frame.size();
+		written += frame.size();
+	}
+	bytes.resize(written);
+	return bytes;
+}
+
+Error IKSolveTrace3D::set_data(const PackedByteArray &p_data) {
+	const uint8_t *bytes = p_data.ptr();
+	const uint32_t size = p_data.size();
+	ERR_FAIL_COND_V_MSG(size < 12 || decode_uint32(bytes) != IK_SOLVE_TRACE_MAGIC, ERR_INVALID_DATA, "Not a solve trace.");
+	ERR_FAIL_COND_V_MSG(decode_uint32(bytes + 4) != IK_SOLVE_TRACE_VERSION, ERR_INVALID_DATA, "Unsupported solve trace version.");
+	const uint32_t frame_count = decode_uint32(bytes + 8);
+	LocalVector<Frame> new_frames;
+	LocalVector<uint32_t> new_record_offsets;
+	uint32_t offset = 12;
+	for (uint32_t frame_i = 0; frame_i < frame_count; frame_i++) {
+		ERR_FAIL_COND_V_MSG(size - offset < IKSolveRecorder3D::FRAME_HEADER_SIZE, ERR_INVALID_DATA, "Truncated solve trace.");
+		Frame frame;
+		frame.number = decode_uint64(bytes + offset);
+		frame.iteration_count = decode_uint32(bytes + offset + 8);
+		frame.record_count = decode_uint32(bytes + offset + 12);
+		const uint32_t record_bytes = decode_uint32(bytes + offset + 16);
+		offset += IKSolveRecorder3D::FRAME_HEADER_SIZE;
+		ERR_FAIL_COND_V_MSG(size - offset < record_bytes, ERR_INVALID_DATA, "Truncated solve trace.");
+		const uint32_t frame_end = offset + record_bytes;
+		frame.first_record = new_record_offsets.size();
+		for (uint32_t record_i = 0; record_i < frame.record_count; record_i++) {
+			ERR_FAIL_COND_V_MSG(frame_end - offset < IKSolveRecorder3D::RECORD_HEADER_SIZE, ERR_INVALID_DATA, "Truncated solve trace.");
+			const uint64_t heading_bytes = uint64_t(decode_uint32(bytes + offset + 8)) * IKSolveRecorder3D::HEADING_SIZE;
+			ERR_FAIL_COND_V_MSG(frame_end - offset - IKSolveRecorder3D::RECORD_HEADER_SIZE < heading_bytes, ERR_INVALID_DATA, "Truncated solve trace.");
+			new_record_offsets.push_back(offset);
+			offset += IKSolveRecorder3D::RECORD_HEADER_SIZE + heading_bytes;
+		}
+		ERR_FAIL_COND_V_MSG(offset != frame_end, ERR_INVALID_DATA, "Corrupt solve trace frame.");
+		new_frames.push_back(frame);
+	}
+	data = p_data;
+	frames = new_frames;
+	record_offsets = new_record_offsets;
+	return OK;
+}
+
+PackedByteArray IKSolveTrace3D::get_data() const {
+	return data;
+}
+
+int32_t IKSolveTrace3D::get_frame_count() const {
+	return frames.size();
+}
+
+int64_t IKSolveTrace3D::get_frame_number(int32_t p_frame) const {
+	ERR_FAIL_INDEX_V(p_frame, int32_t(frames.size()), -1);
+	return frames[p_frame].number;
+}
+
+int32_t IKSolveTrace3D::get_frame_iteration_count(int32_t p_frame) const {
+	ERR_FAIL_INDEX_V(p_frame, int32_t(frames.size()), 0);
+	return frames[p_frame].iteration_count;
+}
+
+int32_t IKSolveTrace3D::get_record_count(int32_t p_frame) const {
+	ERR_FAIL_INDEX_V(p_frame, int32_t(frames.size()), 0);
+	return frames[p_frame].record_count;
+}
+
+const uint8_t *IKSolveTrace3D::_get_record_data(int32_t p_frame, int32_t p_record) const {
+	ERR_FAIL_INDEX_V(p_frame, int32_t(frames.size()), nullptr);
+	ERR_FAIL_INDEX_V(p_record, int32_t(frames[p_frame].record_count), nullptr);
+	return data.ptr() + record_offsets[frames[p_frame].first_record + p_record];
+}
+
+bool IKSolveTrace3D::read_record(int32_t p_frame, int32_t p_record, Record &r_record) const {
+	const uint8_t *bytes = _get_record_data(p_frame, p_record);
+	if (!bytes) {
+		return false;
+	}
+	r_record.iteration = decode_uint32(bytes);
+	r_record.bone = int32_t(decode_uint32(bytes + 4));
+	r_record.heading_count = decode_uint32(bytes + 8);
+	r_record.msd = decode_float(bytes + 12);
+	r_record.qcp_rotation = ik_trace_read_quaternion(bytes + 16);
+	r_record.pre_constraint_rotation = ik_trace_read_quaternion(bytes + 32);
+	r_record.post_constraint_rotation = ik_trace_read_quaternion(bytes + 48);
+	return true;
+}
+
+Dictionary IKSolveTrace3D::get_record(int32_t p_frame, int32_t p_record) const {
+	Record record;
+	if (!read_record(p_frame, p_record, record)) {
+		return Dictionary();
+	}
+	PackedVector3Array tip_headings;
+	PackedVector3Array target_headings;
+	PackedFloat32Array weights;
+	tip_headings.resize(record.heading_count);
+	target_headings.resize(record.heading_count);
+	weights.resize(record.heading_count);
+	const uint8_t *heading = _get_record_data(p_frame, p_record) + IKSolveRecorder3D::RECORD_HEADER_SIZE;
+	for (uint32_t heading_i = 0; heading_i < record.heading_count; heading_i++, heading += IKSolveRecorder3D::HEADING_SIZE) {
+		tip_headings.set(heading_i, Vector3(decode_float(heading), decode_float(heading + 4), decode_float(heading + 8)));
+		target_headings.set(heading_i, Vector3(decode_float(heading + 12), decode_float(heading + 16), decode_float(heading + 20)));
+		weights.set(heading_i, decode_float(heading + 24));
+	}
+	Dictionary result;
+	result["iteration"] = record.iteration;
+	result["bone"] = record.bone;
+	result["msd"] = record.msd;
+	result["qcp_rotation"] = record.qcp_rotation;
+	result["pre_constraint_rotation"] = record.pre_constraint_rotation;
+	result["post_constraint_rotation"] = record.post_constraint_rotation;
+	result["tip_headings"] = tip_headings;
+	result["target_headings"] = target_headings;
+	result["weights"] = weights;
+	return result;
+}
+
+void IKSolveTrace3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_data", "data"), &IKSolveTrace3D::set_data);
+	ClassDB::bind_method(D_METHOD("get_data"), &IKSolveTrace3D::get_data);
+	ClassDB::bind_method(D_METHOD("get_frame_count"), &IKSolveTrace3D::get_frame_count);
+	ClassDB::bind_method(D_METHOD("get_frame_number", "frame"), &IKSolveTrace3D::get_frame_number);
+	ClassDB::bind_method(D_METHOD("get_frame_iteration_count", "frame"), &IKSolveTrace3D::get_frame_iteration_count);
+	ClassDB::bind_method(D_METHOD("get_record_count", "frame"), &IKSolveTrace3D::get_record_count);
+	ClassDB::bind_method(D_METHOD("get_record", "frame", "record"), &IKSolveTrace3D::get_record);
+}
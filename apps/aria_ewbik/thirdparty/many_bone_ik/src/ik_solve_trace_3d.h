@@ -0,0 +1,127 @@
+/**************************************************************************/
+/*  ik_solve_trace_3d.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/quaternion.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/variant.h"
+
+// Layout shared by the recorder and IKSolveTrace3D, all little endian:
+//   header: magic, version, frame count (uint32 each)
+//   frame:  frame number (uint64), iteration count, record count, record bytes (uint32 each)
+//   record: iteration (uint32), bone (int32), heading count (uint32), msd (float),
+//           QCP, pre-constraint and post-constraint rotations (4 floats each),
+//           then per heading the tip (3 floats), the target (3 floats) and the weight (float).
+static constexpr uint32_t IK_SOLVE_TRACE_MAGIC = 0x54424b49; // "IKBT"
+static constexpr uint32_t IK_SOLVE_TRACE_VERSION = 1;
+
+// Keeps the last few solved frames, one byte buffer per frame, reusing the
+// buffers as the ring wraps so recording settles to no allocations. EWBIK3D
+// makes it the active recorder on its thread while it solves.
+class IKSolveRecorder3D {
+	LocalVector<LocalVector<uint8_t>> frames;
+	uint32_t next_frame = 0;
+	uint32_t filled_frames = 0;
+	uint64_t frame_number = 0;
+	LocalVector<uint8_t> *current = nullptr;
+	uint32_t current_iteration = 0;
+	uint32_t current_iteration_count = 0;
+	uint32_t current_record_count = 0;
+
+	static thread_local IKSolveRecorder3D *active;
+
+public:
+	static constexpr uint32_t FRAME_HEADER_SIZE = 8 + 4 * 3;
+	static constexpr uint32_t RECORD_HEADER_SIZE = 4 * 4 + 4 * 12;
+	static constexpr uint32_t HEADING_SIZE = 4 * 7;
+
+	static _FORCE_INLINE_ IKSolveRecorder3D *get_active() { return active; }
+	static _FORCE_INLINE_ void set_active(IKSolveRecorder3D *p_recorder) { active = p_recorder; }
+
+	void set_capacity(int32_t p_frames);
+	int32_t get_capacity() const { return frames.size(); }
+	bool is_enabled() const { return !frames.is_empty(); }
+	void clear();
+
+	void begin_frame();
+	void set_iteration(uint32_t p_iteration);
+	void record_bone(int32_t p_bone, const PackedVector3Array &p_tip_headings, const PackedVector3Array &p_target_headings, const Vector<double> &p_weights,
+			const Quaternion &p_qcp_rotation, const Quaternion &p_pre_constraint_rotation, const Quaternion &p_post_constraint_rotation, float p_msd);
+	void end_frame();
+
+	// The recorded frames, oldest first.
+	PackedByteArray serialize() const;
+};
+
+// Read side of a recording made with EWBIK3D.solve_recording_frames.
+class IKSolveTrace3D : public RefCounted {
+	GDCLASS(IKSolveTrace3D, RefCounted);
+
+public:
+	struct Record {
+		uint32_t iteration = 0;
+		int32_t bone = -1;
+		uint32_t heading_count = 0;
+		float msd = 0.0f;
+		Quaternion qcp_rotation;
+		Quaternion pre_constraint_rotation;
+		Quaternion post_constraint_rotation;
+	};
+
+private:
+	struct Frame {
+		uint64_t number = 0;
+		uint32_t iteration_count = 0;
+		uint32_t first_record = 0;
+		uint32_t record_count = 0;
+	};
+
+	PackedByteArray data;
+	LocalVector<Frame> frames;
+	LocalVector<uint32_t> record_offsets;
+
+	const uint8_t *_get_record_data(int32_t p_frame, int32_t p_record) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error set_data(const PackedByteArray &p_data);
+	PackedByteArray get_data() const;
+	int32_t get_frame_count() const;
+	int64_t get_frame_number(int32_t p_frame) const;
+	int32_t get_frame_iteration_count(int32_t p_frame) const;
+	int32_t get_record_count(int32_t p_frame) const;
+	// Fills r_record without touching Variant; the headings stay in the buffer.
+	bool read_record(int32_t p_frame, int32_t p_record, Record &r_record) const;
+	Dictionary get_record(int32_t p_frame, int32_t p_record) const;
+};
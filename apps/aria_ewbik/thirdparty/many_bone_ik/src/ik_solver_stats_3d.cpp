@@ -0,0 +1,210 @@
+/**************************************************************************/
+/*  ik_solver_stats_3d.cpp                                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_solver_stats_3d.h"
+
+#include "core/config/engine.h"
+#include "core/os/memory.h"
+#include "main/performance.h"
+
+thread_local IKSolverStats3D::Counters *IKSolverStats3D::active = nullptr;
+Mutex IKSolverStats3D::global_mutex;
+IKSolverStats3D::Counters IKSolverStats3D::global_frame_counters;
+IKSolverStats3D::Counters IKSolverStats3D::global_last_frame_counters;
+uint64_t IKSolverStats3D::global_frame = 0;
+bool IKSolverStats3D::monitors_registered = false;
+
+static const char *phase_names[IKSolverStats3D::PHASE_MAX] = {
+	"target_update_usec",
+	"heading_update_usec",
+	"qcp_usec",
+	"constraints_usec",
+	"write_back_usec",
+};
+
+enum MonitorKey {
+	MONITOR_TOTAL_USEC = IKSolverStats3D::PHASE_MAX,
+	MONITOR_SOLVES,
+	MONITOR_ITERATIONS,
+	MONITOR_SEGMENTS,
+	MONITOR_BONES,
+	MONITOR_CONSTRAINT_SNAPS,
+	MONITOR_REBUILDS,
+	MONITOR_BYTES_ALLOCATED,
+	MONITOR_MAX,
+};
+
+static const char *monitor_names[MONITOR_MAX - MONITOR_TOTAL_USEC] = {
+	"total_usec",
+	"solves",
+	"iterations",
+	"segments",
+	"bones",
+	"constraint_snaps",
+	"rebuilds",
+	"bytes_allocated",
+};
+
+void IKSolverStats3D::Counters::add(const Counters &p_other) {
+	for (int32_t phase_i = 0; phase_i < PHASE_MAX; phase_i++) {
+		phase_nsec[phase_i] += p_other.phase_nsec[phase_i];
+	}
+	solves += p_other.solves;
+	iterations += p_other.iterations;
+	segments += p_other.segments;
+	bones += p_other.bones;
+	constraint_snaps += p_other.constraint_snaps;
+	rebuilds += p_other.rebuilds;
+	bytes_allocated += p_other.bytes_allocated;
+}
+
+Dictionary IKSolverStats3D::Counters::to_dictionary() const {
+	Dictionary stats;
+	uint64_t total_nsec = 0;
+	for (int32_t phase_i = 0; phase_i < PHASE_MAX; phase_i++) {
+		stats[phase_names[phase_i]] = phase_nsec[phase_i] / 1000.0;
+		total_nsec += phase_nsec[phase_i];
+	}
+	stats["total_usec"] = total_nsec / 1000.0;
+	stats["solves"] = solves;
+	stats["iterations"] = iterations;
+	stats["segments"] = segments;
+	stats["bones"] = bones;
+	stats["constraint_snaps"] = constraint_snaps;
+	stats["rebuilds"] = rebuilds;
+	stats["bytes_allocated"] = bytes_allocated;
+	return stats;
+}
+
+// The engine counter is process-wide and only maintained in debug builds.
+int64_t IKSolverStats3D::get_tracked_memory() {
+#ifdef DEBUG_ENABLED
+	return int64_t(Memory::get_mem_usage());
+#else
+	return 0;
+#endif
+}
+
+void IKSolverStats3D::add_to_global(const Counters &p_counters) {
+	add_to_global(p_counters, Engine::get_singleton()->get_process_frames());
+}
+
+void IKSolverStats3D::add_to_global(const Counters &p_counters, uint64_t p_frame) {
+	MutexLock lock(global_mutex);
+	if (p_frame != global_frame) {
+		global_last_frame_counters = global_frame_counters;
+		global_frame_counters.clear();
+		global_frame = p_frame;
+	}
+	global_frame_counters.add(p_counters);
+}
+
+IKSolverStats3D::Counters IKSolverStats3D::get_global_last_frame(uint64_t p_frame) {
+	MutexLock lock(global_mutex);
+	// Counters for the frame in progress are still filling up; report the last
+	// one that finished, which stays readable until a newer frame finishes.
+	if (p_frame != global_frame) {
+		return global_frame_counters;
+	}
+	return global_last_frame_counters;
+}
+
+Dictionary IKSolverStats3D::get_global_stats() {
+	return get_global_last_frame(Engine::get_singleton()->get_process_frames()).to_dictionary();
+}
+
+Variant IKSolverStats3D::_get_monitor(int32_t p_key) {
+	const Counters counters = get_global_last_frame(Engine::get_singleton()->get_process_frames());
+	if (p_key < PHASE_MAX) {
+		return counters.phase_nsec[p_key] / 1000.0;
+	}
+	switch (p_key) {
+		case MONITOR_TOTAL_USEC: {
+			uint64_t total_nsec = 0;
+			for (int32_t phase_i = 0; phase_i < PHASE_MAX; phase_i++) {
+				total_nsec += counters.phase_nsec[phase_i];
+			}
+			return total_nsec / 1000.0;
+		}
+		case MONITOR_SOLVES:
+			return counters.solves;
+		case MONITOR_ITERATIONS:
+			return counters.iterations;
+		case MONITOR_SEGMENTS:
+			return counters.segments;
+		case MONITOR_BONES:
+			return counters.bones;
+		case MONITOR_CONSTRAINT_SNAPS:
+			return counters.constraint_snaps;
+		case MONITOR_REBUILDS:
+			return counters.rebuilds;
+		case MONITOR_BYTES_ALLOCATED:
+			return counters.bytes_allocated;
+		default:
+			break;
+	}
+	return 0;
+}
+
+static StringName _get_monitor_id(int32_t p_key) {
+	const char *name = p_key < IKSolverStats3D::PHASE_MAX ? phase_names[p_key] : monitor_names[p_key - MONITOR_TOTAL_USEC];
+	return StringName(String("EWBIK/") + name);
+}
+
+void IKSolverStats3D::register_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (monitors_registered || !performance) {
+		return;
+	}
+	for (int32_t key_i = 0; key_i < MONITOR_MAX; key_i++) {
+		const StringName id = _get_monitor_id(key_i);
+		if (!performance->has_custom_monitor(id)) {
+			Vector<Variant> arguments;
+			arguments.push_back(key_i);
+			performance->add_custom_monitor(id, callable_mp_static(&IKSolverStats3D::_get_monitor), arguments);
+		}
+	}
+	monitors_registered = true;
+}
+
+void IKSolverStats3D::unregister_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (!monitors_registered || !performance) {
+		monitors_registered = false;
+		return;
+	}
+	for (int32_t key_i = 0; key_i < MONITOR_MAX; key_i++) {
+		const StringName id = _get_monitor_id(key_i);
+		if (performance->has_custom_monitor(id)) {
+			performance->remove_custom_monitor(id);
+		}
+	}
+	monitors_registered = false;
+}
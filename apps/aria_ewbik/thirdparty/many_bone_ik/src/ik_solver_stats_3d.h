@@ -0,0 +1,133 @@
+/**************************************************************************/
+/*  ik_solver_stats_3d.h                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/os/mutex.h"
+#include "core/variant/dictionary.h"
+
+#include <chrono>
+
+// Solver cost counters. Each EWBIK3D with stats enabled owns a set and makes
+// it the active set on its thread while it solves, so the segment code can
+// count without a pointer back to the node. With stats disabled the active
+// set is null and every counting point is a single branch.
+class IKSolverStats3D {
+public:
+	enum Phase {
+		PHASE_TARGET_UPDATE,
+		PHASE_HEADING_UPDATE,
+		PHASE_QCP,
+		PHASE_CONSTRAINTS,
+		PHASE_WRITE_BACK,
+		PHASE_MAX,
+	};
+
+	struct Counters {
+		uint64_t phase_nsec[PHASE_MAX] = {};
+		uint64_t solves = 0;
+		uint64_t iterations = 0;
+		uint64_t segments = 0;
+		uint64_t bones = 0;
+		uint64_t constraint_snaps = 0;
+		uint64_t rebuilds = 0;
+		// Net growth of the process-wide engine memory counter while solving, so
+		// allocations on other threads during the solve are counted too. Always 0
+		// in release builds, which do not track memory.
+		int64_t bytes_allocated = 0;
+
+		void clear() { *this = Counters(); }
+		void add(const Counters &p_other);
+		Dictionary to_dictionary() const;
+	};
+
+	// Adds the time spent in its scope to one phase of p_counters, if any.
+	class PhaseScope {
+		Counters *counters = nullptr;
+		Phase phase = PHASE_MAX;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		_FORCE_INLINE_ PhaseScope(Counters *p_counters, Phase p_phase) :
+				counters(p_counters), phase(p_phase) {
+			if (unlikely(counters)) {
+				start = std::chrono::steady_clock::now();
+			}
+		}
+		_FORCE_INLINE_ ~PhaseScope() {
+			if (unlikely(counters)) {
+				counters->phase_nsec[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+		}
+	};
+
+private:
+	static thread_local Counters *active;
+
+	static Mutex global_mutex;
+	static Counters global_frame_counters;
+	static Counters global_last_frame_counters;
+	static uint64_t global_frame;
+	static bool monitors_registered;
+
+	static Variant _get_monitor(int32_t p_key);
+
+public:
+	static _FORCE_INLINE_ Counters *get_active() { return active; }
+	static _FORCE_INLINE_ void set_active(Counters *p_counters) { active = p_counters; }
+	static _FORCE_INLINE_ void count_segment() {
+		if (unlikely(active)) {
+			active->segments++;
+		}
+	}
+	static _FORCE_INLINE_ void count_bone() {
+		if (unlikely(active)) {
+			active->bones++;
+		}
+	}
+	static _FORCE_INLINE_ void count_constraint_snap() {
+		if (unlikely(active)) {
+			active->constraint_snaps++;
+		}
+	}
+
+	static int64_t get_tracked_memory();
+	// Adds one instance's frame to the aggregate of the current process frame.
+	static void add_to_global(const Counters &p_counters);
+	static void add_to_global(const Counters &p_counters, uint64_t p_frame);
+	// The aggregate of the last process frame before p_frame that finished.
+	static Counters get_global_last_frame(uint64_t p_frame);
+	// The aggregate over all instances for the last completed process frame
+	// that solved anything.
+	static Dictionary get_global_stats();
+	// Registers the aggregate as custom Performance monitors under "EWBIK/".
+	static void register_monitors();
+	static void unregister_monitors();
+};
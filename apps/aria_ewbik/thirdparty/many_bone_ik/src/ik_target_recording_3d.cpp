@@ -0,0 +1,285 @@
+/**************************************************************************/
+/*  ik_target_recording_3d.cpp                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_target_recording_3d.h"
+
+#include "core/io/file_access.h"
+#include "core/io/marshalls.h"
+#include "core/object/class_db.h"
+#include "scene/3d/skeleton_3d.h"
+
+static _FORCE_INLINE_ uint8_t *ik_recording_grow(LocalVector<uint8_t> &r_bytes, uint32_t p_size) {
+	const uint32_t offset = r_bytes.size();
+	r_bytes.resize(offset + p_size);
+	return &r_bytes[offset];
+}
+
+static _FORCE_INLINE_ uint8_t *ik_recording_write_floats(uint8_t *p_write, const real_t *p_values, int32_t p_count) {
+	for (int32_t value_i = 0; value_i < p_count; value_i++) {
+		p_write += encode_float(p_values[value_i], p_write);
+	}
+	return p_write;
+}
+
+static _FORCE_INLINE_ Vector3 ik_recording_read_vector3(const uint8_t *p_bytes) {
+	return Vector3(decode_float(p_bytes), decode_float(p_bytes + 4), decode_float(p_bytes + 8));
+}
+
+static _FORCE_INLINE_ Quaternion ik_recording_read_quaternion(const uint8_t *p_bytes) {
+	return Quaternion(decode_float(p_bytes), decode_float(p_bytes + 4), decode_float(p_bytes + 8), decode_float(p_bytes + 12));
+}
+
+uint32_t IKTargetRecording3D::_get_frame_size() const {
+	return FRAME_HEADER_SIZE + bone_count * (INPUT_POSE_SIZE + SOLVED_POSE_SIZE) + pin_count * TARGET_SIZE;
+}
+
+const uint8_t *IKTargetRecording3D::_get_frame(int32_t p_frame) const {
+	ERR_FAIL_INDEX_V(p_frame, int32_t(frame_count), nullptr);
+	return data.ptr() + HEADER_SIZE + uint64_t(p_frame) * _get_frame_size();
+}
+
+void IKTargetRecording3D::start(int32_t p_bone_count, int32_t p_pin_count) {
+	ERR_FAIL_COND(p_bone_count < 0 || p_pin_count < 0);
+	bone_count = p_bone_count;
+	pin_count = p_pin_count;
+	frame_count = 0;
+	frame_open = false;
+	data.clear();
+	uint8_t *write = ik_recording_grow(data, HEADER_SIZE);
+	write += encode_uint32(IK_TARGET_RECORDING_MAGIC, write);
+	write += encode_uint32(IK_TARGET_RECORDING_VERSION, write);
+	write += encode_uint32(bone_count, write);
+	write += encode_uint32(pin_count, write);
+	encode_uint32(0, write);
+}
+
+bool IKTargetRecording3D::begin_frame(double p_delta, int32_t p_iterations, float p_default_damp, int32_t p_stabilization_passes, int32_t p_pin_count, const Skeleton3D *p_skeleton) {
+	ERR_FAIL_NULL_V(p_skeleton, false);
+	ERR_FAIL_COND_V_MSG(data.is_empty(), false, "The target recording was not started.");
+	ERR_FAIL_COND_V_MSG(uint32_t(p_skeleton->get_bone_count()) != bone_count || uint32_t(p_pin_count) != pin_count, false, "The skeleton or pins changed during the target recording.");
+	frame_open = true;
+	uint8_t *write = ik_recording_grow(data, FRAME_HEADER_SIZE + bone_count * INPUT_POSE_SIZE);
+	write += encode_double(p_delta, write);
+	write += encode_uint32(p_iterations, write);
+	write += encode_float(p_default_damp, write);
+	write += encode_uint32(p_stabilization_passes, write);
+	for (uint32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		const Vector3 position = p_skeleton->get_bone_pose_position(bone_i);
+		const Quaternion rotation = p_skeleton->get_bone_pose_rotation(bone_i);
+		const Vector3 scale = p_skeleton->get_bone_pose_scale(bone_i);
+		const real_t values[10] = { position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z };
+		write = ik_recording_write_floats(write, values, 10);
+	}
+	return true;
+}
+
+void IKTargetRecording3D::end_frame(const Transform3D *p_pin_targets, const Skeleton3D *p_skeleton) {
+	ERR_FAIL_NULL(p_skeleton);
+	if (!frame_open) {
+		return;
+	}
+	frame_open = false;
+	uint8_t *write = ik_recording_grow(data, pin_count * TARGET_SIZE + bone_count * SOLVED_POSE_SIZE);
+	for (uint32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+		const Transform3D &target = p_pin_targets[pin_i];
+		const real_t values[12] = {
+			target.basis.rows[0].x, target.basis.rows[0].y, target.basis.rows[0].z,
+			target.basis.rows[1].x, target.basis.rows[1].y, target.basis.rows[1].z,
+			target.basis.rows[2].x, target.basis.rows[2].y, target.basis.rows[2].z,
+			target.origin.x, target.origin.y, target.origin.z
+		};
+		write = ik_recording_write_floats(write, values, 12);
+	}
+	for (uint32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		const Vector3 position = p_skeleton->get_bone_pose_position(bone_i);
+		const Quaternion rotation = p_skeleton->get_bone_pose_rotation(bone_i);
+		const real_t values[7] = { position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w };
+		write = ik_recording_write_floats(write, values, 7);
+	}
+	frame_count++;
+	encode_uint32(frame_count, &data[16]);
+}
+
+Error IKTargetRecording3D::set_data(const PackedByteArray &p_data) {
+	const uint8_t *bytes = p_data.ptr();
+	const uint64_t size = p_data.size();
+	ERR_FAIL_COND_V_MSG(size < HEADER_SIZE || decode_uint32(bytes) != IK_TARGET_RECORDING_MAGIC, ERR_INVALID_DATA, "Not a target recording.");
+	ERR_FAIL_COND_V_MSG(decode_uint32(bytes + 4) != IK_TARGET_RECORDING_VERSION, ERR_INVALID_DATA, "Unsupported target recording version.");
+	const uint32_t new_bone_count = decode_uint32(bytes + 8);
+	const uint32_t new_pin_count = decode_uint32(bytes + 12);
+	const uint32_t new_frame_count = decode_uint32(bytes + 16);
+	const uint64_t frame_size = FRAME_HEADER_SIZE + uint64_t(new_bone_count) * (INPUT_POSE_SIZE + SOLVED_POSE_SIZE) + uint64_t(new_pin_count) * TARGET_SIZE;
+	ERR_FAIL_COND_V_MSG(size != HEADER_SIZE + frame_size * new_frame_count, ERR_INVALID_DATA, "Truncated or corrupt target recording.");
+	data.resize(size);
+	memcpy(data.ptr(), bytes, size);
+	bone_count = new_bone_count;
+	pin_count = new_pin_count;
+	frame_count = new_frame_count;
+	frame_open = false;
+	return OK;
+}
+
+PackedByteArray IKTargetRecording3D::get_data() const {
+	PackedByteArray bytes;
+	bytes.resize(data.size());
+	if (!data.is_empty()) {
+		memcpy(bytes.ptrw(), data.ptr(), data.size());
+	}
+	return bytes;
+}
+
+Error IKTargetRecording3D::save(const String &p_path) const {
+	Error err = OK;
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(file.is_null(), err, vformat("Cannot write target recording to %s.", p_path));
+	file->store_buffer(data.ptr(), data.size());
+	return OK;
+}
+
+Error IKTargetRecording3D::load(const String &p_path) {
+	Error err = OK;
+	const PackedByteArray bytes = FileAccess::get_file_as_bytes(p_path, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, vformat("Cannot read target recording from %s.", p_path));
+	return set_data(bytes);
+}
+
+int32_t IKTargetRecording3D::get_bone_count() const {
+	return bone_count;
+}
+
+int32_t IKTargetRecording3D::get_pin_count() const {
+	return pin_count;
+}
+
+int32_t IKTargetRecording3D::get_frame_count() const {
+	return frame_count;
+}
+
+double IKTargetRecording3D::get_frame_delta(int32_t p_frame) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, 0.0);
+	return decode_double(frame);
+}
+
+int32_t IKTargetRecording3D::get_frame_iterations(int32_t p_frame) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, 0);
+	return decode_uint32(frame + 8);
+}
+
+float IKTargetRecording3D::get_frame_default_damp(int32_t p_frame) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, 0.0f);
+	return decode_float(frame + 12);
+}
+
+int32_t IKTargetRecording3D::get_frame_stabilization_passes(int32_t p_frame) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, 0);
+	return decode_uint32(frame + 16);
+}
+
+bool IKTargetRecording3D::read_input_pose(int32_t p_frame, int32_t p_bone, Vector3 &r_position, Quaternion &r_rotation, Vector3 &r_scale) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, false);
+	ERR_FAIL_INDEX_V(p_bone, int32_t(bone_count), false);
+	const uint8_t *pose = frame + FRAME_HEADER_SIZE + p_bone * INPUT_POSE_SIZE;
+	r_position = ik_recording_read_vector3(pose);
+	r_rotation = ik_recording_read_quaternion(pose + 12);
+	r_scale = ik_recording_read_vector3(pose + 28);
+	return true;
+}
+
+bool IKTargetRecording3D::read_solved_pose(int32_t p_frame, int32_t p_bone, Vector3 &r_position, Quaternion &r_rotation) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, false);
+	ERR_FAIL_INDEX_V(p_bone, int32_t(bone_count), false);
+	const uint8_t *pose = frame + FRAME_HEADER_SIZE + bone_count * INPUT_POSE_SIZE + pin_count * TARGET_SIZE + p_bone * SOLVED_POSE_SIZE;
+	r_position = ik_recording_read_vector3(pose);
+	r_rotation = ik_recording_read_quaternion(pose + 12);
+	return true;
+}
+
+Transform3D IKTargetRecording3D::get_frame_input_pose(int32_t p_frame, int32_t p_bone) const {
+	Vector3 position;
+	Quaternion rotation;
+	Vector3 scale;
+	if (!read_input_pose(p_frame, p_bone, position, rotation, scale)) {
+		return Transform3D();
+	}
+	return Transform3D(Basis(rotation), position);
+}
+
+Vector3 IKTargetRecording3D::get_frame_input_scale(int32_t p_frame, int32_t p_bone) const {
+	Vector3 position;
+	Quaternion rotation;
+	Vector3 scale(1, 1, 1);
+	read_input_pose(p_frame, p_bone, position, rotation, scale);
+	return scale;
+}
+
+Transform3D IKTargetRecording3D::get_frame_pin_target(int32_t p_frame, int32_t p_pin) const {
+	const uint8_t *frame = _get_frame(p_frame);
+	ERR_FAIL_NULL_V(frame, Transform3D());
+	ERR_FAIL_INDEX_V(p_pin, int32_t(pin_count), Transform3D());
+	const uint8_t *target = frame + FRAME_HEADER_SIZE + bone_count * INPUT_POSE_SIZE + p_pin * TARGET_SIZE;
+	real_t values[12];
+	for (int32_t value_i = 0; value_i < 12; value_i++) {
+		values[value_i] = decode_float(target + value_i * 4);
+	}
+	return Transform3D(values[0], values[1], values[2], values[3], values[4], values[5], values[6], values[7], values[8], values[9], values[10], values[11]);
+}
+
+Transform3D IKTargetRecording3D::get_frame_solved_pose(int32_t p_frame, int32_t p_bone) const {
+	Vector3 position;
+	Quaternion rotation;
+	if (!read_solved_pose(p_frame, p_bone, position, rotation)) {
+		return Transform3D();
+	}
+	return Transform3D(Basis(rotation), position);
+}
+
+void IKTargetRecording3D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_data", "data"), &IKTargetRecording3D::set_data);
+	ClassDB::bind_method(D_METHOD("get_data"), &IKTargetRecording3D::get_data);
+	ClassDB::bind_method(D_METHOD("save", "path"), &IKTargetRecording3D::save);
+	ClassDB::bind_method(D_METHOD("load", "path"), &IKTargetRecording3D::load);
+	ClassDB::bind_method(D_METHOD("get_bone_count"), &IKTargetRecording3D::get_bone_count);
+	ClassDB::bind_method(D_METHOD("get_pin_count"), &IKTargetRecording3D::get_pin_count);
+	ClassDB::bind_method(D_METHOD("get_frame_count"), &IKTargetRecording3D::get_frame_count);
+	ClassDB::bind_method(D_METHOD("get_frame_delta", "frame"), &IKTargetRecording3D::get_frame_delta);
+	ClassDB::bind_method(D_METHOD("get_frame_iterations", "frame"), &IKTargetRecording3D::get_frame_iterations);
+	ClassDB::bind_method(D_METHOD("get_frame_default_damp", "frame"), &IKTargetRecording3D::get_frame_default_damp);
+	ClassDB::bind_method(D_METHOD("get_frame_stabilization_passes", "frame"), &IKTargetRecording3D::get_frame_stabilization_passes);
+	ClassDB::bind_method(D_METHOD("get_frame_input_pose", "frame", "bone"), &IKTargetRecording3D::get_frame_input_pose);
+	ClassDB::bind_method(D_METHOD("get_frame_input_scale", "frame", "bone"), &IKTargetRecording3D::get_frame_input_scale);
+	ClassDB::bind_method(D_METHOD("get_frame_pin_target", "frame", "pin"), &IKTargetRecording3D::get_frame_pin_target);
+	ClassDB::bind_method(D_METHOD("get_frame_solved_pose", "frame", "bone"), &IKTargetRecording3D::get_frame_solved_pose);
+}
@@ -0,0 +1,101 @@
+/**************************************************************************/
+/*  ik_target_recording_3d.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/transform_3d.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+
+class Skeleton3D;
+
+// Layout of a target recording, all little endian:
+//   header: magic, version, bone count, pin count, frame count (uint32 each)
+//   frame:  delta (double), iterations (uint32), default damp (float), stabilization passes (uint32),
+//           per bone the incoming pose position, rotation and scale (10 floats),
+//           per pin the target (12 floats, basis rows then origin),
+//           per bone the solved pose position and rotation (7 floats).
+// Every frame has the same size, so frames can be read in place.
+static constexpr uint32_t IK_TARGET_RECORDING_MAGIC = 0x52544b49; // "IKTR"
+static constexpr uint32_t IK_TARGET_RECORDING_VERSION = 1;
+
+// Everything EWBIK3D needed to solve a run of frames, and what it produced,
+// so a bug seen in production can be replayed headless with
+// EWBIK3D.replay_target_recording().
+class IKTargetRecording3D : public RefCounted {
+	GDCLASS(IKTargetRecording3D, RefCounted);
+
+public:
+	static constexpr uint32_t HEADER_SIZE = 4 * 5;
+	static constexpr uint32_t FRAME_HEADER_SIZE = 8 + 4 * 3;
+	static constexpr uint32_t INPUT_POSE_SIZE = 4 * 10;
+	static constexpr uint32_t TARGET_SIZE = 4 * 12;
+	static constexpr uint32_t SOLVED_POSE_SIZE = 4 * 7;
+
+private:
+	LocalVector<uint8_t> data;
+	uint32_t bone_count = 0;
+	uint32_t pin_count = 0;
+	uint32_t frame_count = 0;
+	bool frame_open = false;
+
+	uint32_t _get_frame_size() const;
+	const uint8_t *_get_frame(int32_t p_frame) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Recording, driven by EWBIK3D. begin_frame() refuses a skeleton or pin
+	// list whose size differs from the one the recording started with.
+	void start(int32_t p_bone_count, int32_t p_pin_count);
+	bool begin_frame(double p_delta, int32_t p_iterations, float p_default_damp, int32_t p_stabilization_passes, int32_t p_pin_count, const Skeleton3D *p_skeleton);
+	void end_frame(const Transform3D *p_pin_targets, const Skeleton3D *p_skeleton);
+
+	Error set_data(const PackedByteArray &p_data);
+	PackedByteArray get_data() const;
+	Error save(const String &p_path) const;
+	Error load(const String &p_path);
+
+	int32_t get_bone_count() const;
+	int32_t get_pin_count() const;
+	int32_t get_frame_count() const;
+	double get_frame_delta(int32_t p_frame) const;
+	int32_t get_frame_iterations(int32_t p_frame) const;
+	float get_frame_default_damp(int32_t p_frame) const;
+	int32_t get_frame_stabilization_passes(int32_t p_frame) const;
+	// Exact stored values, without a round trip through Basis.
+	bool read_input_pose(int32_t p_frame, int32_t p_bone, Vector3 &r_position, Quaternion &r_rotation, Vector3 &r_scale) const;
+	bool read_solved_pose(int32_t p_frame, int32_t p_bone, Vector3 &r_position, Quaternion &r_rotation) const;
+	Transform3D get_frame_input_pose(int32_t p_frame, int32_t p_bone) const;
+	Vector3 get_frame_input_scale(int32_t p_frame, int32_t p_bone) const;
+	Transform3D get_frame_pin_target(int32_t p_frame, int32_t p_pin) const;
+	Transform3D get_frame_solved_pose(int32_t p_frame, int32_t p_bone) const;
+};
@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*  ik_trace_3d.cpp                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "ik_trace_3d.h"
+
+#include "core/io/file_access.h"
+#include "core/os/thread.h"
+#include "core/string/string_builder.h"
+
+std::atomic<bool> IKTrace3D::capturing(false);
+Mutex IKTrace3D::mutex;
+LocalVector<IKTrace3D::Event> IKTrace3D::events;
+uint64_t IKTrace3D::dropped_events = 0;
+
+void IKTrace3D::_record(const char *p_name, uint64_t p_instance, uint64_t p_start_usec, uint64_t p_end_usec) {
+	Event event;
+	event.name = p_name;
+	event.thread = uint64_t(Thread::get_caller_id());
+	event.instance = p_instance;
+	event.start_usec = p_start_usec;
+	event.duration_usec = p_end_usec - p_start_usec;
+	MutexLock lock(mutex);
+	if (events.size() >= MAX_EVENTS) {
+		dropped_events++;
+		return;
+	}
+	events.push_back(event);
+}
+
+bool IKTrace3D::is_available() {
+#ifdef MANY_BONE_IK_TRACE
+	return true;
+#else
+	return false;
+#endif
+}
+
+Error IKTrace3D::start() {
+	ERR_FAIL_COND_V_MSG(!is_available(), ERR_UNAVAILABLE, "Solver tracing is compiled out. Build with many_bone_ik_trace=yes.");
+	start_capture();
+	return OK;
+}
+
+void IKTrace3D::start_capture() {
+	clear();
+	capturing.store(true, std::memory_order_relaxed);
+}
+
+void IKTrace3D::stop() {
+	capturing.store(false, std::memory_order_relaxed);
+}
+
+uint32_t IKTrace3D::get_event_count() {
+	MutexLock lock(mutex);
+	return events.size();
+}
+
+uint64_t IKTrace3D::get_dropped_event_count() {
+	MutexLock lock(mutex);
+	return dropped_events;
+}
+
+void IKTrace3D::clear() {
+	MutexLock lock(mutex);
+	events.clear();
+	dropped_events = 0;
+}
+
+String IKTrace3D::to_json() {
+	MutexLock lock(mutex);
+	StringBuilder json;
+	json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (uint32_t event_i = 0; event_i < events.size(); event_i++) {
+		const Event &event = events[event_i];
+		if (event_i) {
+			json.append(",");
+		}
+		// Event names are string literals from the solver, so they need no escaping.
+		json.append("{\"name\":\"");
+		json.append(event.name);
+		json.append("\",\"cat\":\"ewbik\",\"ph\":\"X\",\"pid\":0,\"tid\":");
+		json.append(itos(int64_t(event.thread)));
+		json.append(",\"ts\":");
+		json.append(itos(int64_t(event.start_usec)));
+		json.append(",\"dur\":");
+		json.append(itos(int64_t(event.duration_usec)));
+		if (event.instance) {
+			json.append(",\"args\":{\"instance\":");
+			json.append(itos(int64_t(event.instance)));
+			json.append("}");
+		}
+		json.append("}");
+	}
+	json.append("]}");
+	return json.as_string();
+}
+
+Error IKTrace3D::save(const String &p_path) {
+	Error err = OK;
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(file.is_null(), err, vformat("Cannot write solver trace to %s.", p_path));
+	file->store_string(to_json());
+	return OK;
+}
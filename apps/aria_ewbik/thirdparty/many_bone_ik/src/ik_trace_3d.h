@@ -0,0 +1,110 @@
+/**************************************************************************/
+/*  ik_trace_3d.h                                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
+
+// Timeline capture of solver phases in the Chrome trace event format, which
+// chrome://tracing and ui.perfetto.dev open directly. The IK_TRACE_* macros
+// only exist in builds with many_bone_ik_trace=yes; otherwise they expand to
+// nothing and the solver carries no instrumentation at all.
+class IKTrace3D {
+public:
+	struct Event {
+		const char *name = nullptr;
+		uint64_t thread = 0;
+		uint64_t instance = 0;
+		uint64_t start_usec = 0;
+		uint64_t duration_usec = 0;
+	};
+
+	// Records the time between its construction and destruction as one event.
+	class Scope {
+		const char *name = nullptr;
+		uint64_t instance = 0;
+		uint64_t start_usec = 0;
+
+	public:
+		_FORCE_INLINE_ Scope(const char *p_name, uint64_t p_instance = 0) {
+			if (unlikely(capturing.load(std::memory_order_relaxed))) {
+				name = p_name;
+				instance = p_instance;
+				start_usec = OS::get_singleton()->get_ticks_usec();
+			}
+		}
+		_FORCE_INLINE_ ~Scope() {
+			if (unlikely(name)) {
+				_record(name, instance, start_usec, OS::get_singleton()->get_ticks_usec());
+			}
+		}
+	};
+
+	// Stops accepting events past this many, so a forgotten capture cannot eat all memory.
+	static constexpr uint32_t MAX_EVENTS = 1 << 20;
+
+private:
+	static std::atomic<bool> capturing;
+	static Mutex mutex;
+	static LocalVector<Event> events;
+	static uint64_t dropped_events;
+
+	static void _record(const char *p_name, uint64_t p_instance, uint64_t p_start_usec, uint64_t p_end_usec);
+
+public:
+	static bool is_available();
+	// Clears earlier events and starts recording. Fails in builds without tracing.
+	static Error start();
+	// Like start(), but also in builds without tracing, where only Scopes
+	// placed by hand record anything.
+	static void start_capture();
+	static void stop();
+	static bool is_capturing() { return capturing.load(std::memory_order_relaxed); }
+	static uint32_t get_event_count();
+	static uint64_t get_dropped_event_count();
+	static String to_json();
+	static Error save(const String &p_path);
+	static void clear();
+};
+
+#ifdef MANY_BONE_IK_TRACE
+#define IK_TRACE_CONCAT_IMPL(m_a, m_b) m_a##m_b
+#define IK_TRACE_CONCAT(m_a, m_b) IK_TRACE_CONCAT_IMPL(m_a, m_b)
+#define IK_TRACE_SCOPE(m_name) IKTrace3D::Scope IK_TRACE_CONCAT(_ik_trace_scope_, __LINE__)(m_name)
+#define IK_TRACE_SCOPE_INSTANCE(m_name, m_instance) IKTrace3D::Scope IK_TRACE_CONCAT(_ik_trace_scope_, __LINE__)(m_name, m_instance)
+#else
+#define IK_TRACE_SCOPE(m_name)
+#define IK_TRACE_SCOPE_INSTANCE(m_name, m_instance)
+#endif
@@ -33,10 +33,18 @@
 #include "core/math/math_defs.h"
 #include "core/object/class_db.h"
 #include "core/object/object.h"
+#include "core/os/os.h"
 #include "core/string/string_name.h"
+#include "core/templates/hash_set.h"
 #include "ik_bone_3d.h"
+#include "ik_effector_3d.h"
 #include "ik_kusudama_3d.h"
 #include "ik_open_cone_3d.h"
+#include "ik_solve_trace_3d.h"
+#include "ik_solver_stats_3d.h"
+#include "ik_trace_3d.h"
+#include "math/ik_deterministic_math.h"
+#include "modules/many_bone_ik/core/ik_core_frame_ring.h"
 #include "scene/3d/marker_3d.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/main/node.h"
@@ -110,6 +118,7 @@ void EWBIK3D::_remove_pin(int32_t p_index) {
 }
 
 void EWBIK3D::_update_ik_bones_transform() {
+	IKSolverStats3D::PhaseScope target_scope(_get_stats_counters(), IKSolverStats3D::PHASE_TARGET_UPDATE);
 	for (int32_t bone_i = bone_list.size(); bone_i-- > 0;) {
 		Ref<IKBone3D> bone = bone_list[bone_i];
 		if (bone.is_null()) {
@@ -118,11 +127,339 @@ void EWBIK3D::_update_ik_bones_transform() {
 		bone->set_initial_pose(get_skeleton());
 		if (bone->is_pinned()) {
 			bone->get_pin()->update_target_global_transform(get_skeleton(), this);
+			const Transform3D *target_override = pin_target_overrides.getptr(bone->get_name());
+			if (target_override) {
+				bone->get_pin()->set_target_global_transform(*target_override);
+			}
+		}
+	}
+	if (reachability_volume.is_null() || !clamp_unreachable_targets) {
+		return;
+	}
+	// Pull impossible targets onto the nearest baked reachable cell before iterating,
+	// so the solver does not spend its iterations straining toward them.
+	for (const PinReachability &entry : pin_reachability) {
+		if (entry.effector != -1) {
+			_clamp_pin_target_to_reachable(entry);
+		}
+	}
+}
+
+void EWBIK3D::_build_pin_reachability() {
+	pin_reachability.clear();
+	HashMap<const IKBone3D *, Ref<IKBoneSegment3D>> tip_segments;
+	Vector<Ref<IKBoneSegment3D>> stack = segmented_skeletons;
+	while (!stack.is_empty()) {
+		Ref<IKBoneSegment3D> segment = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+		if (segment.is_null()) {
+			continue;
+		}
+		if (segment->get_tip().is_valid()) {
+			tip_segments.insert(segment->get_tip().ptr(), segment);
+		}
+		stack.append_array(segment->get_child_segments());
+	}
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		if (bone.is_null() || !bone->is_pinned()) {
+			continue;
+		}
+		const Ref<IKBoneSegment3D> *segment = tip_segments.getptr(bone.ptr());
+		if (!segment) {
+			continue;
+		}
+		PinReachability entry;
+		entry.bone = bone;
+		entry.segment = *segment;
+		pin_reachability.push_back(entry);
+	}
+	_resolve_pin_reachability_effectors();
+}
+
+void EWBIK3D::_resolve_pin_reachability_effectors() {
+	Skeleton3D *skeleton = get_skeleton();
+	for (PinReachability &entry : pin_reachability) {
+		entry.effector = -1;
+		if (skeleton && reachability_volume.is_valid()) {
+			entry.effector = reachability_volume->find_effector(skeleton->get_bone_name(entry.bone->get_bone_id()));
+		}
+	}
+}
+
+Transform3D EWBIK3D::_get_reachability_frame(const Ref<IKBone3D> &p_segment_root) const {
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, Transform3D());
+	const BoneId parent_id = skeleton->get_bone_parent(p_segment_root->get_bone_id());
+	if (parent_id == -1) {
+		return Transform3D();
+	}
+	return skeleton->get_bone_global_pose(parent_id);
+}
+
+void EWBIK3D::_clamp_pin_target_to_reachable(const PinReachability &p_entry) {
+	const Transform3D frame = _get_reachability_frame(p_entry.segment->get_root());
+	Ref<IKEffector3D> pin = p_entry.bone->get_pin();
+	Transform3D target = pin->get_target_global_transform();
+	const Vector3 local_target = frame.affine_inverse().xform(target.origin);
+	if (reachability_volume->is_reachable(p_entry.effector, local_target)) {
+		return;
+	}
+	target.origin = frame.xform(reachability_volume->get_nearest_reachable(p_entry.effector, local_target));
+	pin->set_target_global_transform(target);
+	if (p_entry.pin_index != -1) {
+		pin_residual_states[p_entry.pin_index].target_clamped = true;
+	}
+}
+
+void EWBIK3D::set_pin_target_transform_override(int32_t p_pin_index, const Transform3D &p_transform) {
+	ERR_FAIL_INDEX(p_pin_index, pins.size());
+	pin_target_overrides[get_pin_bone_name(p_pin_index)] = p_transform;
+}
+
+void EWBIK3D::clear_pin_target_transform_override(int32_t p_pin_index) {
+	ERR_FAIL_INDEX(p_pin_index, pins.size());
+	pin_target_overrides.erase(get_pin_bone_name(p_pin_index));
+}
+
+void EWBIK3D::clear_pin_target_transform_overrides() {
+	pin_target_overrides.clear();
+}
+
+bool EWBIK3D::has_pin_target_transform_override(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, pins.size(), false);
+	return pin_target_overrides.has(get_pin_bone_name(p_pin_index));
+}
+
+void EWBIK3D::solve() {
+	// Solve immediately from the skeleton's current pose, which acts as the warm start.
+	if (!get_skeleton()) {
+		return;
+	}
+	if (!is_dirty && segmented_skeletons.size()) {
+		_update_ik_bones_transform();
+	}
+	_process_modification(0.0);
+}
+
+int64_t EWBIK3D::get_pose_hash() const {
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, 0);
+	uint64_t hash = IKDeterministicMath::HASH_BASIS;
+	for (int32_t bone_i = 0; bone_i < skeleton->get_bone_count(); bone_i++) {
+		const Vector3 position = skeleton->get_bone_pose_position(bone_i);
+		const Quaternion rotation = skeleton->get_bone_pose_rotation(bone_i);
+		const real_t components[7] = { position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w };
+		hash = IKDeterministicMath::hash_bits(components, sizeof(components), hash);
+	}
+	return int64_t(hash);
+}
+
+// Visits segments depth first, in the order the solver builds them.
+template <typename F>
+static void _for_each_segment(const Vector<Ref<IKBoneSegment3D>> &p_segments, F &&p_visit) {
+	for (const Ref<IKBoneSegment3D> &segment : p_segments) {
+		if (segment.is_null()) {
+			continue;
+		}
+		p_visit(segment);
+		_for_each_segment(segment->get_child_segments(), p_visit);
+	}
+}
+
+EWBIK3D::SolverStateHeader EWBIK3D::_get_solver_state_header() const {
+	SolverStateHeader header;
+	header.bone_count = bone_list.size();
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		if (bone.is_valid() && bone->is_pinned()) {
+			header.pinned_count++;
+		}
+	}
+	_for_each_segment(segmented_skeletons, [&header](const Ref<IKBoneSegment3D> &) {
+		header.segment_count++;
+	});
+	return header;
+}
+
+int64_t EWBIK3D::get_solver_state_size() const {
+	const SolverStateHeader header = _get_solver_state_header();
+	return sizeof(SolverStateHeader) + header.bone_count * sizeof(SolverBoneState) + header.pinned_count * sizeof(Transform3D) + header.segment_count * sizeof(double);
+}
+
+Error EWBIK3D::save_solver_state_to_buffer(uint8_t *r_buffer, int64_t p_size) const {
+	ERR_FAIL_NULL_V(r_buffer, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(is_dirty || segmented_skeletons.is_empty(), ERR_UNCONFIGURED, "Solve at least once before saving the solver state.");
+	ERR_FAIL_COND_V(p_size != get_solver_state_size(), ERR_INVALID_PARAMETER);
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, ERR_UNCONFIGURED);
+	const SolverStateHeader header = _get_solver_state_header();
+	uint8_t *write = r_buffer;
+	memcpy(write, &header, sizeof(header));
+	write += sizeof(header);
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		SolverBoneState state;
+		if (bone.is_valid()) {
+			state.pose = bone->get_pose();
+			state.cos_half_dampen = bone->get_cos_half_dampen();
+			if (bone->get_bone_id() != -1) {
+				state.skeleton_position = skeleton->get_bone_pose_position(bone->get_bone_id());
+				state.skeleton_rotation = skeleton->get_bone_pose_rotation(bone->get_bone_id());
+				state.skeleton_scale = skeleton->get_bone_pose_scale(bone->get_bone_id());
+			}
+		}
+		memcpy(write, &state, sizeof(state));
+		write += sizeof(state);
+	}
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		if (bone.is_valid() && bone->is_pinned()) {
+			const Transform3D target = bone->get_pin()->get_target_global_transform();
+			memcpy(write, &target, sizeof(target));
+			write += sizeof(target);
+		}
+	}
+	_for_each_segment(segmented_skeletons, [&write](const Ref<IKBoneSegment3D> &p_segment) {
+		const double deviation = p_segment->get_previous_deviation();
+		memcpy(write, &deviation, sizeof(deviation));
+		write += sizeof(deviation);
+	});
+	return OK;
+}
+
+Error EWBIK3D::restore_solver_state_from_buffer(const uint8_t *p_buffer, int64_t p_size) {
+	ERR_FAIL_NULL_V(p_buffer, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(is_dirty || segmented_skeletons.is_empty(), ERR_UNCONFIGURED, "The solver was rebuilt since the state was saved.");
+	ERR_FAIL_COND_V(p_size != get_solver_state_size(), ERR_INVALID_DATA);
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, ERR_UNCONFIGURED);
+	SolverStateHeader saved_header;
+	memcpy(&saved_header, p_buffer, sizeof(saved_header));
+	const SolverStateHeader header = _get_solver_state_header();
+	ERR_FAIL_COND_V_MSG(saved_header.version != header.version || saved_header.bone_count != header.bone_count || saved_header.pinned_count != header.pinned_count || saved_header.segment_count != header.segment_count, ERR_INVALID_DATA, "The solver state was saved from a different bone or segment layout.");
+	const uint8_t *read = p_buffer + sizeof(saved_header);
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		SolverBoneState state;
+		memcpy(&state, read, sizeof(state));
+		read += sizeof(state);
+		if (bone.is_null()) {
+			continue;
+		}
+		bone->set_pose(state.pose);
+		bone->set_cos_half_dampen(state.cos_half_dampen);
+		if (bone->get_bone_id() != -1) {
+			skeleton->set_bone_pose_position(bone->get_bone_id(), state.skeleton_position);
+			skeleton->set_bone_pose_rotation(bone->get_bone_id(), state.skeleton_rotation);
+			skeleton->set_bone_pose_scale(bone->get_bone_id(), state.skeleton_scale);
+		}
+	}
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		if (bone.is_valid() && bone->is_pinned()) {
+			Transform3D target;
+			memcpy(&target, read, sizeof(target));
+			read += sizeof(target);
+			bone->get_pin()->set_target_global_transform(target);
+		}
+	}
+	_for_each_segment(segmented_skeletons, [&read](const Ref<IKBoneSegment3D> &p_segment) {
+		double deviation;
+		memcpy(&deviation, read, sizeof(deviation));
+		read += sizeof(deviation);
+		p_segment->set_previous_deviation(deviation);
+	});
+	return OK;
+}
+
+PackedByteArray EWBIK3D::save_solver_state() const {
+	PackedByteArray state;
+	state.resize(get_solver_state_size());
+	if (save_solver_state_to_buffer(state.ptrw(), state.size()) != OK) {
+		return PackedByteArray();
+	}
+	return state;
+}
+
+Error EWBIK3D::restore_solver_state(const PackedByteArray &p_state) {
+	return restore_solver_state_from_buffer(p_state.ptr(), p_state.size());
+}
+
+void EWBIK3D::set_reachability_volume(const Ref<IKReachabilityVolume3D> &p_volume) {
+	if (reachability_volume == p_volume) {
+		return;
+	}
+	const Callable resolve = callable_mp(this, &EWBIK3D::_resolve_pin_reachability_effectors);
+	if (reachability_volume.is_valid() && reachability_volume->is_connected(SNAME("changed"), resolve)) {
+		reachability_volume->disconnect(SNAME("changed"), resolve);
+	}
+	reachability_volume = p_volume;
+	if (reachability_volume.is_valid()) {
+		reachability_volume->connect(SNAME("changed"), resolve);
+	}
+	_resolve_pin_reachability_effectors();
+}
+
+Ref<IKReachabilityVolume3D> EWBIK3D::get_reachability_volume() const {
+	return reachability_volume;
+}
+
+void EWBIK3D::set_clamp_unreachable_targets(bool p_enabled) {
+	clamp_unreachable_targets = p_enabled;
+}
+
+bool EWBIK3D::get_clamp_unreachable_targets() const {
+	return clamp_unreachable_targets;
+}
+
+Ref<IKReachabilityVolume3D> EWBIK3D::bake_reachability_volume(int32_t p_resolution, int32_t p_samples, int64_t p_seed) {
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, Ref<IKReachabilityVolume3D>());
+	if (is_dirty) {
+		_bone_list_changed();
+	}
+	Ref<IKReachabilityVolume3D> volume;
+	volume.instantiate();
+	for (const PinReachability &entry : pin_reachability) {
+		const Ref<IKBone3D> &tip = entry.bone;
+		const Ref<IKBoneSegment3D> &segment = entry.segment;
+		// Walk from the pinned tip up to the segment root; links are ordered root first.
+		Vector<IKReachabilityVolume3D::Link> links;
+		for (Ref<IKBone3D> bone = tip; bone.is_valid(); bone = bone->get_parent()) {
+			IKReachabilityVolume3D::Link link;
+			link.rest = skeleton->get_bone_rest(bone->get_bone_id());
+			link.constraint_frame = bone->get_constraint_orientation_transform()->get_transform();
+			link.bone_direction = bone->get_bone_direction_transform()->get_transform().basis;
+			link.constraint = bone->get_constraint();
+			links.insert(0, link);
+			if (bone == segment->get_root()) {
+				break;
+			}
 		}
+		volume->bake_effector(skeleton->get_bone_name(tip->get_bone_id()), links, p_resolution, p_samples, p_seed);
 	}
+	set_reachability_volume(volume);
+	return volume;
+}
+
+bool EWBIK3D::is_pin_target_reachable(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, pins.size(), false);
+	ERR_FAIL_COND_V(reachability_volume.is_null(), false);
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, false);
+	const StringName bone_name = get_pin_bone_name(p_pin_index);
+	const int32_t effector = reachability_volume->find_effector(bone_name);
+	ERR_FAIL_COND_V_MSG(effector == -1, false, vformat("No baked reachability volume for pin bone %s.", bone_name));
+	for (const PinReachability &entry : pin_reachability) {
+		if (skeleton->get_bone_name(entry.bone->get_bone_id()) != bone_name) {
+			continue;
+		}
+		// Query the target the next solve would use, without storing it.
+		const Transform3D *target_override = pin_target_overrides.getptr(bone_name);
+		const Transform3D target = target_override ? *target_override : entry.bone->get_pin()->resolve_target_global_transform(skeleton, this);
+		const Transform3D frame = _get_reachability_frame(entry.segment->get_root());
+		return reachability_volume->is_reachable(effector, frame.affine_inverse().xform(target.origin));
+	}
+	return false;
 }
 
 void EWBIK3D::_update_skeleton_bones_transform() {
+	IKSolverStats3D::PhaseScope write_back_scope(_get_stats_counters(), IKSolverStats3D::PHASE_WRITE_BACK);
 	for (int32_t bone_i = bone_list.size(); bone_i-- > 0;) {
 		Ref<IKBone3D> bone = bone_list[bone_i];
 		if (bone.is_null()) {
@@ -437,18 +774,568 @@ void EWBIK3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_stabilization_passes", "passes"), &EWBIK3D::set_stabilization_passes);
 	ClassDB::bind_method(D_METHOD("get_stabilization_passes"), &EWBIK3D::get_stabilization_passes);
 	ClassDB::bind_method(D_METHOD("set_effector_bone_name", "index", "name"), &EWBIK3D::set_pin_bone_name);
+	ClassDB::bind_method(D_METHOD("set_reachability_volume", "volume"), &EWBIK3D::set_reachability_volume);
+	ClassDB::bind_method(D_METHOD("get_reachability_volume"), &EWBIK3D::get_reachability_volume);
+	ClassDB::bind_method(D_METHOD("set_clamp_unreachable_targets", "enabled"), &EWBIK3D::set_clamp_unreachable_targets);
+	ClassDB::bind_method(D_METHOD("get_clamp_unreachable_targets"), &EWBIK3D::get_clamp_unreachable_targets);
+	ClassDB::bind_method(D_METHOD("bake_reachability_volume", "resolution", "samples", "seed"), &EWBIK3D::bake_reachability_volume, DEFVAL(32), DEFVAL(65536), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("is_pin_target_reachable", "index"), &EWBIK3D::is_pin_target_reachable);
+	ClassDB::bind_method(D_METHOD("set_pin_target_transform_override", "index", "transform"), &EWBIK3D::set_pin_target_transform_override);
+	ClassDB::bind_method(D_METHOD("clear_pin_target_transform_override", "index"), &EWBIK3D::clear_pin_target_transform_override);
+	ClassDB::bind_method(D_METHOD("clear_pin_target_transform_overrides"), &EWBIK3D::clear_pin_target_transform_overrides);
+	ClassDB::bind_method(D_METHOD("has_pin_target_transform_override", "index"), &EWBIK3D::has_pin_target_transform_override);
+	ClassDB::bind_method(D_METHOD("solve"), &EWBIK3D::solve);
+	ClassDB::bind_method(D_METHOD("get_pose_hash"), &EWBIK3D::get_pose_hash);
+	ClassDB::bind_method(D_METHOD("get_solver_state_size"), &EWBIK3D::get_solver_state_size);
+	ClassDB::bind_method(D_METHOD("save_solver_state"), &EWBIK3D::save_solver_state);
+	ClassDB::bind_method(D_METHOD("restore_solver_state", "state"), &EWBIK3D::restore_solver_state);
+	ClassDB::bind_method(D_METHOD("set_stats_enabled", "enabled"), &EWBIK3D::set_stats_enabled);
+	ClassDB::bind_method(D_METHOD("is_stats_enabled"), &EWBIK3D::is_stats_enabled);
+	ClassDB::bind_method(D_METHOD("get_stats"), &EWBIK3D::get_stats);
+	ClassDB::bind_static_method("EWBIK3D", D_METHOD("get_global_stats"), &EWBIK3D::get_global_stats);
+	ClassDB::bind_method(D_METHOD("get_memory_report"), &EWBIK3D::get_memory_report);
+	ClassDB::bind_static_method("EWBIK3D", D_METHOD("start_trace"), &EWBIK3D::start_trace);
+	ClassDB::bind_static_method("EWBIK3D", D_METHOD("stop_trace", "path"), &EWBIK3D::stop_trace, DEFVAL(String()));
+	ClassDB::bind_method(D_METHOD("set_solve_recording_frames", "frames"), &EWBIK3D::set_solve_recording_frames);
+	ClassDB::bind_method(D_METHOD("get_solve_recording_frames"), &EWBIK3D::get_solve_recording_frames);
+	ClassDB::bind_method(D_METHOD("dump_solve_recording"), &EWBIK3D::dump_solve_recording);
+	ClassDB::bind_method(D_METHOD("clear_solve_recording"), &EWBIK3D::clear_solve_recording);
+	ClassDB::bind_method(D_METHOD("start_target_recording"), &EWBIK3D::start_target_recording);
+	ClassDB::bind_method(D_METHOD("stop_target_recording"), &EWBIK3D::stop_target_recording);
+	ClassDB::bind_method(D_METHOD("is_target_recording"), &EWBIK3D::is_target_recording);
+	ClassDB::bind_method(D_METHOD("replay_target_recording", "recording", "tolerance"), &EWBIK3D::replay_target_recording, DEFVAL(0.0001f));
+	ClassDB::bind_method(D_METHOD("attach_frame_rings", "targets_name", "poses_name"), &EWBIK3D::attach_frame_rings);
+	ClassDB::bind_method(D_METHOD("detach_frame_rings"), &EWBIK3D::detach_frame_rings);
+	ClassDB::bind_method(D_METHOD("is_attached_to_frame_rings"), &EWBIK3D::is_attached_to_frame_rings);
+	ClassDB::bind_method(D_METHOD("set_approximate_math_enabled", "enabled"), &EWBIK3D::set_approximate_math_enabled);
+	ClassDB::bind_method(D_METHOD("is_approximate_math_enabled"), &EWBIK3D::is_approximate_math_enabled);
+	ClassDB::bind_method(D_METHOD("set_residual_history_enabled", "enabled"), &EWBIK3D::set_residual_history_enabled);
+	ClassDB::bind_method(D_METHOD("is_residual_history_enabled"), &EWBIK3D::is_residual_history_enabled);
+	ClassDB::bind_method(D_METHOD("set_residual_tolerance", "tolerance"), &EWBIK3D::set_residual_tolerance);
+	ClassDB::bind_method(D_METHOD("get_residual_tolerance"), &EWBIK3D::get_residual_tolerance);
+	ClassDB::bind_method(D_METHOD("get_pin_position_error", "index"), &EWBIK3D::get_pin_position_error);
+	ClassDB::bind_method(D_METHOD("get_pin_orientation_error", "index"), &EWBIK3D::get_pin_orientation_error);
+	ClassDB::bind_method(D_METHOD("is_pin_unreachable", "index"), &EWBIK3D::is_pin_unreachable);
+	ClassDB::bind_method(D_METHOD("is_pin_constraint_limited", "index"), &EWBIK3D::is_pin_constraint_limited);
+	ClassDB::bind_method(D_METHOD("get_pin_residual_history", "index"), &EWBIK3D::get_pin_residual_history);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "iterations_per_frame", PROPERTY_HINT_RANGE, "1,150,1,or_greater"), "set_iterations_per_frame", "get_iterations_per_frame");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "default_damp", PROPERTY_HINT_RANGE, "0.01,180.0,0.1,radians,exp", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), "set_default_damp", "get_default_damp");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "constraint_mode"), "set_constraint_mode", "get_constraint_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "ui_selected_bone", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NO_EDITOR), "set_ui_selected_bone", "get_ui_selected_bone");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "stabilization_passes"), "set_stabilization_passes", "get_stabilization_passes");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "reachability_volume", PROPERTY_HINT_RESOURCE_TYPE, "IKReachabilityVolume3D"), "set_reachability_volume", "get_reachability_volume");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "clamp_unreachable_targets"), "set_clamp_unreachable_targets", "get_clamp_unreachable_targets");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "stats_enabled"), "set_stats_enabled", "is_stats_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "solve_recording_frames", PROPERTY_HINT_RANGE, "0,600,1,or_greater"), "set_solve_recording_frames", "get_solve_recording_frames");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "approximate_math"), "set_approximate_math_enabled", "is_approximate_math_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "residual_history_enabled"), "set_residual_history_enabled", "is_residual_history_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "residual_tolerance", PROPERTY_HINT_RANGE, "0,1,0.001,or_greater"), "set_residual_tolerance", "get_residual_tolerance");
 }
 
 EWBIK3D::EWBIK3D() {
 }
 
+void EWBIK3D::set_stats_enabled(bool p_enabled) {
+	if (stats_enabled == p_enabled) {
+		return;
+	}
+	stats_enabled = p_enabled;
+	stats_current.clear();
+	stats_last_frame.clear();
+	if (stats_enabled) {
+		IKSolverStats3D::register_monitors();
+	}
+}
+
+bool EWBIK3D::is_stats_enabled() const {
+	return stats_enabled;
+}
+
+Dictionary EWBIK3D::get_stats() const {
+	return stats_last_frame.to_dictionary();
+}
+
+Dictionary EWBIK3D::get_global_stats() {
+	return IKSolverStats3D::get_global_stats();
+}
+
+Dictionary EWBIK3D::get_memory_report() const {
+	int64_t transform_node_bytes = 0;
+	int64_t heading_bytes = 0;
+	int64_t constraint_bytes = 0;
+	int64_t table_bytes = 0;
+	int64_t bone_bytes = 0;
+
+	if (godot_skeleton_transform.is_valid()) {
+		transform_node_bytes += sizeof(IKNode3D);
+	}
+	if (ik_origin.is_valid()) {
+		transform_node_bytes += sizeof(IKNode3D);
+	}
+	bone_bytes += int64_t(bone_damp.size()) * sizeof(float);
+	constraint_bytes += int64_t(joint_twist.size()) * sizeof(Vector2);
+	for (const Vector<Vector4> &cones : kusudama_open_cones) {
+		constraint_bytes += int64_t(cones.size()) * sizeof(Vector4);
+	}
+
+	// Damping tables are shared between bones, so each buffer is counted once.
+	HashSet<const float *> tables;
+	for (const Ref<IKBone3D> &bone : bone_list) {
+		if (bone.is_null()) {
+			continue;
+		}
+		bone_bytes += sizeof(IKBone3D);
+		// Bone, bone direction, constraint orientation and constraint twist transforms.
+		transform_node_bytes += 4 * sizeof(IKNode3D);
+		Ref<IKKusudama3D> constraint = bone->get_constraint();
+		if (constraint.is_valid()) {
+			constraint_bytes += sizeof(IKKusudama3D) + int64_t(constraint->get_open_cones().size()) * sizeof(IKLimitCone3D);
+		}
+		Ref<IKEffector3D> pin = bone->get_pin();
+		if (pin.is_valid()) {
+			bone_bytes += sizeof(IKEffector3D);
+			heading_bytes += pin->get_heading_memory();
+		}
+		for (const Vector<float> *table : { &bone->get_half_returnfullness_dampened(), &bone->get_cos_half_returnfullness_dampened() }) {
+			if (!table->is_empty() && !tables.has(table->ptr())) {
+				tables.insert(table->ptr());
+				table_bytes += int64_t(table->size()) * sizeof(float);
+			}
+		}
+	}
+
+	LocalVector<Ref<IKBoneSegment3D>> segments;
+	for (const Ref<IKBoneSegment3D> &segment : segmented_skeletons) {
+		if (segment.is_valid()) {
+			segments.push_back(segment);
+		}
+	}
+	for (uint32_t segment_i = 0; segment_i < segments.size(); segment_i++) {
+		const Ref<IKBoneSegment3D> segment = segments[segment_i];
+		bone_bytes += sizeof(IKBoneSegment3D);
+		heading_bytes += segment->get_heading_memory();
+		for (const Ref<IKBoneSegment3D> &child : segment->get_child_segments()) {
+			if (child.is_valid()) {
+				segments.push_back(child);
+			}
+		}
+	}
+
+	const int64_t total_bytes = transform_node_bytes + heading_bytes + constraint_bytes + table_bytes + bone_bytes;
+	Dictionary report;
+	report["transform_nodes"] = transform_node_bytes;
+	report["headings"] = heading_bytes;
+	report["constraints"] = constraint_bytes;
+	report["tables"] = table_bytes;
+	report["bones"] = bone_bytes;
+	report["total"] = total_bytes;
+	report["bone_count"] = int32_t(bone_list.size());
+	report["bytes_per_bone"] = bone_list.is_empty() ? 0.0 : double(total_bytes) / bone_list.size();
+	return report;
+}
+
+void EWBIK3D::set_solve_recording_frames(int32_t p_frames) {
+	ERR_FAIL_COND(p_frames < 0);
+	solve_recorder.set_capacity(p_frames);
+}
+
+int32_t EWBIK3D::get_solve_recording_frames() const {
+	return solve_recorder.get_capacity();
+}
+
+Ref<IKSolveTrace3D> EWBIK3D::dump_solve_recording() const {
+	Ref<IKSolveTrace3D> trace;
+	trace.instantiate();
+	trace->set_data(solve_recorder.serialize());
+	return trace;
+}
+
+void EWBIK3D::clear_solve_recording() {
+	solve_recorder.clear();
+}
+
+Error EWBIK3D::start_target_recording() {
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V_MSG(skeleton, ERR_UNCONFIGURED, "Target recording needs a skeleton.");
+	target_recording.instantiate();
+	target_recording->start(skeleton->get_bone_count(), pins.size());
+	return OK;
+}
+
+Ref<IKTargetRecording3D> EWBIK3D::stop_target_recording() {
+	Ref<IKTargetRecording3D> recording = target_recording;
+	target_recording.unref();
+	return recording;
+}
+
+bool EWBIK3D::is_target_recording() const {
+	return target_recording.is_valid();
+}
+
+void EWBIK3D::_record_target_frame() {
+	target_recording_pins.resize(pins.size());
+	for (int32_t pin_i = 0; pin_i < pins.size(); pin_i++) {
+		const Ref<IKBone3D> bone = pin_i < int32_t(pin_residual_states.size()) ? pin_residual_states[pin_i].bone : Ref<IKBone3D>();
+		target_recording_pins[pin_i] = bone.is_valid() ? bone->get_pin()->get_target_global_transform() : Transform3D();
+	}
+	target_recording->end_frame(target_recording_pins.ptr(), get_skeleton());
+}
+
+Dictionary EWBIK3D::replay_target_recording(const Ref<IKTargetRecording3D> &p_recording, float p_tolerance) {
+	Dictionary result;
+	ERR_FAIL_COND_V(p_recording.is_null(), result);
+	Skeleton3D *skeleton = get_skeleton();
+	ERR_FAIL_NULL_V(skeleton, result);
+	ERR_FAIL_COND_V_MSG(p_recording->get_bone_count() != skeleton->get_bone_count() || p_recording->get_pin_count() != pins.size(), result,
+			"The target recording was made on a different skeleton or pin list.");
+
+	// Replaying must not land in a recording of its own, and must leave the
+	// configuration, overrides and bone poses as it found them.
+	const Ref<IKTargetRecording3D> active_recording = target_recording;
+	target_recording.unref();
+	const HashMap<StringName, Transform3D> saved_overrides = pin_target_overrides;
+	const int32_t saved_iterations = iterations_per_frame;
+	const float saved_damp = default_damp;
+	const int32_t saved_stabilization_passes = stabilize_passes;
+
+	const int32_t bone_count = skeleton->get_bone_count();
+	LocalVector<Vector3> saved_positions;
+	LocalVector<Quaternion> saved_rotations;
+	LocalVector<Vector3> saved_scales;
+	saved_positions.resize(bone_count);
+	saved_rotations.resize(bone_count);
+	saved_scales.resize(bone_count);
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		saved_positions[bone_i] = skeleton->get_bone_pose_position(bone_i);
+		saved_rotations[bone_i] = skeleton->get_bone_pose_rotation(bone_i);
+		saved_scales[bone_i] = skeleton->get_bone_pose_scale(bone_i);
+	}
+	float max_position_error = 0.0f;
+	float max_rotation_error = 0.0f;
+	int32_t first_mismatched_frame = -1;
+	int32_t mismatched_frames = 0;
+	uint64_t solve_usec = 0;
+	for (int32_t frame_i = 0; frame_i < p_recording->get_frame_count(); frame_i++) {
+		iterations_per_frame = p_recording->get_frame_iterations(frame_i);
+		// Both setters rebuild the segments, so only call them on a change.
+		if (default_damp != p_recording->get_frame_default_damp(frame_i)) {
+			set_default_damp(p_recording->get_frame_default_damp(frame_i));
+		}
+		if (stabilize_passes != p_recording->get_frame_stabilization_passes(frame_i)) {
+			set_stabilization_passes(p_recording->get_frame_stabilization_passes(frame_i));
+		}
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			Vector3 position;
+			Quaternion rotation;
+			Vector3 scale;
+			p_recording->read_input_pose(frame_i, bone_i, position, rotation, scale);
+			skeleton->set_bone_pose_position(bone_i, position);
+			skeleton->set_bone_pose_rotation(bone_i, rotation);
+			skeleton->set_bone_pose_scale(bone_i, scale);
+		}
+		for (int32_t pin_i = 0; pin_i < pins.size(); pin_i++) {
+			pin_target_overrides[get_pin_bone_name(pin_i)] = p_recording->get_frame_pin_target(frame_i, pin_i);
+		}
+		const uint64_t start = OS::get_singleton()->get_ticks_usec();
+		solve();
+		solve_usec += OS::get_singleton()->get_ticks_usec() - start;
+
+		float frame_error = 0.0f;
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			Vector3 expected_position;
+			Quaternion expected_rotation;
+			p_recording->read_solved_pose(frame_i, bone_i, expected_position, expected_rotation);
+			const float position_error = skeleton->get_bone_pose_position(bone_i).distance_to(expected_position);
+			const float rotation_error = skeleton->get_bone_pose_rotation(bone_i).angle_to(expected_rotation);
+			max_position_error = MAX(max_position_error, position_error);
+			max_rotation_error = MAX(max_rotation_error, rotation_error);
+			frame_error = MAX(frame_error, MAX(position_error, rotation_error));
+		}
+		if (frame_error > p_tolerance) {
+			mismatched_frames++;
+			if (first_mismatched_frame == -1) {
+				first_mismatched_frame = frame_i;
+			}
+		}
+	}
+
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		skeleton->set_bone_pose_position(bone_i, saved_positions[bone_i]);
+		skeleton->set_bone_pose_rotation(bone_i, saved_rotations[bone_i]);
+		skeleton->set_bone_pose_scale(bone_i, saved_scales[bone_i]);
+	}
+	pin_target_overrides = saved_overrides;
+	iterations_per_frame = saved_iterations;
+	if (default_damp != saved_damp) {
+		set_default_damp(saved_damp);
+	}
+	if (stabilize_passes != saved_stabilization_passes) {
+		set_stabilization_passes(saved_stabilization_passes);
+	}
+	target_recording = active_recording;
+
+	result["frames"] = p_recording->get_frame_count();
+	result["matched"] = mismatched_frames == 0;
+	result["mismatched_frames"] = mismatched_frames;
+	result["first_mismatched_frame"] = first_mismatched_frame;
+	result["max_position_error"] = max_position_error;
+	result["max_rotation_error"] = max_rotation_error;
+	result["solve_usec"] = int64_t(solve_usec);
+	return result;
+}
+
+// Frames exchanged with the process on the other side of the rings, in
+// native byte order. Targets: the header, then per pin a rotation (x, y, z, w)
+// and an origin (x, y, z) relative to the skeleton, as seven floats. Poses:
+// the header, carrying the number of the target frame last applied, then the
+// local rotation (x, y, z, w) of every skeleton bone.
+struct EWBIK3D::FrameRingLink {
+	struct FrameHeader {
+		uint64_t frame = 0;
+		uint32_t count = 0;
+		uint32_t reserved = 0;
+	};
+
+	static constexpr uint32_t TARGET_FLOATS = 7;
+	static constexpr uint32_t POSE_FLOATS = 4;
+
+	IKCore::SharedMemory targets_memory;
+	IKCore::SharedMemory poses_memory;
+	IKCore::FrameRing targets;
+	IKCore::FrameRing poses;
+	LocalVector<uint8_t> buffer;
+	uint64_t last_target_frame = UINT64_MAX;
+};
+
+Error EWBIK3D::attach_frame_rings(const String &p_targets_name, const String &p_poses_name) {
+	detach_frame_rings();
+	FrameRingLink *link = memnew(FrameRingLink);
+	// Size 0 maps each object whole; attach() then checks it against the ring's own header.
+	if (!link->targets_memory.open(p_targets_name.utf8().get_data(), 0) || !link->poses_memory.open(p_poses_name.utf8().get_data(), 0)) {
+		memdelete(link);
+		ERR_FAIL_V_MSG(ERR_CANT_OPEN, vformat("Could not open the shared memory \"%s\" or \"%s\".", p_targets_name, p_poses_name));
+	}
+	if (link->targets.attach(link->targets_memory.get_memory(), link->targets_memory.get_size(), IKCore::FrameRing::SIDE_CONSUMER) != IKCore::FrameRing::RESULT_OK ||
+			link->poses.attach(link->poses_memory.get_memory(), link->poses_memory.get_size(), IKCore::FrameRing::SIDE_PRODUCER) != IKCore::FrameRing::RESULT_OK) {
+		memdelete(link);
+		ERR_FAIL_V_MSG(ERR_INVALID_DATA, "The shared memory does not hold a frame ring of this version.");
+	}
+	link->buffer.resize(MAX(link->targets.get_slot_capacity(), link->poses.get_slot_capacity()));
+	frame_ring_link = link;
+	return OK;
+}
+
+void EWBIK3D::detach_frame_rings() {
+	if (frame_ring_link) {
+		memdelete(frame_ring_link);
+		frame_ring_link = nullptr;
+	}
+}
+
+bool EWBIK3D::is_attached_to_frame_rings() const {
+	return frame_ring_link != nullptr;
+}
+
+void EWBIK3D::_poll_frame_ring_targets() {
+	FrameRingLink &link = *frame_ring_link;
+	uint32_t size = 0;
+	uint64_t sequence = 0;
+	IKCore::FrameRing::Result result = link.targets.pop_latest(link.buffer.ptr(), link.buffer.size(), &size, &sequence);
+	if (result == IKCore::FrameRing::RESULT_OVERRUN || result == IKCore::FrameRing::RESULT_TORN) {
+		// The ring has resynced to the producer, so one retry reads a current frame.
+		result = link.targets.pop_latest(link.buffer.ptr(), link.buffer.size(), &size, &sequence);
+	}
+	if (result != IKCore::FrameRing::RESULT_OK || size < sizeof(FrameRingLink::FrameHeader)) {
+		// Nothing new; the pins keep the targets of the last frame.
+		return;
+	}
+	FrameRingLink::FrameHeader header;
+	memcpy(&header, link.buffer.ptr(), sizeof(header));
+	const uint32_t pin_total = MIN(header.count, uint32_t(pins.size()));
+	ERR_FAIL_COND_MSG(size < sizeof(header) + pin_total * FrameRingLink::TARGET_FLOATS * sizeof(float), "A target frame is shorter than its pin count.");
+	const uint8_t *read = link.buffer.ptr() + sizeof(header);
+	for (uint32_t pin_i = 0; pin_i < pin_total; pin_i++, read += FrameRingLink::TARGET_FLOATS * sizeof(float)) {
+		float values[FrameRingLink::TARGET_FLOATS];
+		memcpy(values, read, sizeof(values));
+		const Quaternion rotation(values[0], values[1], values[2], values[3]);
+		if (rotation.length_squared() == 0.0f) {
+			continue;
+		}
+		pin_target_overrides[get_pin_bone_name(pin_i)] = Transform3D(Basis(rotation.normalized()), Vector3(values[4], values[5], values[6]));
+	}
+	link.last_target_frame = header.frame;
+}
+
+void EWBIK3D::_publish_frame_ring_pose() {
+	FrameRingLink &link = *frame_ring_link;
+	Skeleton3D *skeleton = get_skeleton();
+	FrameRingLink::FrameHeader header;
+	header.frame = link.last_target_frame;
+	header.count = skeleton->get_bone_count();
+	const uint32_t size = sizeof(header) + header.count * FrameRingLink::POSE_FLOATS * sizeof(float);
+	if (size > link.poses.get_slot_capacity()) {
+		ERR_PRINT_ONCE("The pose ring's slots are too small for this skeleton.");
+		return;
+	}
+	memcpy(link.buffer.ptr(), &header, sizeof(header));
+	uint8_t *write = link.buffer.ptr() + sizeof(header);
+	for (uint32_t bone_i = 0; bone_i < header.count; bone_i++, write += FrameRingLink::POSE_FLOATS * sizeof(float)) {
+		const Quaternion rotation = skeleton->get_bone_pose_rotation(bone_i);
+		const float values[FrameRingLink::POSE_FLOATS] = { float(rotation.x), float(rotation.y), float(rotation.z), float(rotation.w) };
+		memcpy(write, values, sizeof(values));
+	}
+	link.poses.push(link.buffer.ptr(), size);
+}
+
+Error EWBIK3D::start_trace() {
+	return IKTrace3D::start();
+}
+
+Error EWBIK3D::stop_trace(const String &p_path) {
+	IKTrace3D::stop();
+	if (p_path.is_empty()) {
+		return OK;
+	}
+	return IKTrace3D::save(p_path);
+}
+
+void EWBIK3D::_build_pin_residuals() {
+	pin_residuals.resize(pins.size());
+	pin_residual_states.resize(pins.size());
+	residual_history.clear();
+	residual_history_iterations = 0;
+	Skeleton3D *skeleton = get_skeleton();
+	for (int32_t pin_i = 0; pin_i < pins.size(); pin_i++) {
+		pin_residuals[pin_i] = PinResidual();
+		PinResidualState &state = pin_residual_states[pin_i];
+		state = PinResidualState();
+		const BoneId bone_id = skeleton->find_bone(get_pin_bone_name(pin_i));
+		for (PinReachability &entry : pin_reachability) {
+			if (entry.bone->get_bone_id() == bone_id) {
+				state.bone = entry.bone;
+				state.segment = entry.segment;
+				entry.pin_index = pin_i;
+				break;
+			}
+		}
+	}
+}
+
+void EWBIK3D::_measure_pin_residuals(int32_t p_iteration, bool p_record_history) {
+	for (uint32_t pin_i = 0; pin_i < pin_residuals.size(); pin_i++) {
+		const Ref<IKBone3D> &bone = pin_residual_states[pin_i].bone;
+		if (bone.is_null()) {
+			continue;
+		}
+		const Transform3D target = bone->get_pin()->get_target_global_transform();
+		const Transform3D tip = bone->get_bone_direction_global_pose();
+		PinResidual &residual = pin_residuals[pin_i];
+		pin_residual_states[pin_i].previous_position_error = residual.position_error;
+		residual.position_error = tip.origin.distance_to(target.origin);
+		const Quaternion difference = tip.basis.get_rotation_quaternion().inverse() * target.basis.get_rotation_quaternion();
+		residual.orientation_error = 2.0 * IKMath::acos(CLAMP(Math::abs(difference.w), 0.0, 1.0));
+		if (p_record_history) {
+			residual_history[pin_i * residual_history_iterations + p_iteration] = Vector2(residual.position_error, residual.orientation_error);
+		}
+	}
+}
+
+void EWBIK3D::_finish_pin_residuals() {
+	const int32_t iteration_count = get_iterations_per_frame();
+	for (uint32_t pin_i = 0; pin_i < pin_residuals.size(); pin_i++) {
+		PinResidualState &state = pin_residual_states[pin_i];
+		PinResidual &residual = pin_residuals[pin_i];
+		residual.flags = 0;
+		if (state.bone.is_null()) {
+			continue;
+		}
+		const bool limited = state.segment.is_valid() && state.segment->is_chain_constraint_limited();
+		if (limited) {
+			residual.flags |= PIN_RESIDUAL_CONSTRAINT_LIMITED;
+		}
+		// Still far away and no longer closing in, without a limit to blame.
+		const bool stalled = iteration_count > 1 && residual.position_error > residual_tolerance &&
+				state.previous_position_error - residual.position_error < residual.position_error * 0.01f;
+		if (state.target_clamped || (stalled && !limited)) {
+			residual.flags |= PIN_RESIDUAL_UNREACHABLE;
+		}
+		state.target_clamped = false;
+	}
+}
+
+void EWBIK3D::set_approximate_math_enabled(bool p_enabled) {
+	approximate_math = p_enabled;
+	// Rebuild so cached cone data follows the new policy. Damping tables are
+	// always built with precise math and come out the same either way.
+	set_dirty();
+}
+
+bool EWBIK3D::is_approximate_math_enabled() const {
+	return approximate_math;
+}
+
+void EWBIK3D::set_residual_history_enabled(bool p_enabled) {
+	residual_history_enabled = p_enabled;
+	if (!residual_history_enabled) {
+		residual_history.clear();
+		residual_history_iterations = 0;
+	}
+}
+
+bool EWBIK3D::is_residual_history_enabled() const {
+	return residual_history_enabled;
+}
+
+void EWBIK3D::set_residual_tolerance(float p_tolerance) {
+	residual_tolerance = MAX(p_tolerance, 0.0f);
+}
+
+float EWBIK3D::get_residual_tolerance() const {
+	return residual_tolerance;
+}
+
+const Vector2 *EWBIK3D::get_pin_residual_history_ptr(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, int32_t(pin_residuals.size()), nullptr);
+	if (!residual_history_iterations) {
+		return nullptr;
+	}
+	return residual_history.ptr() + p_pin_index * residual_history_iterations;
+}
+
+float EWBIK3D::get_pin_position_error(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, int32_t(pin_residuals.size()), 0.0f);
+	return pin_residuals[p_pin_index].position_error;
+}
+
+float EWBIK3D::get_pin_orientation_error(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, int32_t(pin_residuals.size()), 0.0f);
+	return pin_residuals[p_pin_index].orientation_error;
+}
+
+bool EWBIK3D::is_pin_unreachable(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, int32_t(pin_residuals.size()), false);
+	return pin_residuals[p_pin_index].flags & PIN_RESIDUAL_UNREACHABLE;
+}
+
+bool EWBIK3D::is_pin_constraint_limited(int32_t p_pin_index) const {
+	ERR_FAIL_INDEX_V(p_pin_index, int32_t(pin_residuals.size()), false);
+	return pin_residuals[p_pin_index].flags & PIN_RESIDUAL_CONSTRAINT_LIMITED;
+}
+
+PackedVector2Array EWBIK3D::get_pin_residual_history(int32_t p_pin_index) const {
+	PackedVector2Array history;
+	const Vector2 *entries = get_pin_residual_history_ptr(p_pin_index);
+	if (!entries) {
+		return history;
+	}
+	history.resize(residual_history_iterations);
+	memcpy(history.ptrw(), entries, sizeof(Vector2) * residual_history_iterations);
+	return history;
+}
+
 EWBIK3D::~EWBIK3D() {
+	detach_frame_rings();
 }
 
 float EWBIK3D::get_pin_motion_propagation_factor(int32_t p_effector_index) const {
@@ -658,6 +1545,45 @@ void EWBIK3D::_process_modification(double p_delta) {
 	if (!get_skeleton()) {
 		return;
 	}
+	IK_TRACE_SCOPE_INSTANCE("EWBIK3D::_process_modification", get_instance_id());
+	IKMath::PolicyScope math_policy(approximate_math ? IKMath::POLICY_APPROXIMATE : IKMath::POLICY_PRECISE);
+	const bool recording = solve_recorder.is_enabled();
+	IKSolveRecorder3D *previous_recorder = IKSolveRecorder3D::get_active();
+	if (unlikely(recording)) {
+		IKSolveRecorder3D::set_active(&solve_recorder);
+		solve_recorder.begin_frame();
+	}
+	if (unlikely(frame_ring_link)) {
+		_poll_frame_ring_targets();
+	}
+	const bool recording_targets = unlikely(target_recording.is_valid()) && target_recording->begin_frame(p_delta, get_iterations_per_frame(), get_default_damp(), stabilize_passes, pins.size(), get_skeleton());
+	if (unlikely(stats_enabled)) {
+		IKSolverStats3D::Counters *previous_active = IKSolverStats3D::get_active();
+		IKSolverStats3D::set_active(&stats_current);
+		const int64_t memory_before = IKSolverStats3D::get_tracked_memory();
+		_solve_frame();
+		stats_current.bytes_allocated += IKSolverStats3D::get_tracked_memory() - memory_before;
+		stats_current.solves++;
+		IKSolverStats3D::set_active(previous_active);
+		stats_last_frame = stats_current;
+		stats_current.clear();
+		IKSolverStats3D::add_to_global(stats_last_frame);
+	} else {
+		_solve_frame();
+	}
+	if (unlikely(recording)) {
+		solve_recorder.end_frame();
+		IKSolveRecorder3D::set_active(previous_recorder);
+	}
+	if (unlikely(recording_targets)) {
+		_record_target_frame();
+	}
+	if (unlikely(frame_ring_link)) {
+		_publish_frame_ring_pose();
+	}
+}
+
+void EWBIK3D::_solve_frame() {
 	if (!segmented_skeletons.size()) {
 		set_dirty();
 	}
@@ -681,14 +1607,31 @@ void EWBIK3D::_process_modification(double p_delta) {
 	if (!is_visible()) {
 		return;
 	}
-	for (int32_t i = 0; i < get_iterations_per_frame(); i++) {
+	const int32_t iteration_count = get_iterations_per_frame();
+	const bool record_history = residual_history_enabled && !pin_residuals.is_empty();
+	if (record_history) {
+		residual_history.resize(pin_residuals.size() * iteration_count);
+	}
+	residual_history_iterations = record_history ? iteration_count : 0;
+	for (int32_t i = 0; i < iteration_count; i++) {
+		if (unlikely(stats_enabled)) {
+			stats_current.iterations++;
+		}
+		if (unlikely(solve_recorder.is_enabled())) {
+			solve_recorder.set_iteration(i);
+		}
 		for (Ref<IKBoneSegment3D> segmented_skeleton : segmented_skeletons) {
 			if (segmented_skeleton.is_null()) {
 				continue;
 			}
-			segmented_skeleton->segment_solver(bone_damp, get_default_damp(), get_constraint_mode(), i, get_iterations_per_frame());
+			segmented_skeleton->segment_solver(bone_damp, get_default_damp(), get_constraint_mode(), i, iteration_count);
+		}
+		// The last two iterations tell whether the solver stalled.
+		if (record_history || i >= iteration_count - 2) {
+			_measure_pin_residuals(i, record_history);
 		}
 	}
+	_finish_pin_residuals();
 	_update_skeleton_bones_transform();
 }
 
@@ -992,11 +1935,15 @@ int32_t EWBIK3D::find_pin(String p_string) const {
 }
 
 void EWBIK3D::_bone_list_changed() {
+	IK_TRACE_SCOPE_INSTANCE("EWBIK3D::_bone_list_changed", get_instance_id());
 	Skeleton3D *skeleton = get_skeleton();
 	Vector<int32_t> roots = skeleton->get_parentless_bones();
 	if (roots.is_empty()) {
 		return;
 	}
+	if (unlikely(stats_enabled)) {
+		stats_current.rebuilds++;
+	}
 	bone_list.clear();
 	segmented_skeletons.clear();
 	for (BoneId root_bone_index : roots) {
@@ -1013,6 +1960,8 @@ void EWBIK3D::_bone_list_changed() {
 		segmented_skeleton->recursive_create_headings_arrays_for(segmented_skeleton);
 		segmented_skeletons.push_back(segmented_skeleton);
 	}
+	_build_pin_reachability();
+	_build_pin_residuals();
 	_update_ik_bones_transform();
 	for (Ref<IKBone3D> &ik_bone_3d : bone_list) {
 		ik_bone_3d->update_default_bone_direction_transform(skeleton);
@@ -34,8 +34,13 @@
 #include "core/math/transform_3d.h"
 #include "core/math/vector3.h"
 #include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
 #include "ik_bone_3d.h"
 #include "ik_effector_template_3d.h"
+#include "ik_reachability_volume_3d.h"
+#include "ik_solve_trace_3d.h"
+#include "ik_solver_stats_3d.h"
+#include "ik_target_recording_3d.h"
 #include "math/ik_node_3d.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/3d/skeleton_modifier_3d.h"
@@ -44,6 +49,20 @@ class ManyBoneIK3DState;
 class EWBIK3D : public SkeletonModifier3D {
 	GDCLASS(EWBIK3D, SkeletonModifier3D);
 
+public:
+	enum PinResidualFlags {
+		PIN_RESIDUAL_UNREACHABLE = 1 << 0,
+		PIN_RESIDUAL_CONSTRAINT_LIMITED = 1 << 1,
+	};
+
+	// How far one pin ended from its target after the last solved frame.
+	struct PinResidual {
+		float position_error = 0.0f;
+		float orientation_error = 0.0f; // Radians between the tip and target bases.
+		uint32_t flags = 0;
+	};
+
+private:
 	bool is_constraint_mode = false;
 	NodePath skeleton_path;
 	Vector<Ref<IKBoneSegment3D>> segmented_skeletons;
@@ -64,6 +83,59 @@ class EWBIK3D : public SkeletonModifier3D {
 	bool is_dirty = true;
 	NodePath skeleton_node_path = NodePath("..");
 	int32_t ui_selected_bone = -1, stabilize_passes = 0;
+	Ref<IKReachabilityVolume3D> reachability_volume;
+	bool clamp_unreachable_targets = true;
+	HashMap<StringName, Transform3D> pin_target_overrides;
+	IKSolveRecorder3D solve_recorder;
+	Ref<IKTargetRecording3D> target_recording;
+	LocalVector<Transform3D> target_recording_pins;
+	bool residual_history_enabled = false;
+	bool approximate_math = false;
+	float residual_tolerance = 0.01f;
+	struct PinResidualState {
+		Ref<IKBone3D> bone;
+		Ref<IKBoneSegment3D> segment;
+		float previous_position_error = INFINITY;
+		bool target_clamped = false;
+	};
+	LocalVector<PinResidual> pin_residuals;
+	LocalVector<PinResidualState> pin_residual_states;
+	// One entry per pinned bone, resolved when the skeleton is rebuilt so the
+	// per-frame target clamp never searches the segment tree.
+	struct PinReachability {
+		Ref<IKBone3D> bone;
+		Ref<IKBoneSegment3D> segment; // The segment whose tip is the pinned bone.
+		int32_t effector = -1; // Index in reachability_volume, -1 when it has no cells for this bone.
+		int32_t pin_index = -1; // Index in pin_residual_states.
+	};
+	LocalVector<PinReachability> pin_reachability;
+	// Iterations of the last solved frame, pin-major: (position error, orientation error).
+	LocalVector<Vector2> residual_history;
+	int32_t residual_history_iterations = 0;
+	bool stats_enabled = false;
+	IKSolverStats3D::Counters stats_current;
+	IKSolverStats3D::Counters stats_last_frame;
+	// Shared-memory rings another process feeds targets into and reads poses from.
+	struct FrameRingLink;
+	FrameRingLink *frame_ring_link = nullptr;
+
+	// Flat layout written by save_solver_state_to_buffer(): the header, one
+	// SolverBoneState per bone in bone_list order, one target per pinned bone,
+	// then one stabilization deviation per segment in depth-first order.
+	struct SolverStateHeader {
+		uint32_t version = 1;
+		uint32_t bone_count = 0;
+		uint32_t pinned_count = 0;
+		uint32_t segment_count = 0;
+	};
+
+	struct SolverBoneState {
+		Transform3D pose;
+		Vector3 skeleton_position;
+		Quaternion skeleton_rotation;
+		Vector3 skeleton_scale;
+		float cos_half_dampen = 1.0f;
+	};
 
 	void _on_timer_timeout();
 	void _update_ik_bones_transform();
@@ -78,6 +150,19 @@ class EWBIK3D : public SkeletonModifier3D {
 	void _bone_list_changed();
 	void _pose_updated();
 	void _update_ik_bone_pose(int32_t p_bone_idx);
+	void _build_pin_reachability();
+	void _resolve_pin_reachability_effectors();
+	SolverStateHeader _get_solver_state_header() const;
+	Transform3D _get_reachability_frame(const Ref<IKBone3D> &p_segment_root) const;
+	void _clamp_pin_target_to_reachable(const PinReachability &p_entry);
+	void _solve_frame();
+	void _record_target_frame();
+	void _poll_frame_ring_targets();
+	void _publish_frame_ring_pose();
+	void _build_pin_residuals();
+	void _measure_pin_residuals(int32_t p_iteration, bool p_record_history);
+	void _finish_pin_residuals();
+	_FORCE_INLINE_ IKSolverStats3D::Counters *_get_stats_counters() { return stats_enabled ? &stats_current : nullptr; }
 
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
@@ -147,6 +232,58 @@ public:
 	void set_kusudama_open_cone_count(int32_t p_constraint_index, int32_t p_count);
 	void set_kusudama_open_cone_center(int32_t p_constraint_index, int32_t p_index, Vector3 p_center);
 	void set_kusudama_open_cone_radius(int32_t p_constraint_index, int32_t p_index, float p_radius);
+	void set_reachability_volume(const Ref<IKReachabilityVolume3D> &p_volume);
+	Ref<IKReachabilityVolume3D> get_reachability_volume() const;
+	void set_clamp_unreachable_targets(bool p_enabled);
+	bool get_clamp_unreachable_targets() const;
+	Ref<IKReachabilityVolume3D> bake_reachability_volume(int32_t p_resolution = 32, int32_t p_samples = 65536, int64_t p_seed = 0);
+	bool is_pin_target_reachable(int32_t p_pin_index) const;
+	void set_pin_target_transform_override(int32_t p_pin_index, const Transform3D &p_transform);
+	void clear_pin_target_transform_override(int32_t p_pin_index);
+	void clear_pin_target_transform_overrides();
+	bool has_pin_target_transform_override(int32_t p_pin_index) const;
+	void solve();
+	int64_t get_pose_hash() const;
+	int64_t get_solver_state_size() const;
+	Error save_solver_state_to_buffer(uint8_t *r_buffer, int64_t p_size) const;
+	Error restore_solver_state_from_buffer(const uint8_t *p_buffer, int64_t p_size);
+	PackedByteArray save_solver_state() const;
+	Error restore_solver_state(const PackedByteArray &p_state);
+	void set_stats_enabled(bool p_enabled);
+	bool is_stats_enabled() const;
+	Dictionary get_stats() const;
+	static Dictionary get_global_stats();
+	Dictionary get_memory_report() const;
+	void set_solve_recording_frames(int32_t p_frames);
+	int32_t get_solve_recording_frames() const;
+	Ref<IKSolveTrace3D> dump_solve_recording() const;
+	void clear_solve_recording();
+	Error start_target_recording();
+	Ref<IKTargetRecording3D> stop_target_recording();
+	bool is_target_recording() const;
+	Dictionary replay_target_recording(const Ref<IKTargetRecording3D> &p_recording, float p_tolerance = 0.0001f);
+	Error attach_frame_rings(const String &p_targets_name, const String &p_poses_name);
+	void detach_frame_rings();
+	bool is_attached_to_frame_rings() const;
+	static Error start_trace();
+	static Error stop_trace(const String &p_path = String());
+	void set_approximate_math_enabled(bool p_enabled);
+	bool is_approximate_math_enabled() const;
+	void set_residual_history_enabled(bool p_enabled);
+	bool is_residual_history_enabled() const;
+	void set_residual_tolerance(float p_tolerance);
+	float get_residual_tolerance() const;
+	// Indexed by pin. Valid until the next rebuild of the segments.
+	const PinResidual *get_pin_residuals() const { return pin_residuals.ptr(); }
+	int32_t get_pin_residual_count() const { return pin_residuals.size(); }
+	// get_residual_history_iterations() entries for the pin, or null when history is disabled.
+	const Vector2 *get_pin_residual_history_ptr(int32_t p_pin_index) const;
+	int32_t get_residual_history_iterations() const { return residual_history_iterations; }
+	float get_pin_position_error(int32_t p_pin_index) const;
+	float get_pin_orientation_error(int32_t p_pin_index) const;
+	bool is_pin_unreachable(int32_t p_pin_index) const;
+	bool is_pin_constraint_limited(int32_t p_pin_index) const;
+	PackedVector2Array get_pin_residual_history(int32_t p_pin_index) const;
 	EWBIK3D();
 	~EWBIK3D();
 	void set_dirty();
@@ -0,0 +1,175 @@
+/**************************************************************************/
+/*  ik_approximate_math.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/math_funcs.h"
+#include "core/math/quaternion.h"
+#include "core/math/vector3.h"
+
+// Cheaper trigonometry for the solver's hot paths. The polynomials are the
+// single-precision minimax fits from Cephes, evaluated in double: shorter
+// than the full double kernels and free of divisions, with errors well below
+// the float precision the skeleton stores poses in. Maximum absolute errors,
+// measured against libm over the whole domain:
+//   sin, cos:   3e-9 (inputs within +-1e5 radians)
+//   asin, acos: 6e-9
+// Like IKDeterministicMath, every function is a fixed sequence of IEEE-754
+// operations, so results are also bit-identical across platforms.
+namespace IKApproximateMath {
+
+static constexpr double PIO2_HI = 1.57079632673412561417e+00;
+static constexpr double PIO2_LO = 6.07710050650619224932e-11;
+static constexpr double PIO2 = 1.57079632679489655800e+00;
+static constexpr double PI = 3.14159265358979311600e+00;
+static constexpr double INV_PIO2 = 6.36619772367581382433e-01;
+
+// Max error 3e-9 on [-pi/4, pi/4].
+inline double _kernel_sin(double p_r) {
+	const double z = p_r * p_r;
+	return p_r + (p_r * z) * (-1.6666654611e-1 + z * (8.3321608736e-3 + z * -1.9515295891e-4));
+}
+
+// Max error 3e-9 on [-pi/4, pi/4].
+inline double _kernel_cos(double p_r) {
+	const double z = p_r * p_r;
+	return (1.0 - 0.5 * z) + (z * z) * (4.166664568298827e-2 + z * (-1.388731625493765e-3 + z * 2.443315711809948e-5));
+}
+
+inline int64_t _reduce(double p_x, double &r_r) {
+	const double k = Math::floor(p_x * INV_PIO2 + 0.5);
+	r_r = (p_x - k * PIO2_HI) - k * PIO2_LO;
+	return int64_t(k);
+}
+
+inline double sin(double p_x) {
+	double r;
+	switch (_reduce(p_x, r) & 3) {
+		case 0:
+			return _kernel_sin(r);
+		case 1:
+			return _kernel_cos(r);
+		case 2:
+			return -_kernel_sin(r);
+		default:
+			return -_kernel_cos(r);
+	}
+}
+
+inline double cos(double p_x) {
+	double r;
+	switch (_reduce(p_x, r) & 3) {
+		case 0:
+			return _kernel_cos(r);
+		case 1:
+			return -_kernel_sin(r);
+		case 2:
+			return -_kernel_cos(r);
+		default:
+			return _kernel_sin(r);
+	}
+}
+
+// asin(sqrt(z)) / sqrt(z) - 1 for z in [0, 0.25].
+inline double _asin_poly(double p_z) {
+	return p_z * (1.6666752422e-1 + p_z * (7.4953002686e-2 + p_z * (4.5470025998e-2 + p_z * (2.4181311049e-2 + p_z * 4.2163199048e-2))));
+}
+
+inline double asin(double p_x) {
+	const double x = CLAMP(p_x, -1.0, 1.0);
+	if (x >= -0.5 && x <= 0.5) {
+		return x + x * _asin_poly(x * x);
+	}
+	const double z = (1.0 - (x < 0.0 ? -x : x)) * 0.5;
+	const double s = Math::sqrt(z);
+	const double result = PIO2 - 2.0 * (s + s * _asin_poly(z));
+	return x < 0.0 ? -result : result;
+}
+
+inline double acos(double p_x) {
+	const double x = CLAMP(p_x, -1.0, 1.0);
+	if (x >= -0.5 && x <= 0.5) {
+		return PIO2 - (x + x * _asin_poly(x * x));
+	}
+	const double z = (1.0 - (x < 0.0 ? -x : x)) * 0.5;
+	const double s = Math::sqrt(z);
+	const double half = s + s * _asin_poly(z);
+	return x < 0.0 ? PI - 2.0 * half : 2.0 * half;
+}
+
+inline Quaternion axis_angle(const Vector3 &p_axis, double p_angle) {
+	const double length = p_axis.length();
+	if (length == 0.0) {
+		return Quaternion(0, 0, 0, 0);
+	}
+	const double s = sin(p_angle * 0.5) / length;
+	return Quaternion(p_axis.x * s, p_axis.y * s, p_axis.z * s, cos(p_angle * 0.5));
+}
+
+inline double get_angle(const Quaternion &p_quaternion) {
+	return 2.0 * acos(p_quaternion.w);
+}
+
+inline Quaternion slerp(const Quaternion &p_from, const Quaternion &p_to, double p_weight) {
+	double cosom = double(p_from.x) * p_to.x + double(p_from.y) * p_to.y + double(p_from.z) * p_to.z + double(p_from.w) * p_to.w;
+	Quaternion to = p_to;
+	if (cosom < 0.0) {
+		cosom = -cosom;
+		to = -to;
+	}
+	double scale0 = 1.0 - p_weight;
+	double scale1 = p_weight;
+	if ((1.0 - cosom) > CMP_EPSILON) {
+		const double omega = acos(cosom);
+		const double inverse_sinom = 1.0 / sin(omega);
+		scale0 = sin((1.0 - p_weight) * omega) * inverse_sinom;
+		scale1 = sin(p_weight * omega) * inverse_sinom;
+	}
+	return Quaternion(scale0 * p_from.x + scale1 * to.x, scale0 * p_from.y + scale1 * to.y, scale0 * p_from.z + scale1 * to.z, scale0 * p_from.w + scale1 * to.w);
+}
+
+// Swing-twist by projecting the rotation's axis onto p_axis, without the
+// interval bookkeeping of the precise path. Exact up to rounding away from
+// the singular half-turn swing, where the twist falls back to identity.
+inline void swing_twist(const Quaternion &p_rotation, const Vector3 &p_axis, Quaternion &r_swing, Quaternion &r_twist) {
+	const Vector3 axis = p_axis.normalized();
+	const Vector3 projection = axis * axis.dot(Vector3(p_rotation.x, p_rotation.y, p_rotation.z));
+	const double length_squared = projection.length_squared() + double(p_rotation.w) * p_rotation.w;
+	if (length_squared < CMP_EPSILON2) {
+		r_twist = Quaternion();
+		r_swing = p_rotation;
+		return;
+	}
+	const double inverse_length = 1.0 / Math::sqrt(length_squared);
+	r_twist = Quaternion(projection.x * inverse_length, projection.y * inverse_length, projection.z * inverse_length, p_rotation.w * inverse_length);
+	r_swing = p_rotation * r_twist.inverse();
+}
+
+} // namespace IKApproximateMath
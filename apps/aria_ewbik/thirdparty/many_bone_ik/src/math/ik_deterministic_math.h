@@ -0,0 +1,336 @@
+/**************************************************************************/
+/*  ik_deterministic_math.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/math_funcs.h"
+#include "core/math/quaternion.h"
+#include "core/math/vector3.h"
+#include "ik_approximate_math.h"
+
+#include <cmath>
+#include <cstdint>
+
+// Portable elementary functions for the solver. Every function is a fixed
+// sequence of IEEE-754 double additions, multiplications, divisions, square
+// roots and exact power-of-two scalings, so the results are bit-identical on
+// any conforming platform as long as the compiler does not contract them into
+// fused multiply-adds (deterministic builds use -ffp-contract=off). Kernels
+// and constants follow fdlibm.
+namespace IKDeterministicMath {
+
+static constexpr double PIO2_HI = 1.57079632673412561417e+00;
+static constexpr double PIO2_LO = 6.07710050650619224932e-11;
+static constexpr double PIO2 = 1.57079632679489655800e+00;
+static constexpr double PI = 3.14159265358979311600e+00;
+static constexpr double INV_PIO2 = 6.36619772367581382433e-01;
+
+inline double _kernel_sin(double p_r) {
+	const double z = p_r * p_r;
+	const double poly = -1.66666666666666324348e-01 + z * (8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06 + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10))));
+	return p_r + (p_r * z) * poly;
+}
+
+inline double _kernel_cos(double p_r) {
+	const double z = p_r * p_r;
+	const double poly = 4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11))));
+	return (1.0 - 0.5 * z) + (z * z) * poly;
+}
+
+// Cody-Waite reduction to [-pi/4, pi/4]; returns the quadrant.
+inline int64_t _reduce(double p_x, double &r_r) {
+	const double k = Math::floor(p_x * INV_PIO2 + 0.5);
+	r_r = (p_x - k * PIO2_HI) - k * PIO2_LO;
+	return int64_t(k);
+}
+
+inline double sin(double p_x) {
+	double r;
+	switch (_reduce(p_x, r) & 3) {
+		case 0:
+			return _kernel_sin(r);
+		case 1:
+			return _kernel_cos(r);
+		case 2:
+			return -_kernel_sin(r);
+		default:
+			return -_kernel_cos(r);
+	}
+}
+
+inline double cos(double p_x) {
+	double r;
+	switch (_reduce(p_x, r) & 3) {
+		case 0:
+			return _kernel_cos(r);
+		case 1:
+			return -_kernel_sin(r);
+		case 2:
+			return -_kernel_cos(r);
+		default:
+			return _kernel_sin(r);
+	}
+}
+
+inline double _asin_ratio(double p_z) {
+	const double p = p_z * (1.66666666666666657415e-01 + p_z * (-3.25565818622400915405e-01 + p_z * (2.01212532134862925881e-01 + p_z * (-4.00555345006794114027e-02 + p_z * (7.91534994289814532176e-04 + p_z * 3.47933107596021167570e-05)))));
+	const double q = 1.0 + p_z * (-2.40339491173441421878e+00 + p_z * (2.02094576023350569471e+00 + p_z * (-6.88283971605453293030e-01 + p_z * 7.70381505559019352791e-02)));
+	return p / q;
+}
+
+inline double asin(double p_x) {
+	const double x = CLAMP(p_x, -1.0, 1.0);
+	if (x >= -0.5 && x <= 0.5) {
+		return x + x * _asin_ratio(x * x);
+	}
+	const double z = (1.0 - (x < 0.0 ? -x : x)) * 0.5;
+	const double s = Math::sqrt(z);
+	const double result = PIO2 - 2.0 * (s + s * _asin_ratio(z));
+	return x < 0.0 ? -result : result;
+}
+
+inline double acos(double p_x) {
+	const double x = CLAMP(p_x, -1.0, 1.0);
+	if (x >= -0.5 && x <= 0.5) {
+		return PIO2 - (x + x * _asin_ratio(x * x));
+	}
+	const double z = (1.0 - (x < 0.0 ? -x : x)) * 0.5;
+	const double s = Math::sqrt(z);
+	const double half = s + s * _asin_ratio(z);
+	return x < 0.0 ? PI - 2.0 * half : 2.0 * half;
+}
+
+static constexpr double LN2_HI = 6.93147180369123816490e-01;
+static constexpr double LN2_LO = 1.90821492927058770002e-10;
+static constexpr double INV_LN2 = 1.44269504088896338700e+00;
+
+inline double exp(double p_x) {
+	if (p_x > 709.0) {
+		return INFINITY;
+	}
+	if (p_x < -745.0) {
+		return 0.0;
+	}
+	const double k = Math::floor(p_x * INV_LN2 + 0.5);
+	const double hi = p_x - k * LN2_HI;
+	const double lo = k * LN2_LO;
+	const double r = hi - lo;
+	const double t = r * r;
+	const double c = r - t * (1.66666666666666019037e-01 + t * (-2.77777777770155933842e-03 + t * (6.61375632143793436117e-05 + t * (-1.65339022054652515390e-06 + t * 4.13813679705723846039e-08))));
+	return std::ldexp(1.0 - ((lo - (r * c) / (2.0 - c)) - hi), int(k));
+}
+
+inline double log(double p_x) {
+	if (!(p_x > 0.0)) {
+		return p_x == 0.0 ? -INFINITY : NAN;
+	}
+	if (p_x == INFINITY) {
+		return p_x;
+	}
+	// x = 2^k * m with m in [sqrt(2)/2, sqrt(2)), then log(1 + f) for f = m - 1.
+	int exponent;
+	double m = std::frexp(p_x, &exponent);
+	if (m < Math::SQRT12) {
+		m *= 2.0;
+		exponent--;
+	}
+	const double k = exponent;
+	const double f = m - 1.0;
+	const double s = f / (2.0 + f);
+	const double z = s * s;
+	const double w = z * z;
+	const double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+	const double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+	const double hfsq = 0.5 * f * f;
+	return k * LN2_HI - ((hfsq - (s * (hfsq + (t1 + t2)) + k * LN2_LO)) - f);
+}
+
+// Non-negative bases only, which is all the solver needs. Not correctly
+// rounded like libm, but the same on every platform.
+inline double pow(double p_base, double p_exponent) {
+	if (p_exponent == 0.0) {
+		return 1.0;
+	}
+	if (p_base == 0.0) {
+		return p_exponent > 0.0 ? 0.0 : INFINITY;
+	}
+	return exp(p_exponent * log(p_base));
+}
+
+inline Quaternion axis_angle(const Vector3 &p_axis, double p_angle) {
+	const double length = p_axis.length();
+	if (length == 0.0) {
+		return Quaternion(0, 0, 0, 0);
+	}
+	const double s = sin(p_angle * 0.5) / length;
+	return Quaternion(p_axis.x * s, p_axis.y * s, p_axis.z * s, cos(p_angle * 0.5));
+}
+
+inline double get_angle(const Quaternion &p_quaternion) {
+	return 2.0 * acos(p_quaternion.w);
+}
+
+inline Quaternion slerp(const Quaternion &p_from, const Quaternion &p_to, double p_weight) {
+	double cosom = double(p_from.x) * p_to.x + double(p_from.y) * p_to.y + double(p_from.z) * p_to.z + double(p_from.w) * p_to.w;
+	Quaternion to = p_to;
+	if (cosom < 0.0) {
+		cosom = -cosom;
+		to = -to;
+	}
+	double scale0 = 1.0 - p_weight;
+	double scale1 = p_weight;
+	if ((1.0 - cosom) > CMP_EPSILON) {
+		const double omega = acos(cosom);
+		const double sinom = sin(omega);
+		scale0 = sin((1.0 - p_weight) * omega) / sinom;
+		scale1 = sin(p_weight * omega) / sinom;
+	}
+	return Quaternion(scale0 * p_from.x + scale1 * to.x, scale0 * p_from.y + scale1 * to.y, scale0 * p_from.z + scale1 * to.z, scale0 * p_from.w + scale1 * to.w);
+}
+
+// FNV-1a over the raw bits, for comparing poses across machines.
+static constexpr uint64_t HASH_BASIS = 0xcbf29ce484222325ull;
+
+inline uint64_t hash_bits(const void *p_data, size_t p_size, uint64_t p_hash = HASH_BASIS) {
+	const uint8_t *bytes = static_cast<const uint8_t *>(p_data);
+	for (size_t byte_i = 0; byte_i < p_size; byte_i++) {
+		p_hash ^= bytes[byte_i];
+		p_hash *= 0x100000001b3ull;
+	}
+	return p_hash;
+}
+
+} // namespace IKDeterministicMath
+
+// Solver entry points for the functions above. Builds with
+// many_bone_ik_deterministic=yes use the portable versions; other builds keep
+// the platform's libm, which is faster but may differ in the last bit. Either
+// can be swapped for IKApproximateMath per thread with PolicyScope, which
+// EWBIK3D does while it solves with approximate_math enabled.
+namespace IKMath {
+
+enum Policy {
+	POLICY_PRECISE,
+	POLICY_APPROXIMATE,
+};
+
+inline thread_local Policy current_policy = POLICY_PRECISE;
+
+inline Policy get_policy() {
+	return current_policy;
+}
+
+struct PolicyScope {
+	Policy previous;
+	explicit PolicyScope(Policy p_policy) :
+			previous(current_policy) {
+		current_policy = p_policy;
+	}
+	~PolicyScope() {
+		current_policy = previous;
+	}
+};
+
+inline double sin(double p_x) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::sin(p_x);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::sin(p_x);
+#else
+	return Math::sin(p_x);
+#endif
+}
+
+inline double cos(double p_x) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::cos(p_x);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::cos(p_x);
+#else
+	return Math::cos(p_x);
+#endif
+}
+
+inline double acos(double p_x) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::acos(p_x);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::acos(p_x);
+#else
+	return Math::acos(p_x);
+#endif
+}
+
+// No approximate variant; the solver only raises powers when building tables.
+inline double pow(double p_base, double p_exponent) {
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::pow(p_base, p_exponent);
+#else
+	return Math::pow(p_base, p_exponent);
+#endif
+}
+
+inline Quaternion axis_angle(const Vector3 &p_axis, double p_angle) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::axis_angle(p_axis, p_angle);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::axis_angle(p_axis, p_angle);
+#else
+	return Quaternion(p_axis, p_angle);
+#endif
+}
+
+inline double get_angle(const Quaternion &p_quaternion) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::get_angle(p_quaternion);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::get_angle(p_quaternion);
+#else
+	return p_quaternion.get_angle();
+#endif
+}
+
+inline Quaternion slerp(const Quaternion &p_from, const Quaternion &p_to, double p_weight) {
+	if (unlikely(current_policy == POLICY_APPROXIMATE)) {
+		return IKApproximateMath::slerp(p_from, p_to, p_weight);
+	}
+#ifdef MANY_BONE_IK_DETERMINISTIC
+	return IKDeterministicMath::slerp(p_from, p_to, p_weight);
+#else
+	return p_from.slerp(p_to, p_weight);
+#endif
+}
+
+} // namespace IKMath
@@ -33,6 +33,7 @@
 #include "core/math/math_funcs.h"
 #include "core/math/quaternion.h"
 #include "core/math/vector3.h"
+#include "ik_deterministic_math.h"
 
 /**
  * Interval Arithmetic Library for Godot Engine
@@ -164,7 +165,7 @@ struct Interval {
 	Interval sin() const {
 		// Simplified sin for small intervals
 		if (width() <= Math::PI) {
-			return Interval(Math::sin(lower), Math::sin(upper));
+			return Interval(IKMath::sin(lower), IKMath::sin(upper));
 		}
 		return Interval(-1, 1); // Full range for large intervals
 	}
@@ -172,7 +173,7 @@ struct Interval {
 	Interval cos() const {
 		// Simplified cos for small intervals
 		if (width() <= Math::PI) {
-			return Interval(Math::cos(upper), Math::cos(lower));
+			return Interval(IKMath::cos(upper), IKMath::cos(lower));
 		}
 		return Interval(-1, 1); // Full range for large intervals
 	}
@@ -30,6 +30,8 @@
 
 #include "qcp.h"
 
+#include "ik_trace_3d.h"
+
 QuaternionCharacteristicPolynomial::QuaternionCharacteristicPolynomial(double p_evec_prec) {
 	eigenvector_precision = p_evec_prec;
 }
@@ -328,7 +330,6 @@ Vector3 QuaternionCharacteristicPolynomial::move_to_weighted_center(PackedVector
 }
 
 void QuaternionCharacteristicPolynomial::inner_product(PackedVector3Array &r_coords1, PackedVector3Array &r_coords2) {
-	Vector3 weighted_coord1, weighted_coord2;
 	double sum_of_squares1 = 0, sum_of_squares2 = 0;
 
 	sum_xx = 0;
@@ -344,30 +345,35 @@ void QuaternionCharacteristicPolynomial::inner_product(PackedVector3Array &r_coo
 	bool weight_is_empty = weight.is_empty();
 	int size = r_coords1.size();
 
+	// Every term is widened to double and added one point at a time in index
+	// order, with each dot product spelled out as ((x + y) + z), so the
+	// reduction is the same sequence of operations on every build.
 	for (int i = 0; i < size; i++) {
-		if (!weight_is_empty) {
-			weighted_coord1 = weight[i] * r_coords1[i];
-			sum_of_squares1 += weighted_coord1.dot(r_coords1[i]);
-		} else {
-			weighted_coord1 = r_coords1[i];
-			sum_of_squares1 += weighted_coord1.dot(weighted_coord1);
-		}
-
-		weighted_coord2 = r_coords2[i];
+		const double w = weight_is_empty ? 1.0 : weight[i];
+		const double x1 = r_coords1[i].x;
+		const double y1 = r_coords1[i].y;
+		const double z1 = r_coords1[i].z;
+		const double x2 = r_coords2[i].x;
+		const double y2 = r_coords2[i].y;
+		const double z2 = r_coords2[i].z;
+		const double wx1 = w * x1;
+		const double wy1 = w * y1;
+		const double wz1 = w * z1;
 
-		sum_of_squares2 += weight_is_empty ? weighted_coord2.dot(weighted_coord2) : (weight[i] * weighted_coord2.dot(weighted_coord2));
+		sum_of_squares1 = sum_of_squares1 + ((wx1 * x1 + wy1 * y1) + wz1 * z1);
+		sum_of_squares2 = sum_of_squares2 + w * ((x2 * x2 + y2 * y2) + z2 * z2);
 
-		sum_xx += (weighted_coord1.x * weighted_coord2.x);
-		sum_xy += (weighted_coord1.x * weighted_coord2.y);
-		sum_xz += (weighted_coord1.x * weighted_coord2.z);
+		sum_xx = sum_xx + wx1 * x2;
+		sum_xy = sum_xy + wx1 * y2;
+		sum_xz = sum_xz + wx1 * z2;
 
-		sum_yx += (weighted_coord1.y * weighted_coord2.x);
-		sum_yy += (weighted_coord1.y * weighted_coord2.y);
-		sum_yz += (weighted_coord1.y * weighted_coord2.z);
+		sum_yx = sum_yx + wy1 * x2;
+		sum_yy = sum_yy + wy1 * y2;
+		sum_yz = sum_yz + wy1 * z2;
 
-		sum_zx += (weighted_coord1.z * weighted_coord2.x);
-		sum_zy += (weighted_coord1.z * weighted_coord2.y);
-		sum_zz += (weighted_coord1.z * weighted_coord2.z);
+		sum_zx = sum_zx + wz1 * x2;
+		sum_zy = sum_zy + wz1 * y2;
+		sum_zz = sum_zz + wz1 * z2;
 	}
 
 	double initial_eigenvalue = (sum_of_squares1 + sum_of_squares2) * 0.5;
@@ -548,6 +554,7 @@ Array QuaternionCharacteristicPolynomial::weighted_superpose(PackedVector3Array
 		PackedVector3Array p_target,
 		Vector<double> p_weight, bool p_translate,
 		double p_precision) {
+	IK_TRACE_SCOPE("QCP::weighted_superpose");
 	QuaternionCharacteristicPolynomial qcp(p_precision);
 
 	// Enhanced input validation
@@ -0,0 +1,208 @@
+/**************************************************************************/
+/*  test_ewbik_fixtures.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/random_pcg.h"
+#include "modules/many_bone_ik/src/many_bone_ik_3d.h"
+#include "scene/3d/skeleton_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/window.h"
+#include "tests/test_macros.h"
+
+namespace TestEWBIKFixtures {
+
+// A four bone vertical arm (Root, UpperArm, LowerArm, Hand), one unit per bone,
+// with an EWBIK3D pinned at the hand. Call free_arm() when done.
+struct ArmRig {
+	Skeleton3D *skeleton = nullptr;
+	EWBIK3D *ik = nullptr;
+};
+
+inline ArmRig create_arm(bool p_use_rotation = false) {
+	ArmRig rig;
+	rig.skeleton = memnew(Skeleton3D);
+	const char *names[] = { "Root", "UpperArm", "LowerArm", "Hand" };
+	for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+		rig.skeleton->add_bone(names[bone_i]);
+		if (bone_i > 0) {
+			rig.skeleton->set_bone_parent(bone_i, bone_i - 1);
+			rig.skeleton->set_bone_rest(bone_i, Transform3D(Basis(), Vector3(0, 1, 0)));
+		}
+	}
+	rig.skeleton->reset_bone_poses();
+	SceneTree::get_singleton()->get_root()->add_child(rig.skeleton);
+
+	rig.ik = memnew(EWBIK3D);
+	rig.skeleton->add_child(rig.ik);
+	rig.ik->set_pin_count(1);
+	rig.ik->set_pin_bone_name(0, "Hand");
+	rig.ik->set_pin_direction_priorities(0, p_use_rotation ? Vector3(0.2, 0.0, 0.2) : Vector3());
+	rig.ik->set_iterations_per_frame(10);
+	return rig;
+}
+
+inline void free_arm(ArmRig &r_rig) {
+	memdelete(r_rig.skeleton);
+	r_rig.skeleton = nullptr;
+	r_rig.ik = nullptr;
+}
+
+// Limits each bone below the root to one open cone around its rest direction
+// and a twist range, so targets off to the side hold the arm at its limits.
+inline void constrain_arm(ArmRig &r_rig, real_t p_cone_radius = 0.8, const Vector2 &p_twist = Vector2(-0.3, 0.6)) {
+	const char *bone_names[] = { "UpperArm", "LowerArm", "Hand" };
+	for (const char *bone_name : bone_names) {
+		const int32_t constraint_i = r_rig.ik->get_constraint_count();
+		r_rig.ik->add_constraint();
+		r_rig.ik->set_constraint_name_at_index(constraint_i, bone_name);
+		r_rig.ik->set_kusudama_open_cone_count(constraint_i, 1);
+		r_rig.ik->set_kusudama_open_cone(constraint_i, 0, Vector3(0, 1, 0), p_cone_radius);
+		r_rig.ik->set_joint_twist(constraint_i, p_twist);
+	}
+}
+
+inline Vector3 get_hand_position(const ArmRig &p_rig) {
+	return p_rig.skeleton->get_bone_global_pose(p_rig.skeleton->find_bone("Hand")).origin;
+}
+
+// A skeleton built from a parent list, with an EWBIK3D pinned at the given bones.
+// Every bone sits p_bone_length above its parent, fanned out a little so
+// siblings do not overlap. Call free_rig() when done.
+struct Rig {
+	Skeleton3D *skeleton = nullptr;
+	EWBIK3D *ik = nullptr;
+	LocalVector<int32_t> pinned_bones;
+};
+
+inline Rig create_rig(const LocalVector<int32_t> &p_parents, const LocalVector<int32_t> &p_pinned_bones, int32_t p_iterations = 10) {
+	Rig rig;
+	rig.skeleton = memnew(Skeleton3D);
+	LocalVector<int32_t> child_counts;
+	child_counts.resize(p_parents.size());
+	for (uint32_t bone_i = 0; bone_i < p_parents.size(); bone_i++) {
+		child_counts[bone_i] = 0;
+		rig.skeleton->add_bone(vformat("Bone%d", bone_i));
+	}
+	for (uint32_t bone_i = 1; bone_i < p_parents.size(); bone_i++) {
+		const int32_t parent = p_parents[bone_i];
+		rig.skeleton->set_bone_parent(bone_i, parent);
+		const real_t fan = 0.3 * child_counts[parent]++;
+		rig.skeleton->set_bone_rest(bone_i, Transform3D(Basis(Vector3(0, 0, 1), fan), Vector3(0, 0.5, 0)));
+	}
+	rig.skeleton->reset_bone_poses();
+	SceneTree::get_singleton()->get_root()->add_child(rig.skeleton);
+
+	rig.ik = memnew(EWBIK3D);
+	rig.skeleton->add_child(rig.ik);
+	rig.ik->set_pin_count(p_pinned_bones.size());
+	for (uint32_t pin_i = 0; pin_i < p_pinned_bones.size(); pin_i++) {
+		rig.ik->set_pin_bone_name(pin_i, rig.skeleton->get_bone_name(p_pinned_bones[pin_i]));
+	}
+	rig.ik->set_iterations_per_frame(p_iterations);
+	rig.pinned_bones = p_pinned_bones;
+	return rig;
+}
+
+inline void free_rig(Rig &r_rig) {
+	memdelete(r_rig.skeleton);
+	r_rig.skeleton = nullptr;
+	r_rig.ik = nullptr;
+}
+
+inline Rig create_chain_rig(int32_t p_bone_count) {
+	LocalVector<int32_t> parents;
+	for (int32_t bone_i = 0; bone_i < p_bone_count; bone_i++) {
+		parents.push_back(bone_i - 1);
+	}
+	LocalVector<int32_t> pins;
+	pins.push_back(p_bone_count - 1);
+	return create_rig(parents, pins);
+}
+
+// Hips, a four bone spine with neck and head, two four bone arms from the
+// chest and two four bone legs from the hips: 22 bones, five pins.
+inline Rig create_humanoid_rig() {
+	LocalVector<int32_t> parents;
+	parents.push_back(-1); // Hips.
+	for (int32_t bone_i = 0; bone_i < 5; bone_i++) {
+		parents.push_back(bone_i); // Spine, chest, upper chest, neck, head.
+	}
+	const int32_t chest = 3;
+	LocalVector<int32_t> pins;
+	pins.push_back(5);
+	const int32_t limb_roots[] = { chest, chest, 0, 0 };
+	for (int32_t limb_root : limb_roots) {
+		int32_t parent = limb_root;
+		for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+			parents.push_back(parent);
+			parent = parents.size() - 1;
+		}
+		pins.push_back(parent);
+	}
+	return create_rig(parents, pins);
+}
+
+// A 500 bone tree that branches in three every third bone, pinned at every leaf.
+inline Rig create_tree_rig(int32_t p_bone_count = 500) {
+	LocalVector<int32_t> parents;
+	LocalVector<int32_t> child_counts;
+	parents.push_back(-1);
+	child_counts.push_back(0);
+	int32_t open = 0;
+	while (int32_t(parents.size()) < p_bone_count) {
+		const int32_t limit = (open % 3 == 0) ? 3 : 1;
+		if (child_counts[open] >= limit) {
+			open++;
+			continue;
+		}
+		child_counts[open]++;
+		parents.push_back(open);
+		child_counts.push_back(0);
+	}
+	LocalVector<int32_t> pins;
+	for (uint32_t bone_i = 0; bone_i < parents.size(); bone_i++) {
+		if (child_counts[bone_i] == 0) {
+			pins.push_back(bone_i);
+		}
+	}
+	return create_rig(parents, pins, 4);
+}
+
+// Moves every pin target a little each call, along a fixed pseudo-random walk.
+inline void step_targets(Rig &r_rig, RandomPCG &r_rng) {
+	for (uint32_t pin_i = 0; pin_i < r_rig.pinned_bones.size(); pin_i++) {
+		Transform3D target = r_rig.skeleton->get_bone_global_pose(r_rig.pinned_bones[pin_i]);
+		target.origin += Vector3(r_rng.random(-0.05f, 0.05f), r_rng.random(-0.05f, 0.05f), r_rng.random(-0.05f, 0.05f));
+		r_rig.ik->set_pin_target_transform_override(pin_i, target);
+	}
+}
+
+} // namespace TestEWBIKFixtures
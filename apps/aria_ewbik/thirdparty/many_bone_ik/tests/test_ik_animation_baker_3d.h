@@ -0,0 +1,186 @@
+/**************************************************************************/
+/*  test_ik_animation_baker_3d.h                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_animation_baker_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKAnimationBaker3D {
+
+Ref<IKEffectorAnimation3D> create_circle_stream(int32_t p_frames) {
+	// A hand target sweeping a circle inside the arm's reach.
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length((p_frames - 1) / 30.0);
+	const int32_t track = animation->add_track(Animation::TYPE_ROTATION_3D);
+	animation->track_set_path(track, NodePath("Skeleton3D:UpperArm"));
+	for (int32_t frame_i = 0; frame_i < p_frames; frame_i++) {
+		const double angle = Math::TAU * frame_i / (p_frames - 1);
+		animation->rotation_track_insert_key(track, frame_i / 30.0, Quaternion(Vector3(Math::cos(angle), 0, Math::sin(angle)), 0.5));
+	}
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKEffectorAnimation3D> stream;
+	stream.instantiate();
+	stream->compress(animation, rig.ik, 30.0);
+	TestEWBIKFixtures::free_arm(rig);
+	return stream;
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKAnimationBaker3D] Bakes one rotation key per frame and bone") {
+	Ref<IKEffectorAnimation3D> stream = create_circle_stream(40);
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKAnimationBaker3D> baker;
+	baker.instantiate();
+	baker->set_chunk_size(16);
+
+	Ref<Animation> baked = baker->bake(stream, rig.ik);
+	REQUIRE(baked.is_valid());
+	CHECK(baked->get_track_count() == 4);
+	CHECK(baked->find_track(NodePath("Skeleton3D:Hand"), Animation::TYPE_ROTATION_3D) != -1);
+	for (int32_t track_i = 0; track_i < baked->get_track_count(); track_i++) {
+		CHECK(baked->track_get_key_count(track_i) == 40);
+	}
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKAnimationBaker3D] Bakes are identical across parallelism") {
+	Ref<IKEffectorAnimation3D> stream = create_circle_stream(64);
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKAnimationBaker3D> baker;
+	baker.instantiate();
+	baker->set_chunk_size(8);
+
+	baker->set_max_parallel_chunks(1);
+	Ref<Animation> serial = baker->bake(stream, rig.ik);
+	baker->set_max_parallel_chunks(8);
+	Ref<Animation> parallel = baker->bake(stream, rig.ik);
+	REQUIRE(serial.is_valid());
+	REQUIRE(parallel.is_valid());
+	REQUIRE(serial->get_track_count() == parallel->get_track_count());
+	for (int32_t track_i = 0; track_i < serial->get_track_count(); track_i++) {
+		REQUIRE(serial->track_get_key_count(track_i) == parallel->track_get_key_count(track_i));
+		for (int32_t key_i = 0; key_i < serial->track_get_key_count(track_i); key_i++) {
+			CHECK(Quaternion(serial->track_get_key_value(track_i, key_i)) == Quaternion(parallel->track_get_key_value(track_i, key_i)));
+		}
+	}
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKAnimationBaker3D] Key reduction stays within tolerance") {
+	Ref<IKEffectorAnimation3D> stream = create_circle_stream(64);
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKAnimationBaker3D> baker;
+	baker.instantiate();
+	Ref<Animation> full = baker->bake(stream, rig.ik);
+	baker->set_key_reduction_tolerance(0.01);
+	Ref<Animation> reduced = baker->bake(stream, rig.ik);
+	REQUIRE(full.is_valid());
+	REQUIRE(reduced.is_valid());
+
+	int32_t full_keys = 0, reduced_keys = 0;
+	for (int32_t track_i = 0; track_i < full->get_track_count(); track_i++) {
+		full_keys += full->track_get_key_count(track_i);
+		reduced_keys += reduced->track_get_key_count(track_i);
+		for (int32_t key_i = 0; key_i < full->track_get_key_count(track_i); key_i++) {
+			const double time = full->track_get_key_time(track_i, key_i);
+			Quaternion expected = full->track_get_key_value(track_i, key_i);
+			Quaternion actual;
+			REQUIRE(reduced->try_rotation_track_interpolate(track_i, time, &actual) == OK);
+			CHECK(expected.angle_to(actual) <= 0.01 + CMP_EPSILON);
+		}
+	}
+	CHECK(reduced_keys < full_keys);
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+// Appends the keys of every streamed wave per track.
+class WaveCollector : public Object {
+	GDCLASS(WaveCollector, Object);
+
+public:
+	int32_t wave_count = 0;
+	Dictionary times;
+	Dictionary rotations;
+
+	void receive(const Dictionary &p_keys) {
+		wave_count++;
+		for (const KeyValue<Variant, Variant> &track : p_keys) {
+			const Dictionary keys = track.value;
+			PackedFloat64Array track_times = times.get(track.key, PackedFloat64Array());
+			PackedFloat32Array track_rotations = rotations.get(track.key, PackedFloat32Array());
+			track_times.append_array(keys["times"]);
+			track_rotations.append_array(keys["rotations"]);
+			times[track.key] = track_times;
+			rotations[track.key] = track_rotations;
+		}
+	}
+};
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKAnimationBaker3D] Streamed waves carry the same keys as a bake") {
+	Ref<IKEffectorAnimation3D> stream = create_circle_stream(64);
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKAnimationBaker3D> baker;
+	baker.instantiate();
+	baker->set_chunk_size(8);
+	baker->set_max_parallel_chunks(2);
+	baker->set_key_reduction_tolerance(0.01);
+	Ref<Animation> baked = baker->bake(stream, rig.ik);
+	REQUIRE(baked.is_valid());
+
+	WaveCollector collector;
+	REQUIRE(baker->bake_streamed(stream, rig.ik, callable_mp(&collector, &WaveCollector::receive)) == OK);
+	// Eight chunks in waves of two; a wave whose keys were all reduced away is not sent.
+	CHECK(collector.wave_count > 0);
+	CHECK(collector.wave_count <= 4);
+	const Dictionary &streamed_times = collector.times;
+	const Dictionary &streamed_rotations = collector.rotations;
+
+	REQUIRE(streamed_times.size() == baked->get_track_count());
+	for (int32_t track_i = 0; track_i < baked->get_track_count(); track_i++) {
+		const String path = baked->track_get_path(track_i);
+		const PackedFloat64Array times = streamed_times[path];
+		const PackedFloat32Array rotations = streamed_rotations[path];
+		REQUIRE(times.size() == baked->track_get_key_count(track_i));
+		for (int32_t key_i = 0; key_i < times.size(); key_i++) {
+			CHECK(times[key_i] == baked->track_get_key_time(track_i, key_i));
+			const Quaternion rotation(rotations[key_i * 4 + 0], rotations[key_i * 4 + 1], rotations[key_i * 4 + 2], rotations[key_i * 4 + 3]);
+			CHECK(rotation.is_equal_approx(baked->track_get_key_value(track_i, key_i)));
+		}
+	}
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKAnimationBaker3D
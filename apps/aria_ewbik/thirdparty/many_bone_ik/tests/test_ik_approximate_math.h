@@ -0,0 +1,155 @@
+/**************************************************************************/
+/*  test_ik_approximate_math.h                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_kusudama_3d.h"
+#include "modules/many_bone_ik/src/math/ik_deterministic_math.h"
+#include "modules/many_bone_ik/src/math/interval_math.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKApproximateMath {
+
+TEST_CASE("[Modules][ManyBoneIK][IKApproximateMath] Errors stay within the documented bounds") {
+	double sin_error = 0.0;
+	double cos_error = 0.0;
+	for (int32_t step_i = -20000; step_i <= 20000; step_i++) {
+		const double x = step_i * 0.00731;
+		sin_error = MAX(sin_error, Math::abs(IKApproximateMath::sin(x) - Math::sin(x)));
+		cos_error = MAX(cos_error, Math::abs(IKApproximateMath::cos(x) - Math::cos(x)));
+	}
+	CHECK(sin_error < 3e-9);
+	CHECK(cos_error < 3e-9);
+	double acos_error = 0.0;
+	double asin_error = 0.0;
+	for (int32_t step_i = -10000; step_i <= 10000; step_i++) {
+		const double x = step_i * 0.0001;
+		acos_error = MAX(acos_error, Math::abs(IKApproximateMath::acos(x) - Math::acos(x)));
+		asin_error = MAX(asin_error, Math::abs(IKApproximateMath::asin(x) - Math::asin(x)));
+	}
+	CHECK(acos_error < 6e-9);
+	CHECK(asin_error < 6e-9);
+	CHECK(IKApproximateMath::acos(1.5) == 0.0);
+
+	const Quaternion from(Vector3(0, 1, 0), 0.2);
+	const Quaternion to(Vector3(0.3, 1, 0).normalized(), 1.4);
+	CHECK(IKApproximateMath::slerp(from, to, 0.3).is_equal_approx(from.slerp(to, 0.3)));
+	CHECK(IKApproximateMath::axis_angle(Vector3(1, 0, 0), 0.7).is_equal_approx(Quaternion(Vector3(1, 0, 0), 0.7)));
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKApproximateMath] Swing and twist recompose to the rotation") {
+	const Quaternion twist(Vector3(0, 1, 0), 0.6);
+	const Quaternion swing(Vector3(1, 0, 0.5).normalized(), 0.8);
+	const Quaternion rotation = swing * twist;
+	Quaternion approximate_swing;
+	Quaternion approximate_twist;
+	IKApproximateMath::swing_twist(rotation, Vector3(0, 2, 0), approximate_swing, approximate_twist);
+	CHECK((approximate_swing * approximate_twist).is_equal_approx(rotation));
+	CHECK(approximate_twist.is_equal_approx(twist));
+	// The swing has no component about the axis.
+	CHECK(Math::abs(approximate_swing.y) < 1e-6);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKApproximateMath] The policy only applies inside its scope") {
+	CHECK(IKMath::get_policy() == IKMath::POLICY_PRECISE);
+	{
+		IKMath::PolicyScope scope(IKMath::POLICY_APPROXIMATE);
+		CHECK(IKMath::get_policy() == IKMath::POLICY_APPROXIMATE);
+		CHECK(IKMath::cos(0.4) == IKApproximateMath::cos(0.4));
+	}
+	CHECK(IKMath::get_policy() == IKMath::POLICY_PRECISE);
+}
+
+static void check_pose_difference(bool p_constrained) {
+	TestEWBIKFixtures::ArmRig precise = TestEWBIKFixtures::create_arm(true);
+	TestEWBIKFixtures::ArmRig approximate = TestEWBIKFixtures::create_arm(true);
+	if (p_constrained) {
+		TestEWBIKFixtures::constrain_arm(precise);
+		TestEWBIKFixtures::constrain_arm(approximate);
+	}
+	approximate.ik->set_approximate_math_enabled(true);
+	for (int32_t frame_i = 0; frame_i < 12; frame_i++) {
+		const real_t angle = 0.25 * frame_i;
+		const Transform3D target(Basis(Vector3(0, 0, 1), 0.3 * angle), Vector3(Math::cos(angle) * 1.5, 2.0, Math::sin(angle) * 1.5));
+		precise.ik->set_pin_target_transform_override(0, target);
+		approximate.ik->set_pin_target_transform_override(0, target);
+		precise.ik->solve();
+		approximate.ik->solve();
+		for (int32_t bone_i = 0; bone_i < precise.skeleton->get_bone_count(); bone_i++) {
+			const Transform3D expected = precise.skeleton->get_bone_global_pose(bone_i);
+			const Transform3D actual = approximate.skeleton->get_bone_global_pose(bone_i);
+			CHECK(expected.origin.distance_to(actual.origin) < 1e-3);
+			CHECK(expected.basis.get_rotation_quaternion().angle_to(actual.basis.get_rotation_quaternion()) < 1e-3);
+		}
+	}
+	CHECK(IKMath::get_policy() == IKMath::POLICY_PRECISE);
+	TestEWBIKFixtures::free_arm(precise);
+	TestEWBIKFixtures::free_arm(approximate);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKApproximateMath] Cone-limited snaps follow the policy") {
+	Ref<IKKusudama3D> kusudama;
+	kusudama.instantiate();
+	Ref<IKLimitCone3D> cone;
+	cone.instantiate();
+	cone->set_attached_to(kusudama);
+	cone->set_radius(Math::deg_to_rad(30.0f));
+	cone->set_control_point(Vector3(0, 0, 1));
+	kusudama->add_open_cone(cone);
+
+	Vector<double> bounds;
+	bounds.resize(2);
+	const Vector3 outside = Vector3(1, 0.2, 0).normalized();
+	const Vector3 precise = kusudama->get_local_point_in_limits(outside, &bounds);
+	CHECK(bounds[0] == -1);
+	{
+		IKMath::PolicyScope scope(IKMath::POLICY_APPROXIMATE);
+		// The snap rotation is built through the interval trigonometry.
+		CHECK(IntervalMath::Interval(0.35).sin().lower == real_t(IKApproximateMath::sin(real_t(0.35))));
+		CHECK(IntervalMath::Interval(0.35).cos().lower == real_t(IKApproximateMath::cos(real_t(0.35))));
+		bounds.write[0] = 0;
+		const Vector3 approximate = kusudama->get_local_point_in_limits(outside, &bounds);
+		CHECK(bounds[0] == -1);
+		CHECK(approximate.distance_to(precise) < 1e-5);
+		// The snapped point lies on the cone boundary.
+		CHECK(Math::is_equal_approx(approximate.angle_to(Vector3(0, 0, 1)), real_t(Math::deg_to_rad(30.0f)), real_t(1e-4)));
+	}
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKApproximateMath] Approximate solves stay close to precise ones") {
+	check_pose_difference(false);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKApproximateMath] Approximate solves stay close on a constrained arm") {
+	check_pose_difference(true);
+}
+
+} // namespace TestIKApproximateMath
@@ -0,0 +1,130 @@
+/**************************************************************************/
+/*  test_ik_bone_picker_3d.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#ifdef TOOLS_ENABLED
+
+#include "modules/many_bone_ik/editor/ik_bone_picker_3d.h"
+#include "tests/test_macros.h"
+
+namespace TestIKBonePicker3D {
+
+// A 20 by 15 grid of bones in the XY plane, 0.1 apart.
+inline void create_grid(IKBonePicker3D &r_picker) {
+	r_picker.resize(300);
+	for (int32_t bone_i = 0; bone_i < 300; bone_i++) {
+		r_picker.set_bone_position(bone_i, Vector3(0.1 * (bone_i % 20), 0.1 * (bone_i / 20), 0));
+	}
+}
+
+// A box looking down -Z at p_center, p_half_width wide, like the grab square of a pick.
+inline void pick_around(IKBonePicker3D &r_picker, const Vector3 &p_center, real_t p_half_width, LocalVector<int32_t> &r_bones) {
+	const Vector2 corners[4] = { Vector2(-1, -1), Vector2(1, -1), Vector2(1, 1), Vector2(-1, 1) };
+	Vector3 near_corners[4];
+	Vector3 far_corners[4];
+	for (int32_t corner_i = 0; corner_i < 4; corner_i++) {
+		const Vector3 offset(corners[corner_i].x * p_half_width, corners[corner_i].y * p_half_width, 0);
+		near_corners[corner_i] = p_center + offset + Vector3(0, 0, 10);
+		far_corners[corner_i] = p_center + offset - Vector3(0, 0, 10);
+	}
+	r_picker.pick_frustum(near_corners, far_corners, r_bones);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKBonePicker3D] A pick returns the bones whose bounds reach the pick volume") {
+	IKBonePicker3D picker;
+	picker.set_radius(0.02);
+	create_grid(picker);
+
+	LocalVector<int32_t> bones;
+	pick_around(picker, Vector3(0.5, 0.3, 0), 0.01, bones);
+	REQUIRE_EQ(bones.size(), 1u);
+	CHECK_EQ(bones[0], 3 * 20 + 5);
+
+	// Between four bones, wide enough to reach all of them.
+	bones.clear();
+	pick_around(picker, Vector3(0.55, 0.35, 0), 0.04, bones);
+	bones.sort();
+	REQUIRE_EQ(bones.size(), 4u);
+	CHECK_EQ(bones[0], 3 * 20 + 5);
+	CHECK_EQ(bones[1], 3 * 20 + 6);
+	CHECK_EQ(bones[2], 4 * 20 + 5);
+	CHECK_EQ(bones[3], 4 * 20 + 6);
+
+	bones.clear();
+	pick_around(picker, Vector3(5, 5, 0), 0.04, bones);
+	CHECK(bones.is_empty());
+
+	bones.clear();
+	picker.pick_segment(Vector3(0.1, 0.1, 1), Vector3(0.1, 0.1, -1), bones);
+	REQUIRE_EQ(bones.size(), 1u);
+	CHECK_EQ(bones[0], 21);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKBonePicker3D] Moving a bone refits only that bone") {
+	IKBonePicker3D picker;
+	create_grid(picker);
+	const uint64_t refits = picker.get_refit_count();
+
+	for (int32_t bone_i = 0; bone_i < 300; bone_i++) {
+		picker.set_bone_position(bone_i, picker.get_bone_position(bone_i));
+	}
+	CHECK_EQ(picker.get_refit_count(), refits);
+
+	picker.set_bone_position(42, Vector3(3, 3, 0));
+	CHECK_EQ(picker.get_refit_count(), refits + 1);
+
+	LocalVector<int32_t> bones;
+	pick_around(picker, Vector3(3, 3, 0), 0.01, bones);
+	REQUIRE_EQ(bones.size(), 1u);
+	CHECK_EQ(bones[0], 42);
+
+	bones.clear();
+	pick_around(picker, Vector3(0.2, 0.2, 0), 0.01, bones);
+	CHECK(bones.is_empty());
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKBonePicker3D] Shrinking drops the removed bones") {
+	IKBonePicker3D picker;
+	create_grid(picker);
+	picker.resize(20);
+	CHECK_EQ(picker.get_bone_count(), 20);
+
+	LocalVector<int32_t> bones;
+	pick_around(picker, Vector3(0.5, 0.3, 0), 0.01, bones);
+	CHECK(bones.is_empty());
+	pick_around(picker, Vector3(0.5, 0, 0), 0.01, bones);
+	REQUIRE_EQ(bones.size(), 1u);
+	CHECK_EQ(bones[0], 5);
+}
+
+} // namespace TestIKBonePicker3D
+
+#endif // TOOLS_ENABLED
@@ -0,0 +1,184 @@
+/**************************************************************************/
+/*  test_ik_deterministic_math.h                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_kusudama_3d.h"
+#include "modules/many_bone_ik/src/math/ik_deterministic_math.h"
+#include "modules/many_bone_ik/src/math/interval_math.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+#include <cstring>
+
+namespace TestIKDeterministicMath {
+
+uint64_t bits_of(double p_value) {
+	uint64_t bits;
+	memcpy(&bits, &p_value, sizeof(bits));
+	return bits;
+}
+
+uint32_t bits_of(float p_value) {
+	uint32_t bits;
+	memcpy(&bits, &p_value, sizeof(bits));
+	return bits;
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKDeterministicMath] Results match golden bit patterns") {
+	// These must hold on every platform; a change here breaks replays recorded by other builds.
+	CHECK(bits_of(IKDeterministicMath::sin(0.5)) == 0x3fdeaee8744b05f0ull);
+	CHECK(bits_of(IKDeterministicMath::cos(2.0)) == 0xbfdaa22657537205ull);
+	CHECK(bits_of(IKDeterministicMath::acos(0.3)) == 0x3ff441f5ecbeef58ull);
+	CHECK(bits_of(IKDeterministicMath::acos(-0.8)) == 0x4003fc176b7a8560ull);
+	CHECK(bits_of(IKDeterministicMath::sin(100.0)) == 0xbfe03425b78c4db8ull);
+	CHECK(bits_of(IKDeterministicMath::exp(1.5)) == 0x4011ed3fe64fc541ull);
+	CHECK(bits_of(IKDeterministicMath::log(3.0)) == 0x3ff193ea7aad030aull);
+	CHECK(bits_of(IKDeterministicMath::log(0.3)) == 0xbff34378fcbda721ull);
+	CHECK(bits_of(IKDeterministicMath::pow(7.0, 2.2)) == 0x405214064e76b2c5ull);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKDeterministicMath] Results stay close to the platform library") {
+	for (int32_t step_i = -2000; step_i <= 2000; step_i++) {
+		const double x = step_i * 0.05;
+		CHECK(Math::abs(IKDeterministicMath::sin(x) - Math::sin(x)) < 1e-15);
+		CHECK(Math::abs(IKDeterministicMath::cos(x) - Math::cos(x)) < 1e-15);
+	}
+	for (int32_t step_i = -100; step_i <= 100; step_i++) {
+		const double x = step_i * 0.01;
+		CHECK(Math::abs(IKDeterministicMath::acos(x) - Math::acos(x)) < 1e-15);
+	}
+	for (int32_t step_i = 1; step_i <= 400; step_i++) {
+		const double x = step_i * 0.05;
+		CHECK(Math::abs(IKDeterministicMath::exp(x - 10.0) - Math::exp(x - 10.0)) <= 1e-15 * Math::exp(x - 10.0));
+		CHECK(Math::abs(IKDeterministicMath::log(x) - Math::log(x)) < 1e-15);
+		CHECK(Math::abs(IKDeterministicMath::pow(x, 1.7) - Math::pow(x, 1.7)) <= 1e-14 * Math::pow(x, 1.7));
+	}
+	CHECK(IKDeterministicMath::pow(0.0, 2.0) == 0.0);
+	CHECK(IKDeterministicMath::pow(0.0, 0.0) == 1.0);
+	const Quaternion from(Vector3(0, 1, 0), 0.2);
+	const Quaternion to(Vector3(0, 1, 0), 1.4);
+	CHECK(IKDeterministicMath::slerp(from, to, 0.5).is_equal_approx(from.slerp(to, 0.5)));
+	CHECK(IKDeterministicMath::axis_angle(Vector3(1, 0, 0), 0.7).is_equal_approx(Quaternion(Vector3(1, 0, 0), 0.7)));
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKDeterministicMath] Cone and twist rotations use the solver trigonometry") {
+	// Cone snapping, the cone tangent setup and the twist limits all build
+	// their rotations through the interval axis-angle path.
+	CHECK(IntervalMath::Interval(0.35).sin().lower == real_t(IKMath::sin(real_t(0.35))));
+	CHECK(IntervalMath::Interval(0.35).cos().lower == real_t(IKMath::cos(real_t(0.35))));
+#if defined(MANY_BONE_IK_DETERMINISTIC) && !defined(REAL_T_IS_DOUBLE)
+	const Quaternion about_y = IKKusudama3D::get_quaternion_axis_angle(Vector3(0, 1, 0), 0.7);
+	CHECK(bits_of(about_y.x) == 0x00000000u);
+	CHECK(bits_of(about_y.y) == 0x3eaf904du);
+	CHECK(bits_of(about_y.z) == 0x00000000u);
+	CHECK(bits_of(about_y.w) == 0x3f707abbu);
+	const Quaternion skewed = IKKusudama3D::get_quaternion_axis_angle(Vector3(0.3, 0.8, -0.5), 1.3);
+	CHECK(bits_of(skewed.x) == 0x3e3bccffu);
+	CHECK(bits_of(skewed.y) == 0x3efa66a8u);
+	CHECK(bits_of(skewed.z) == 0xbe9c8028u);
+	CHECK(bits_of(skewed.w) == 0x3f4bcc26u);
+#endif
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKDeterministicMath] Identical solves produce identical pose hashes") {
+	TestEWBIKFixtures::ArmRig first = TestEWBIKFixtures::create_arm(true);
+	TestEWBIKFixtures::ArmRig second = TestEWBIKFixtures::create_arm(true);
+	const Transform3D target(Basis(Vector3(0, 0, 1), 0.5), Vector3(1.2, 1.8, 0.4));
+	first.ik->solve();
+	second.ik->solve();
+	first.ik->set_pin_target_transform_override(0, target);
+	second.ik->set_pin_target_transform_override(0, target);
+	for (int32_t solve_i = 0; solve_i < 3; solve_i++) {
+		first.ik->solve();
+		second.ik->solve();
+	}
+	CHECK(first.ik->get_pose_hash() == second.ik->get_pose_hash());
+
+	// A different pose must hash differently.
+	const int64_t solved_hash = first.ik->get_pose_hash();
+	first.skeleton->set_bone_pose_rotation(1, Quaternion(Vector3(0, 0, 1), 0.01));
+	CHECK(first.ik->get_pose_hash() != solved_hash);
+
+	TestEWBIKFixtures::free_arm(first);
+	TestEWBIKFixtures::free_arm(second);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKDeterministicMath] Constrained solves produce identical pose hashes") {
+	TestEWBIKFixtures::ArmRig unconstrained = TestEWBIKFixtures::create_arm(true);
+	TestEWBIKFixtures::ArmRig first = TestEWBIKFixtures::create_arm(true);
+	TestEWBIKFixtures::ArmRig second = TestEWBIKFixtures::create_arm(true);
+	// Narrow cones, so every target below pushes the arm against its limits.
+	TestEWBIKFixtures::constrain_arm(first, 0.3, Vector2(-0.2, 0.4));
+	TestEWBIKFixtures::constrain_arm(second, 0.3, Vector2(-0.2, 0.4));
+	for (int32_t frame_i = 0; frame_i < 8; frame_i++) {
+		const real_t angle = 0.7 * frame_i;
+		const Transform3D target(Basis(Vector3(0, 1, 0), angle), Vector3(Math::cos(angle) * 2.5, 1.0, Math::sin(angle) * 2.5));
+		unconstrained.ik->set_pin_target_transform_override(0, target);
+		first.ik->set_pin_target_transform_override(0, target);
+		second.ik->set_pin_target_transform_override(0, target);
+		unconstrained.ik->solve();
+		first.ik->solve();
+		second.ik->solve();
+		CHECK(first.ik->get_pose_hash() == second.ik->get_pose_hash());
+		// The limits must have changed the pose, or this would not cover the snaps.
+		CHECK(first.ik->get_pose_hash() != unconstrained.ik->get_pose_hash());
+	}
+	TestEWBIKFixtures::free_arm(unconstrained);
+	TestEWBIKFixtures::free_arm(first);
+	TestEWBIKFixtures::free_arm(second);
+}
+
+#ifdef MANY_BONE_IK_DETERMINISTIC
+// The pose hash of the fixed script below, as solved by a reference
+// deterministic build. Zero until one has recorded it.
+static constexpr uint64_t GOLDEN_POSE_HASH = 0;
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKDeterministicMath] A fixed rig and target script solves to the golden pose hash") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm(true);
+	TestEWBIKFixtures::constrain_arm(rig);
+	for (int32_t frame_i = 0; frame_i < 16; frame_i++) {
+		// Targets built from exact binary fractions, so the script itself is the same everywhere.
+		const real_t step = frame_i * 0.125;
+		rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(), Vector3(1.5 - step * 0.25, 1.75 + step * 0.125, 0.5 - step * 0.0625)));
+		rig.ik->solve();
+	}
+	const uint64_t pose_hash = uint64_t(rig.ik->get_pose_hash());
+	if (GOLDEN_POSE_HASH == 0) {
+		MESSAGE(vformat("Record GOLDEN_POSE_HASH = 0x%016x from a reference build.", pose_hash).utf8().get_data());
+	} else {
+		CHECK(pose_hash == GOLDEN_POSE_HASH);
+	}
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+#endif // MANY_BONE_IK_DETERMINISTIC
+
+} // namespace TestIKDeterministicMath
@@ -0,0 +1,194 @@
+/**************************************************************************/
+/*  test_ik_effector_3d.h                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/random_pcg.h"
+#include "modules/many_bone_ik/src/ik_effector_3d.h"
+#include "modules/many_bone_ik/tests/test_many_bone_ik_benchmark_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKEffector3D {
+
+using namespace TestManyBoneIKBenchmarkFixtures;
+
+// The per-axis loops the heading kernels replaced.
+inline int32_t reference_target_headings(const Transform3D &p_target, const Vector3 &p_priorities, const Vector3 &p_bone_origin, const Vector<double> &p_weights, PackedVector3Array &r_headings, int32_t p_index) {
+	int32_t index = p_index;
+	r_headings.write[index] = p_target.origin - p_bone_origin;
+	index++;
+	for (int axis = Vector3::AXIS_X; axis <= Vector3::AXIS_Z; ++axis) {
+		if (p_priorities[axis] > 0.0) {
+			real_t w = p_weights.get(index);
+			Vector3 column = p_target.basis.get_column(axis);
+			r_headings.write[index] = (column + p_target.origin) - p_bone_origin;
+			r_headings.write[index] *= Vector3(w, w, w);
+			index++;
+			r_headings.write[index] = (p_target.origin - column) - p_bone_origin;
+			r_headings.write[index] *= Vector3(w, w, w);
+			index++;
+		}
+	}
+	return index;
+}
+
+inline int32_t reference_tip_headings(const Transform3D &p_tip, const Vector3 &p_priorities, const Vector3 &p_bone_origin, double p_scale, PackedVector3Array &r_headings, int32_t p_index) {
+	int32_t index = p_index;
+	r_headings.write[index] = p_tip.origin - p_bone_origin;
+	index++;
+	for (int axis = Vector3::AXIS_X; axis <= Vector3::AXIS_Z; ++axis) {
+		if (p_priorities[axis] > 0.0) {
+			Vector3 column = p_tip.basis.get_column(axis) * p_priorities[axis];
+			r_headings.write[index] = (column + p_tip.origin) - p_bone_origin;
+			r_headings.write[index] *= p_scale;
+			index++;
+			r_headings.write[index] = (p_tip.origin - column) - p_bone_origin;
+			r_headings.write[index] *= p_scale;
+			index++;
+		}
+	}
+	return index;
+}
+
+inline Transform3D random_transform(RandomPCG &r_rng) {
+	const Vector3 axis = Vector3(r_rng.random(-1.0f, 1.0f), r_rng.random(-1.0f, 1.0f), r_rng.random(-1.0f, 1.0f) + 2.0f).normalized();
+	return Transform3D(Basis(axis, r_rng.random(-3.0f, 3.0f)), Vector3(r_rng.random(-2.0f, 2.0f), r_rng.random(-2.0f, 2.0f), r_rng.random(-2.0f, 2.0f)));
+}
+
+inline Vector3 priorities_for_mask(uint8_t p_mask) {
+	return Vector3((p_mask & 1) ? 0.8 : 0.0, (p_mask & 2) ? 0.5 : 0.0, (p_mask & 4) ? 0.3 : 0.0);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKEffector3D] Heading kernels match the per-axis loop for every priority mask") {
+	RandomPCG rng(7);
+	for (uint8_t mask = 0; mask < 8; mask++) {
+		CAPTURE(mask);
+		const Vector3 priorities = priorities_for_mask(mask);
+		CHECK_EQ(IKEffector3D::make_priority_mask(priorities), mask);
+
+		const Transform3D target = random_transform(rng);
+		const Transform3D tip = random_transform(rng);
+		const Vector3 bone_origin(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f));
+		const double scale = 0.7;
+		// Two pins back to back, the way a segment lays out its buffers.
+		Vector<double> weights;
+		PackedVector3Array expected;
+		PackedVector3Array actual;
+		weights.resize(14);
+		expected.resize(14);
+		actual.resize(14);
+		for (int32_t heading_i = 0; heading_i < 14; heading_i++) {
+			weights.write[heading_i] = rng.random(0.1f, 1.0f);
+		}
+
+		int32_t expected_index = reference_target_headings(target, priorities, bone_origin, weights, expected, 0);
+		expected_index = reference_target_headings(target, priorities, bone_origin, weights, expected, expected_index);
+		int32_t actual_index = IKEffector3D::get_target_heading_kernel(mask)(target, bone_origin, weights.ptr(), actual.ptrw(), 0);
+		actual_index = IKEffector3D::get_target_heading_kernel(mask)(target, bone_origin, weights.ptr(), actual.ptrw(), actual_index);
+		REQUIRE_EQ(actual_index, expected_index);
+		for (int32_t heading_i = 0; heading_i < expected_index; heading_i++) {
+			CHECK(actual[heading_i] == expected[heading_i]);
+		}
+
+		expected_index = reference_tip_headings(tip, priorities, bone_origin, scale, expected, 0);
+		actual_index = IKEffector3D::get_tip_heading_kernel(mask)(tip, priorities, bone_origin, scale, actual.ptrw(), 0);
+		REQUIRE_EQ(actual_index, expected_index);
+		for (int32_t heading_i = 0; heading_i < expected_index; heading_i++) {
+			CHECK(actual[heading_i] == expected[heading_i]);
+		}
+	}
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKEffector3D] Priorities pick the kernel and heading count") {
+	Ref<IKEffector3D> effector;
+	effector.instantiate();
+	CHECK_EQ(effector->get_priority_mask(), 0);
+	CHECK_EQ(effector->get_heading_count(), 1);
+	effector->set_direction_priorities(Vector3(0.2, 0, 0.4));
+	CHECK_EQ(effector->get_priority_mask(), 0b101);
+	CHECK_EQ(effector->get_heading_count(), 5);
+	effector->set_direction_priorities(Vector3(1, 1, 1));
+	CHECK_EQ(effector->get_heading_count(), 7);
+	effector->set_direction_priorities(Vector3(-1, 0, 0));
+	CHECK_EQ(effector->get_heading_count(), 1);
+	CHECK_EQ(IKEffector3D::get_heading_count(0b111), 7);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKEffector3D][Benchmark] Heading generation over mixed priority masks" * doctest::skip()) {
+	const int32_t pin_count = 64;
+	RandomPCG rng(20250101);
+	LocalVector<Transform3D> transforms;
+	LocalVector<uint8_t> masks;
+	int32_t heading_count = 0;
+	for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+		transforms.push_back(random_transform(rng));
+		masks.push_back(IKEffector3D::make_priority_mask(priorities_for_mask(rng.rand() % 8)));
+		heading_count += IKEffector3D::get_heading_count(masks[pin_i]);
+	}
+	LocalVector<IKEffector3D::TargetHeadingKernel> target_kernels;
+	LocalVector<IKEffector3D::TipHeadingKernel> tip_kernels;
+	for (uint8_t mask : masks) {
+		target_kernels.push_back(IKEffector3D::get_target_heading_kernel(mask));
+		tip_kernels.push_back(IKEffector3D::get_tip_heading_kernel(mask));
+	}
+	Vector<double> weights;
+	weights.resize(heading_count);
+	weights.fill(0.5);
+	PackedVector3Array headings;
+	headings.resize(heading_count);
+	const Vector3 bone_origin(0.1, 0.2, 0.3);
+	Dictionary parameters;
+	parameters["pins"] = pin_count;
+	parameters["masks"] = "mixed";
+
+	run_benchmark("headings", "per_axis_loop", parameters, BenchmarkSettings(), [&]() {
+		int32_t index = 0;
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			index = reference_target_headings(transforms[pin_i], priorities_for_mask(masks[pin_i]), bone_origin, weights, headings, index);
+		}
+		index = 0;
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			index = reference_tip_headings(transforms[pin_i], priorities_for_mask(masks[pin_i]), bone_origin, 0.7, headings, index);
+		}
+	});
+	run_benchmark("headings", "mask_kernels", parameters, BenchmarkSettings(), [&]() {
+		Vector3 *write = headings.ptrw();
+		int32_t index = 0;
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			index = target_kernels[pin_i](transforms[pin_i], bone_origin, weights.ptr(), write, index);
+		}
+		index = 0;
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			index = tip_kernels[pin_i](transforms[pin_i], priorities_for_mask(masks[pin_i]), bone_origin, 0.7, write, index);
+		}
+	});
+}
+
+} // namespace TestIKEffector3D
@@ -0,0 +1,136 @@
+/**************************************************************************/
+/*  test_ik_effector_animation_3d.h                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_effector_animation_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKEffectorAnimation3D {
+
+Ref<Animation> create_reach_animation() {
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length(1.0);
+	const int32_t upper = animation->add_track(Animation::TYPE_ROTATION_3D);
+	animation->track_set_path(upper, NodePath("Skeleton3D:UpperArm"));
+	const int32_t lower = animation->add_track(Animation::TYPE_ROTATION_3D);
+	animation->track_set_path(lower, NodePath("Skeleton3D:LowerArm"));
+	for (int32_t key_i = 0; key_i <= 30; key_i++) {
+		const double time = key_i / 30.0;
+		animation->rotation_track_insert_key(upper, time, Quaternion(Vector3(0, 0, 1), 0.6 * time));
+		animation->rotation_track_insert_key(lower, time, Quaternion(Vector3(0, 0, 1), 0.4 * time));
+	}
+	return animation;
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKEffectorAnimation3D] Compression keeps only effector tracks") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKEffectorAnimation3D> compressed;
+	compressed.instantiate();
+	Ref<Animation> animation = create_reach_animation();
+
+	REQUIRE(compressed->compress(animation, rig.ik, 30.0, PackedStringArray{ "LowerArm" }, 0.5) == OK);
+	CHECK(compressed->get_frame_count() == 31);
+	REQUIRE(compressed->get_effector_track_count() == 1);
+	CHECK(compressed->get_effector_track_bone(0) == StringName("Hand"));
+	CHECK(compressed->get_hint_track_count() == 1);
+
+	// The hand target at the end matches the source pose.
+	rig.skeleton->set_bone_pose_rotation(1, Quaternion(Vector3(0, 0, 1), 0.6));
+	rig.skeleton->set_bone_pose_rotation(2, Quaternion(Vector3(0, 0, 1), 0.4));
+	CHECK(compressed->get_effector_target(0, 1.0).origin.is_equal_approx(TestEWBIKFixtures::get_hand_position(rig)));
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKEffectorAnimation3D] Playback is deterministic and tracks the source") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKEffectorAnimation3D> compressed;
+	compressed.instantiate();
+	REQUIRE(compressed->compress(create_reach_animation(), rig.ik, 30.0) == OK);
+
+	Vector<Vector3> first_run;
+	for (int32_t frame_i = 0; frame_i < compressed->get_frame_count(); frame_i++) {
+		compressed->apply(rig.ik, frame_i / 30.0, frame_i == 0);
+		first_run.push_back(TestEWBIKFixtures::get_hand_position(rig));
+	}
+	for (int32_t frame_i = 0; frame_i < compressed->get_frame_count(); frame_i++) {
+		compressed->apply(rig.ik, frame_i / 30.0, frame_i == 0);
+		CHECK(TestEWBIKFixtures::get_hand_position(rig) == first_run[frame_i]);
+	}
+	const Vector3 target = compressed->get_effector_target(0, 1.0).origin;
+	CHECK(first_run[first_run.size() - 1].distance_to(target) < 0.05);
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKEffectorAnimation3D] Release hands the pins back to their targets") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	TestEWBIKFixtures::ArmRig other = TestEWBIKFixtures::create_arm();
+	Ref<IKEffectorAnimation3D> compressed;
+	compressed.instantiate();
+	REQUIRE(compressed->compress(create_reach_animation(), rig.ik, 30.0, PackedStringArray{ "LowerArm" }, 0.5) == OK);
+
+	// Alternating rigs re-resolves the cached hint bones each time.
+	compressed->apply(rig.ik, 0.5, true);
+	compressed->apply(other.ik, 0.5, true);
+	compressed->apply(rig.ik, 0.5, true);
+	CHECK(TestEWBIKFixtures::get_hand_position(rig) == TestEWBIKFixtures::get_hand_position(other));
+	CHECK(rig.ik->has_pin_target_transform_override(0));
+	compressed->release(rig.ik);
+	CHECK_FALSE(rig.ik->has_pin_target_transform_override(0));
+	CHECK(other.ik->has_pin_target_transform_override(0));
+
+	TestEWBIKFixtures::free_arm(rig);
+	TestEWBIKFixtures::free_arm(other);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKEffectorAnimation3D] Library measurement reports savings and error") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	TypedArray<Animation> library;
+	library.push_back(create_reach_animation());
+	library.push_back(create_reach_animation());
+
+	Dictionary report = IKEffectorAnimation3D::measure_library(library, rig.ik, 30.0);
+	CHECK(Array(report["clips"]).size() == 2);
+	CHECK(int64_t(report["saved_bytes"]) > 0);
+	CHECK(double(report["compression_ratio"]) > 1.0);
+	Dictionary bone_errors = report["bone_errors"];
+	REQUIRE(bone_errors.has("UpperArm"));
+	Dictionary upper_arm = bone_errors["UpperArm"];
+	CHECK(double(upper_arm["mean_error"]) <= double(upper_arm["max_error"]));
+	CHECK_FALSE(rig.ik->has_pin_target_transform_override(0));
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKEffectorAnimation3D
@@ -0,0 +1,182 @@
+/**************************************************************************/
+/*  test_ik_kusudama_gizmo_cache_3d.h                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#ifdef TOOLS_ENABLED
+
+#include "modules/many_bone_ik/editor/ik_kusudama_gizmo_cache_3d.h"
+#include "modules/many_bone_ik/editor/many_bone_ik_shader.h"
+#include "modules/many_bone_ik/src/ik_kusudama_3d.h"
+#include "modules/many_bone_ik/src/ik_open_cone_3d.h"
+#include "modules/many_bone_ik/tests/test_many_bone_ik_benchmark_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKKusudamaGizmoCache3D {
+
+using namespace TestManyBoneIKBenchmarkFixtures;
+
+// A kusudama with two cones a little apart, so the tangent circles are set.
+inline Ref<IKKusudama3D> create_kusudama(real_t p_radius) {
+	Ref<IKKusudama3D> kusudama;
+	kusudama.instantiate();
+	const Vector3 control_points[] = { Vector3(0, 1, 0), Vector3(0.5, 1, 0).normalized() };
+	for (const Vector3 &control_point : control_points) {
+		Ref<IKLimitCone3D> cone;
+		cone.instantiate();
+		cone->set_attached_to(kusudama);
+		cone->set_control_point(control_point);
+		cone->set_radius(p_radius);
+		kusudama->add_open_cone(cone);
+	}
+	return kusudama;
+}
+
+inline Ref<Shader> create_kusudama_shader() {
+	Ref<Shader> shader;
+	shader.instantiate();
+	shader->set_code(MANY_BONE_IKKUSUDAMA_SHADER);
+	return shader;
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKKusudamaGizmoCache3D] Only changed bones refresh their material") {
+	IKKusudamaGizmoCache3D cache;
+	cache.set_shader(create_kusudama_shader());
+	LocalVector<Ref<IKKusudama3D>> kusudamas;
+	for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+		kusudamas.push_back(create_kusudama(0.3 + 0.1 * bone_i));
+	}
+	const Color color(1, 0.8, 0.4);
+
+	LocalVector<Ref<ShaderMaterial>> first_materials;
+	cache.begin_pass();
+	for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+		first_materials.push_back(cache.get_material(bone_i, kusudamas[bone_i], color));
+	}
+	cache.end_pass();
+	CHECK_EQ(cache.get_counters().materials_created, 4u);
+	CHECK_EQ(cache.get_material_count(), 4);
+	CHECK_EQ(int32_t(first_materials[2]->get_shader_parameter("cone_count")), 2);
+	PackedFloat32Array cone_sequence = first_materials[2]->get_shader_parameter("cone_sequence");
+	CHECK(Math::is_equal_approx(cone_sequence[3], 0.5f));
+
+	SUBCASE("An unchanged pass reuses every material") {
+		cache.begin_pass();
+		for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+			CHECK(cache.get_material(bone_i, kusudamas[bone_i], color) == first_materials[bone_i]);
+		}
+		cache.end_pass();
+		CHECK_EQ(cache.get_counters().materials_reused, 4u);
+		CHECK_EQ(cache.get_counters().materials_updated, 0u);
+		CHECK_EQ(cache.get_counters().materials_created, 4u);
+	}
+
+	SUBCASE("A changed cone or color refreshes that bone only") {
+		Ref<IKLimitCone3D> cone = kusudamas[1]->get_open_cones()[0];
+		cone->set_radius(0.9);
+		kusudamas[1]->update_tangent_radii();
+		cache.begin_pass();
+		for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+			cache.get_material(bone_i, kusudamas[bone_i], bone_i == 3 ? Color(0.8, 0.3, 0.0) : color);
+		}
+		cache.end_pass();
+		CHECK_EQ(cache.get_counters().materials_updated, 2u);
+		CHECK_EQ(cache.get_counters().materials_reused, 2u);
+		cone_sequence = first_materials[1]->get_shader_parameter("cone_sequence");
+		CHECK(Math::is_equal_approx(cone_sequence[3], 0.9f));
+		CHECK(Color(first_materials[3]->get_shader_parameter("kusudama_color")).is_equal_approx(Color(0.8, 0.3, 0.0)));
+	}
+
+	SUBCASE("Bones left out of a pass are dropped") {
+		cache.begin_pass();
+		cache.get_material(0, kusudamas[0], color);
+		cache.end_pass();
+		CHECK_EQ(cache.get_material_count(), 1);
+		CHECK_EQ(cache.get_counters().materials_evicted, 3u);
+	}
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKKusudamaGizmoCache3D][Benchmark] Kusudama gizmo redraw for 300 bones" * doctest::skip()) {
+	const int32_t bone_count = 300;
+	const Ref<Shader> shader = create_kusudama_shader();
+	LocalVector<Ref<IKKusudama3D>> kusudamas;
+	for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+		kusudamas.push_back(create_kusudama(0.2 + 0.001 * bone_i));
+	}
+	const Color color(1, 0.8, 0.4);
+	Dictionary parameters;
+	parameters["bones"] = bone_count;
+	BenchmarkSettings settings;
+	settings.operations_per_sample = 4;
+
+	// What every redraw did before the cache: a new sphere and material per bone.
+	run_benchmark("kusudama_gizmo", "redraw_rebuild", parameters, settings, [&]() {
+		PackedFloat32Array cone_sequence;
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			Ref<ArrayMesh> mesh = IKKusudamaGizmoCache3D::create_unit_sphere_mesh();
+			Ref<ShaderMaterial> material;
+			material.instantiate();
+			material->set_shader(shader);
+			IKKusudamaGizmoCache3D::write_cone_sequence(kusudamas[bone_i], cone_sequence);
+			material->set_shader_parameter("cone_sequence", cone_sequence);
+			material->set_shader_parameter("cone_count", int32_t(cone_sequence.size() / 12));
+			material->set_shader_parameter("kusudama_color", color);
+		}
+	});
+
+	IKKusudamaGizmoCache3D cache;
+	cache.set_shader(shader);
+	run_benchmark("kusudama_gizmo", "redraw_cached", parameters, settings, [&]() {
+		cache.begin_pass();
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			cache.get_material(bone_i, kusudamas[bone_i], color);
+		}
+		cache.end_pass();
+	});
+	CHECK_EQ(cache.get_counters().materials_created, uint64_t(bone_count));
+
+	// One bone edited per redraw, as when dragging a cone in the inspector.
+	int32_t edited_bone = 0;
+	run_benchmark("kusudama_gizmo", "redraw_one_changed", parameters, settings, [&]() {
+		Ref<IKLimitCone3D> cone = kusudamas[edited_bone]->get_open_cones()[0];
+		cone->set_radius(cone->get_radius() + 0.001);
+		kusudamas[edited_bone]->update_tangent_radii();
+		edited_bone = (edited_bone + 1) % bone_count;
+		cache.begin_pass();
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			cache.get_material(bone_i, kusudamas[bone_i], color);
+		}
+		cache.end_pass();
+	});
+}
+
+} // namespace TestIKKusudamaGizmoCache3D
+
+#endif // TOOLS_ENABLED
@@ -0,0 +1,195 @@
+/**************************************************************************/
+/*  test_ik_pose_snapshot_3d.h                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "modules/many_bone_ik/src/ik_pose_snapshot_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKPoseSnapshot3D {
+
+TestEWBIKFixtures::ArmRig create_solved_arm() {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->solve();
+	rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(), Vector3(1.0, 2.2, 0.5)));
+	rig.ik->solve();
+	return rig;
+}
+
+int32_t get_bits_for_entry(const Ref<IKPoseSnapshot3D> &p_snapshot, const TestEWBIKFixtures::ArmRig &p_rig, int32_t p_index) {
+	if (p_snapshot->is_bone_root(p_index)) {
+		return p_snapshot->get_root_rotation_bits();
+	}
+	if (p_snapshot->get_bone_index(p_index) == p_rig.skeleton->find_bone("Hand")) {
+		return p_snapshot->get_effector_rotation_bits();
+	}
+	return p_snapshot->get_chain_rotation_bits();
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKPoseSnapshot3D] Round trip stays within the error bound") {
+	TestEWBIKFixtures::ArmRig sender = create_solved_arm();
+	TestEWBIKFixtures::ArmRig receiver = TestEWBIKFixtures::create_arm();
+	Ref<IKPoseSnapshot3D> snapshot;
+	snapshot.instantiate();
+	snapshot->set_chain_rotation_bits(9);
+	REQUIRE(snapshot->capture(sender.ik) == OK);
+	CHECK_FALSE(snapshot->is_delta());
+	REQUIRE(snapshot->get_bone_count() > 0);
+
+	Ref<IKPoseSnapshot3D> received;
+	received.instantiate();
+	REQUIRE(received->decode(snapshot->get_data()) == OK);
+	CHECK(received->get_chain_rotation_bits() == 9);
+	received->apply(receiver.skeleton);
+	for (int32_t entry_i = 0; entry_i < received->get_bone_count(); entry_i++) {
+		const int32_t bone = received->get_bone_index(entry_i);
+		const double bound = IKPoseSnapshot3D::get_rotation_error_bound(get_bits_for_entry(received, sender, entry_i));
+		CHECK(receiver.skeleton->get_bone_pose_rotation(bone).angle_to(sender.skeleton->get_bone_pose_rotation(bone)) <= bound + 1e-5);
+	}
+	CHECK(TestEWBIKFixtures::get_hand_position(receiver).distance_to(TestEWBIKFixtures::get_hand_position(sender)) < 0.05);
+
+	TestEWBIKFixtures::free_arm(sender);
+	TestEWBIKFixtures::free_arm(receiver);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKPoseSnapshot3D] Quantization error never exceeds the bound") {
+	TestEWBIKFixtures::ArmRig rig = create_solved_arm();
+	Ref<IKPoseSnapshot3D> snapshot;
+	snapshot.instantiate();
+	RandomPCG rng(7);
+	const int32_t bone = rig.skeleton->find_bone("LowerArm");
+	for (int32_t bits : { 6, 10, 16 }) {
+		snapshot->set_chain_rotation_bits(bits);
+		double worst = 0.0;
+		for (int32_t sample_i = 0; sample_i < 500; sample_i++) {
+			const Quaternion rotation = Quaternion(rng.randfn(), rng.randfn(), rng.randfn(), rng.randfn()).normalized();
+			rig.skeleton->set_bone_pose_rotation(bone, rotation);
+			REQUIRE(snapshot->capture(rig.ik) == OK);
+			for (int32_t entry_i = 0; entry_i < snapshot->get_bone_count(); entry_i++) {
+				if (snapshot->get_bone_index(entry_i) == bone) {
+					worst = MAX(worst, snapshot->get_bone_rotation(entry_i).angle_to(rotation));
+				}
+			}
+		}
+		CHECK(worst <= IKPoseSnapshot3D::get_rotation_error_bound(bits) + 1e-5);
+	}
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKPoseSnapshot3D] Delta snapshots only carry changed bones") {
+	TestEWBIKFixtures::ArmRig sender = create_solved_arm();
+	Ref<IKPoseSnapshot3D> baseline;
+	baseline.instantiate();
+	REQUIRE(baseline->capture(sender.ik) == OK);
+
+	Ref<IKPoseSnapshot3D> unchanged;
+	unchanged.instantiate();
+	REQUIRE(unchanged->capture(sender.ik, baseline) == OK);
+	CHECK(unchanged->is_delta());
+	CHECK(unchanged->get_data().size() < baseline->get_data().size());
+
+	sender.skeleton->set_bone_pose_rotation(sender.skeleton->find_bone("LowerArm"), Quaternion(Vector3(1, 0, 0), 0.3));
+	Ref<IKPoseSnapshot3D> changed;
+	changed.instantiate();
+	REQUIRE(changed->capture(sender.ik, baseline) == OK);
+	CHECK(changed->is_delta());
+
+	Ref<IKPoseSnapshot3D> received_baseline;
+	received_baseline.instantiate();
+	REQUIRE(received_baseline->decode(baseline->get_data()) == OK);
+	Ref<IKPoseSnapshot3D> received;
+	received.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(received->decode(changed->get_data()) == ERR_INVALID_PARAMETER);
+	ERR_PRINT_ON;
+	REQUIRE(received->decode(changed->get_data(), received_baseline) == OK);
+	for (int32_t entry_i = 0; entry_i < changed->get_bone_count(); entry_i++) {
+		CHECK(received->get_bone_rotation(entry_i).is_equal_approx(changed->get_bone_rotation(entry_i)));
+	}
+
+	// A baseline taken with another bit budget cannot be used as a reference.
+	Ref<IKPoseSnapshot3D> other_budget;
+	other_budget.instantiate();
+	other_budget->set_chain_rotation_bits(12);
+	REQUIRE(other_budget->capture(sender.ik, baseline) == OK);
+	CHECK_FALSE(other_budget->is_delta());
+
+	TestEWBIKFixtures::free_arm(sender);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKPoseSnapshot3D] Truncated data is rejected") {
+	TestEWBIKFixtures::ArmRig rig = create_solved_arm();
+	Ref<IKPoseSnapshot3D> snapshot;
+	snapshot.instantiate();
+	REQUIRE(snapshot->capture(rig.ik) == OK);
+	PackedByteArray truncated = snapshot->get_data();
+	truncated.resize(truncated.size() - 1);
+	Ref<IKPoseSnapshot3D> received;
+	received.instantiate();
+	ERR_PRINT_OFF;
+	CHECK(received->decode(truncated) == ERR_INVALID_DATA);
+	ERR_PRINT_ON;
+	CHECK(received->get_bone_count() == 0);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKPoseSnapshot3D][Benchmark] Encode and decode throughput" * doctest::skip()) {
+	TestEWBIKFixtures::ArmRig rig = create_solved_arm();
+	Ref<IKPoseSnapshot3D> baseline;
+	baseline.instantiate();
+	REQUIRE(baseline->capture(rig.ik) == OK);
+	Ref<IKPoseSnapshot3D> snapshot;
+	snapshot.instantiate();
+	Ref<IKPoseSnapshot3D> received;
+	received.instantiate();
+	const int32_t iterations = 100000;
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int32_t iteration_i = 0; iteration_i < iterations; iteration_i++) {
+		snapshot->capture(rig.ik, baseline);
+	}
+	const uint64_t encode_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int32_t iteration_i = 0; iteration_i < iterations; iteration_i++) {
+		received->decode(snapshot->get_data(), baseline);
+		received->apply(rig.skeleton);
+	}
+	const uint64_t decode_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	MESSAGE(vformat("%d bones, %d bytes full, %d bytes delta", baseline->get_bone_count(), baseline->get_data().size(), snapshot->get_data().size()));
+	MESSAGE(vformat("encode: %.1f snapshots/ms, decode and apply: %.1f snapshots/ms", iterations * 1000.0 / MAX(encode_usec, uint64_t(1)), iterations * 1000.0 / MAX(decode_usec, uint64_t(1))));
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKPoseSnapshot3D
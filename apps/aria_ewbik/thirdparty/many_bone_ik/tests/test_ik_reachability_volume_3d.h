@@ -0,0 +1,132 @@
+/**************************************************************************/
+/*  test_ik_reachability_volume_3d.h                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_reachability_volume_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKReachabilityVolume3D {
+
+Vector<IKReachabilityVolume3D::Link> create_two_bone_chain() {
+	Vector<IKReachabilityVolume3D::Link> links;
+	IKReachabilityVolume3D::Link link;
+	links.push_back(link);
+	link.rest.origin = Vector3(0, 1, 0);
+	links.push_back(link);
+	links.push_back(link);
+	return links;
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKReachabilityVolume3D] Bake is deterministic for a fixed seed") {
+	Ref<IKReachabilityVolume3D> volume_a;
+	volume_a.instantiate();
+	Ref<IKReachabilityVolume3D> volume_b;
+	volume_b.instantiate();
+	const Vector<IKReachabilityVolume3D::Link> links = create_two_bone_chain();
+
+	int32_t effector_a = volume_a->bake_effector("Hand", links, 16, 8192, 42);
+	int32_t effector_b = volume_b->bake_effector("Hand", links, 16, 8192, 42);
+	REQUIRE(effector_a == 0);
+	REQUIRE(effector_b == 0);
+	CHECK(volume_a->get_effector_quality(effector_a) == volume_b->get_effector_quality(effector_b));
+	CHECK(volume_a->get_effector_bounds(effector_a).is_equal_approx(AABB(Vector3(-2, -2, -2), Vector3(4, 4, 4))));
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKReachabilityVolume3D] Lookup separates reachable and unreachable targets") {
+	Ref<IKReachabilityVolume3D> volume;
+	volume.instantiate();
+	int32_t effector = volume->bake_effector("Hand", create_two_bone_chain(), 16, 65536, 7);
+	REQUIRE(effector != -1);
+	CHECK(volume->find_effector("Hand") == effector);
+	CHECK(volume->find_effector("Foot") == -1);
+
+	CHECK(volume->is_reachable(effector, Vector3(0, 1.5, 0)));
+	CHECK(volume->is_reachable(effector, Vector3(1.2, 0, 0.6)));
+	CHECK_FALSE(volume->is_reachable(effector, Vector3(0, 3, 0)));
+	CHECK_FALSE(volume->is_reachable(effector, Vector3(1.95, 1.95, 1.95)));
+	CHECK(volume->get_reachability(effector, Vector3(1.95, 1.95, 1.95)) == 0.0f);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKReachabilityVolume3D] Unreachable targets clamp to the nearest reachable cell") {
+	Ref<IKReachabilityVolume3D> volume;
+	volume.instantiate();
+	int32_t effector = volume->bake_effector("Hand", create_two_bone_chain(), 16, 65536, 7);
+	REQUIRE(effector != -1);
+
+	const Vector3 inside = Vector3(0.5, 0.5, 0);
+	CHECK(volume->get_nearest_reachable(effector, inside) == inside);
+
+	const Vector3 clamped = volume->get_nearest_reachable(effector, Vector3(0, 10, 0));
+	CHECK(volume->is_reachable(effector, clamped));
+	CHECK(clamped.y > 1.5);
+	CHECK(clamped.length() <= 2.0 + volume->get_effector_bounds(effector).size.x / 16.0);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKReachabilityVolume3D] Sample counts that do not divide into batches are all used") {
+	Ref<IKReachabilityVolume3D> even;
+	even.instantiate();
+	Ref<IKReachabilityVolume3D> uneven;
+	uneven.instantiate();
+	// 127 samples used to bake the same 64 as 64 samples do.
+	REQUIRE(even->bake_effector("Hand", create_two_bone_chain(), 16, IKReachabilityVolume3D::BAKE_BATCH_COUNT, 5) != -1);
+	REQUIRE(uneven->bake_effector("Hand", create_two_bone_chain(), 16, 2 * IKReachabilityVolume3D::BAKE_BATCH_COUNT - 1, 5) != -1);
+	CHECK(even->get_effector_quality(0) != uneven->get_effector_quality(0));
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKReachabilityVolume3D] Stored data round trips") {
+	Ref<IKReachabilityVolume3D> volume;
+	volume.instantiate();
+	int32_t effector = volume->bake_effector("Hand", create_two_bone_chain(), 8, 4096, 3);
+	REQUIRE(effector != -1);
+
+	Ref<IKReachabilityVolume3D> copy;
+	copy.instantiate();
+	copy->set("_data", volume->get("_data"));
+	REQUIRE(copy->get_effector_count() == 1);
+	CHECK(copy->get_effector_bone(0) == StringName("Hand"));
+	CHECK(copy->get_effector_resolution(0) == 8);
+	CHECK(copy->get_effector_quality(0) == volume->get_effector_quality(effector));
+	CHECK(copy->get_nearest_reachable(0, Vector3(0, 10, 0)) == volume->get_nearest_reachable(effector, Vector3(0, 10, 0)));
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKReachabilityVolume3D] Reachability queries use the pin target override") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->solve();
+	REQUIRE(rig.ik->bake_reachability_volume(16, 65536, 7).is_valid());
+	rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(), Vector3(0, 10, 0)));
+	const EWBIK3D *ik = rig.ik;
+	CHECK_FALSE(ik->is_pin_target_reachable(0));
+	CHECK(ik->has_pin_target_transform_override(0));
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKReachabilityVolume3D
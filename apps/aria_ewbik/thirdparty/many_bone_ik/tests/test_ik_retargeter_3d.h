@@ -0,0 +1,251 @@
+/**************************************************************************/
+/*  test_ik_retargeter_3d.h                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_retargeter_3d.h"
+#include "modules/many_bone_ik/src/many_bone_ik_3d.h"
+#include "scene/3d/skeleton_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/window.h"
+#include "tests/test_macros.h"
+
+#ifdef MODULE_GLTF_ENABLED
+#include "modules/gltf/gltf_document.h"
+#include "modules/gltf/gltf_state.h"
+#endif
+
+namespace TestIKRetargeter3D {
+
+Skeleton3D *create_chain(const Vector<String> &p_names, const Vector<Transform3D> &p_rests) {
+	Skeleton3D *skeleton = memnew(Skeleton3D);
+	skeleton->set_name("Skeleton3D");
+	for (int32_t bone_i = 0; bone_i < p_names.size(); bone_i++) {
+		skeleton->add_bone(p_names[bone_i]);
+		skeleton->set_bone_rest(bone_i, p_rests[bone_i]);
+		if (bone_i > 0) {
+			skeleton->set_bone_parent(bone_i, bone_i - 1);
+		}
+	}
+	skeleton->reset_bone_poses();
+	return skeleton;
+}
+
+Ref<Animation> create_swing(const String &p_skeleton, const String &p_bone, double p_angle) {
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length(1.0);
+	const int32_t track = animation->add_track(Animation::TYPE_ROTATION_3D);
+	animation->track_set_path(track, NodePath(p_skeleton + ":" + p_bone));
+	animation->rotation_track_insert_key(track, 0.0, Quaternion());
+	animation->rotation_track_insert_key(track, 1.0, Quaternion(Vector3(0, 0, 1), p_angle));
+	return animation;
+}
+
+void apply_animation(const Ref<Animation> &p_animation, Skeleton3D *p_skeleton, double p_time) {
+	p_skeleton->reset_bone_poses();
+	for (int32_t track_i = 0; track_i < p_animation->get_track_count(); track_i++) {
+		const int32_t bone = p_skeleton->find_bone(p_animation->track_get_path(track_i).get_concatenated_subnames());
+		if (bone == -1) {
+			continue;
+		}
+		if (p_animation->track_get_type(track_i) == Animation::TYPE_ROTATION_3D) {
+			Quaternion rotation;
+			p_animation->try_rotation_track_interpolate(track_i, p_time, &rotation);
+			p_skeleton->set_bone_pose_rotation(bone, rotation);
+		} else if (p_animation->track_get_type(track_i) == Animation::TYPE_POSITION_3D) {
+			Vector3 position;
+			p_animation->try_position_track_interpolate(track_i, p_time, &position);
+			p_skeleton->set_bone_pose_position(bone, position);
+		}
+	}
+}
+
+Vector3 get_bone_direction(Skeleton3D *p_skeleton, const String &p_from, const String &p_to) {
+	const Vector3 from = p_skeleton->get_bone_global_pose(p_skeleton->find_bone(p_from)).origin;
+	const Vector3 to = p_skeleton->get_bone_global_pose(p_skeleton->find_bone(p_to)).origin;
+	return (to - from).normalized();
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKRetargeter3D] Retargeted bones point where the source bones point") {
+	// The source arm rests along +Y; the target arm rests along +X and is longer.
+	Skeleton3D *source = create_chain({ "Root", "Arm", "Hand" }, { Transform3D(), Transform3D(Basis(), Vector3(0, 1, 0)), Transform3D(Basis(), Vector3(0, 1, 0)) });
+	Skeleton3D *target = create_chain({ "root", "arm", "hand" }, { Transform3D(), Transform3D(Basis(), Vector3(2, 0, 0)), Transform3D(Basis(), Vector3(2, 0, 0)) });
+	Dictionary bone_map;
+	bone_map["Root"] = "root";
+	bone_map["Arm"] = "arm";
+	bone_map["Hand"] = "hand";
+
+	Ref<IKRetargeter3D> retargeter;
+	retargeter.instantiate();
+	REQUIRE(retargeter->setup(source, target, bone_map) == OK);
+	CHECK(retargeter->get_scale() == doctest::Approx(2.0));
+	CHECK(retargeter->get_bone_alignment("arm").xform(Vector3(0, 1, 0)).distance_to(Vector3(1, 0, 0)) < 1e-3);
+
+	Ref<Animation> swing = create_swing("Skeleton3D", "Arm", Math::PI / 3.0);
+	Ref<Animation> retargeted = retargeter->retarget(swing);
+	REQUIRE(retargeted.is_valid());
+	for (double time : { 0.0, 0.5, 1.0 }) {
+		apply_animation(swing, source, time);
+		apply_animation(retargeted, target, time);
+		CHECK(get_bone_direction(target, "arm", "hand").distance_to(get_bone_direction(source, "Arm", "Hand")) < 1e-3);
+	}
+
+	memdelete(source);
+	memdelete(target);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKRetargeter3D] Library conversion matches single clip conversion") {
+	Skeleton3D *source = create_chain({ "Root", "Arm", "Hand" }, { Transform3D(), Transform3D(Basis(), Vector3(0, 1, 0)), Transform3D(Basis(), Vector3(0, 1, 0)) });
+	Skeleton3D *target = create_chain({ "Root", "Arm", "Hand" }, { Transform3D(), Transform3D(Basis(Vector3(0, 0, 1), -Math::PI / 4.0), Vector3(0, 1, 0)), Transform3D(Basis(), Vector3(0, 1, 0)) });
+	Dictionary bone_map;
+	bone_map["Root"] = "Root";
+	bone_map["Arm"] = "Arm";
+	bone_map["Hand"] = "Hand";
+	Ref<IKRetargeter3D> retargeter;
+	retargeter.instantiate();
+	REQUIRE(retargeter->setup(source, target, bone_map) == OK);
+
+	TypedArray<Animation> library;
+	for (int32_t clip_i = 0; clip_i < 32; clip_i++) {
+		library.push_back(create_swing("Skeleton3D", "Arm", 0.05 * clip_i));
+	}
+	TypedArray<Animation> converted = retargeter->retarget_library(library);
+	REQUIRE(converted.size() == library.size());
+	for (int32_t clip_i = 0; clip_i < library.size(); clip_i++) {
+		Ref<Animation> single = retargeter->retarget(library[clip_i]);
+		Ref<Animation> batched = converted[clip_i];
+		REQUIRE(batched.is_valid());
+		REQUIRE(batched->get_track_count() == single->get_track_count());
+		for (int32_t track_i = 0; track_i < single->get_track_count(); track_i++) {
+			REQUIRE(batched->track_get_key_count(track_i) == single->track_get_key_count(track_i));
+			const int32_t last = single->track_get_key_count(track_i) - 1;
+			CHECK(batched->track_get_key_value(track_i, last) == single->track_get_key_value(track_i, last));
+		}
+	}
+
+	memdelete(source);
+	memdelete(target);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKRetargeter3D] Drift correction keeps effectors in the target's root frame") {
+	// The target chain is offset, turned and longer than the source, so source
+	// space positions would pull the hand far away from the retargeted pose.
+	Skeleton3D *source = create_chain({ "Root", "Arm", "Hand" }, { Transform3D(), Transform3D(Basis(), Vector3(0, 1, 0)), Transform3D(Basis(), Vector3(0, 1, 0)) });
+	Skeleton3D *target = create_chain({ "root", "arm", "hand" }, { Transform3D(Basis(), Vector3(3, 0, 1)), Transform3D(Basis(), Vector3(2, 0, 0)), Transform3D(Basis(), Vector3(2, 0, 0)) });
+	SceneTree::get_singleton()->get_root()->add_child(target);
+	EWBIK3D *ik = memnew(EWBIK3D);
+	target->add_child(ik);
+	ik->set_pin_count(1);
+	ik->set_pin_bone_name(0, "hand");
+	ik->set_iterations_per_frame(10);
+	Dictionary bone_map;
+	bone_map["Root"] = "root";
+	bone_map["Arm"] = "arm";
+	bone_map["Hand"] = "hand";
+	Ref<IKRetargeter3D> retargeter;
+	retargeter.instantiate();
+	REQUIRE(retargeter->setup(source, target, bone_map) == OK);
+
+	Ref<Animation> swing = create_swing("Skeleton3D", "Arm", Math::PI / 3.0);
+	Ref<Animation> retargeted = retargeter->retarget(swing);
+	Ref<Animation> corrected = retargeter->retarget(swing, ik);
+	REQUIRE(retargeted.is_valid());
+	REQUIRE(corrected.is_valid());
+	const int32_t hand = target->find_bone("hand");
+	for (double time : { 0.0, 0.5, 1.0 }) {
+		apply_animation(retargeted, target, time);
+		const Vector3 expected = target->get_bone_global_pose(hand).origin;
+		apply_animation(corrected, target, time);
+		CHECK(target->get_bone_global_pose(hand).origin.distance_to(expected) < 0.05);
+	}
+
+	memdelete(source);
+	memdelete(target);
+}
+
+#ifdef MODULE_GLTF_ENABLED
+Node *load_gltf(const String &p_file) {
+	Ref<GLTFDocument> document;
+	document.instantiate();
+	Ref<GLTFState> state;
+	state.instantiate();
+	const String path = String(__FILE__).get_base_dir().path_join("data").path_join(p_file);
+	if (document->append_from_file(path, state) != OK) {
+		return nullptr;
+	}
+	return document->generate_scene(state);
+}
+
+Skeleton3D *find_skeleton(Node *p_scene) {
+	TypedArray<Node> skeletons = p_scene->find_children("*", "Skeleton3D", true, false);
+	return skeletons.is_empty() ? nullptr : Object::cast_to<Skeleton3D>(skeletons[0]);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKRetargeter3D] Retargets a T-pose clip onto an A-pose glTF skeleton") {
+	Node *source_scene = load_gltf("retarget_source_t_pose.gltf");
+	Node *target_scene = load_gltf("retarget_target_a_pose.gltf");
+	REQUIRE(source_scene);
+	REQUIRE(target_scene);
+	Skeleton3D *source = find_skeleton(source_scene);
+	Skeleton3D *target = find_skeleton(target_scene);
+	REQUIRE(source);
+	REQUIRE(target);
+
+	Dictionary bone_map;
+	bone_map["Hips"] = "hips";
+	bone_map["Spine"] = "spine";
+	bone_map["Arm"] = "upper_arm";
+	bone_map["Forearm"] = "lower_arm";
+	bone_map["Hand"] = "hand";
+	Ref<IKRetargeter3D> retargeter;
+	retargeter.instantiate();
+	REQUIRE(retargeter->setup(source, target, bone_map) == OK);
+
+	// The A-pose arm hangs 45 degrees below the T-pose arm.
+	const Vector3 a_pose_arm = retargeter->get_bone_alignment("upper_arm").xform(Vector3(1, 0, 0));
+	CHECK(a_pose_arm.distance_to(Vector3(Math::SQRT12, -Math::SQRT12, 0)) < 1e-3);
+
+	Ref<Animation> swing = create_swing(source->get_name(), "Arm", Math::PI / 4.0);
+	Ref<Animation> retargeted = retargeter->retarget(swing);
+	REQUIRE(retargeted.is_valid());
+	for (double time : { 0.0, 1.0 }) {
+		apply_animation(swing, source, time);
+		apply_animation(retargeted, target, time);
+		CHECK(get_bone_direction(target, "upper_arm", "lower_arm").distance_to(get_bone_direction(source, "Arm", "Forearm")) < 1e-3);
+		CHECK(get_bone_direction(target, "lower_arm", "hand").distance_to(get_bone_direction(source, "Forearm", "Hand")) < 1e-3);
+	}
+
+	memdelete(source_scene);
+	memdelete(target_scene);
+}
+#endif // MODULE_GLTF_ENABLED
+
+} // namespace TestIKRetargeter3D
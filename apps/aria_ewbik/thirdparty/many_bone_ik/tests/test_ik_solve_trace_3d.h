@@ -0,0 +1,99 @@
+/**************************************************************************/
+/*  test_ik_solve_trace_3d.h                                              */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_solve_trace_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKSolveTrace3D {
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKSolveTrace3D] The recording ring keeps the latest frames") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm(true);
+	rig.ik->set_solve_recording_frames(3);
+	rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(Vector3(0, 0, 1), 0.4), Vector3(1.0, 2.0, 0.3)));
+	for (int32_t solve_i = 0; solve_i < 5; solve_i++) {
+		rig.ik->solve();
+	}
+
+	Ref<IKSolveTrace3D> trace = rig.ik->dump_solve_recording();
+	REQUIRE(trace->get_frame_count() == 3);
+	for (int32_t frame_i = 0; frame_i < 3; frame_i++) {
+		CHECK(trace->get_frame_number(frame_i) == 2 + frame_i);
+		CHECK(trace->get_frame_iteration_count(frame_i) == 10);
+		REQUIRE(trace->get_record_count(frame_i) > 0);
+	}
+
+	const Dictionary first = trace->get_record(0, 0);
+	CHECK(int32_t(first["iteration"]) == 0);
+	CHECK(int32_t(first["bone"]) >= 0);
+	const PackedVector3Array tip_headings = first["tip_headings"];
+	const PackedVector3Array target_headings = first["target_headings"];
+	const PackedFloat32Array weights = first["weights"];
+	CHECK(tip_headings.size() > 1);
+	CHECK(tip_headings.size() == target_headings.size());
+	CHECK(tip_headings.size() == weights.size());
+	CHECK(Quaternion(first["post_constraint_rotation"]).is_normalized());
+
+	const int32_t last_frame = trace->get_frame_count() - 1;
+	IKSolveTrace3D::Record last;
+	REQUIRE(trace->read_record(last_frame, trace->get_record_count(last_frame) - 1, last));
+	CHECK(last.iteration == 9);
+	CHECK(last.msd >= 0.0f);
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKSolveTrace3D] Saved recordings load back and reject bad data") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->set_solve_recording_frames(2);
+	rig.ik->solve();
+	const PackedByteArray data = rig.ik->dump_solve_recording()->get_data();
+
+	Ref<IKSolveTrace3D> loaded;
+	loaded.instantiate();
+	REQUIRE(loaded->set_data(data) == OK);
+	CHECK(loaded->get_frame_count() == 1);
+	CHECK(loaded->get_data() == data);
+
+	PackedByteArray truncated = data;
+	truncated.resize(data.size() - 3);
+	ERR_PRINT_OFF;
+	CHECK(loaded->set_data(truncated) == ERR_INVALID_DATA);
+	ERR_PRINT_ON;
+	CHECK(loaded->get_frame_count() == 1);
+
+	rig.ik->clear_solve_recording();
+	CHECK(rig.ik->dump_solve_recording()->get_frame_count() == 0);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKSolveTrace3D
@@ -0,0 +1,122 @@
+/**************************************************************************/
+/*  test_ik_target_recording_3d.h                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_target_recording_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKTargetRecording3D {
+
+static Ref<IKTargetRecording3D> record_arm(TestEWBIKFixtures::ArmRig &r_rig) {
+	REQUIRE(r_rig.ik->start_target_recording() == OK);
+	CHECK(r_rig.ik->is_target_recording());
+	for (int32_t frame_i = 0; frame_i < 6; frame_i++) {
+		const real_t angle = 0.3 * frame_i;
+		r_rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(Vector3(0, 0, 1), angle), Vector3(Math::cos(angle), 2.0, Math::sin(angle))));
+		r_rig.ik->solve();
+	}
+	Ref<IKTargetRecording3D> recording = r_rig.ik->stop_target_recording();
+	CHECK_FALSE(r_rig.ik->is_target_recording());
+	return recording;
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKTargetRecording3D] Recorded frames replay to the same poses") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm(true);
+	Ref<IKTargetRecording3D> recording = record_arm(rig);
+	REQUIRE(recording.is_valid());
+	REQUIRE(recording->get_frame_count() == 6);
+	CHECK(recording->get_bone_count() == 4);
+	CHECK(recording->get_pin_count() == 1);
+	CHECK(recording->get_frame_iterations(0) == 10);
+	CHECK(recording->get_frame_delta(0) == 0.0);
+	CHECK(recording->get_frame_pin_target(5, 0).origin.is_equal_approx(Vector3(Math::cos(1.5f), 2.0, Math::sin(1.5f))));
+	const int32_t hand = rig.skeleton->find_bone("Hand");
+	CHECK(recording->get_frame_solved_pose(5, hand).origin.is_equal_approx(rig.skeleton->get_bone_pose_position(hand)));
+
+	// Start from a different pose and configuration; the replay uses the recorded ones.
+	rig.skeleton->reset_bone_poses();
+	rig.ik->set_iterations_per_frame(3);
+	rig.ik->clear_pin_target_transform_overrides();
+	const Dictionary result = rig.ik->replay_target_recording(recording);
+	CHECK(int32_t(result["frames"]) == 6);
+	CHECK(bool(result["matched"]));
+	CHECK(int32_t(result["first_mismatched_frame"]) == -1);
+	CHECK(float(result["max_position_error"]) < 0.0001f);
+	CHECK(rig.ik->get_iterations_per_frame() == 3);
+	CHECK_FALSE(rig.ik->has_pin_target_transform_override(0));
+	// The skeleton is back in the reset pose it had before the replay.
+	CHECK(rig.skeleton->get_bone_pose_rotation(hand) == rig.skeleton->get_bone_rest(hand).basis.get_rotation_quaternion());
+	CHECK(TestEWBIKFixtures::get_hand_position(rig).is_equal_approx(Vector3(0, 3, 0)));
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKTargetRecording3D] Replay reports frames that diverge") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKTargetRecording3D> recording = record_arm(rig);
+	// Pinning a different bone changes what the targets pull on.
+	rig.ik->set_pin_bone_name(0, "LowerArm");
+	const Dictionary result = rig.ik->replay_target_recording(recording);
+	CHECK_FALSE(bool(result["matched"]));
+	CHECK(int32_t(result["first_mismatched_frame"]) >= 0);
+	CHECK(float(result["max_position_error"]) + float(result["max_rotation_error"]) > 0.0001f);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKTargetRecording3D] Recordings round trip and reject bad data") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	Ref<IKTargetRecording3D> recording = record_arm(rig);
+	const PackedByteArray data = recording->get_data();
+	CHECK(data.size() == int64_t(IKTargetRecording3D::HEADER_SIZE + 6 * (IKTargetRecording3D::FRAME_HEADER_SIZE + 4 * (IKTargetRecording3D::INPUT_POSE_SIZE + IKTargetRecording3D::SOLVED_POSE_SIZE) + IKTargetRecording3D::TARGET_SIZE)));
+
+	Ref<IKTargetRecording3D> loaded;
+	loaded.instantiate();
+	CHECK(loaded->set_data(data) == OK);
+	CHECK(loaded->get_data() == data);
+	CHECK(loaded->get_frame_count() == 6);
+
+	ERR_PRINT_OFF;
+	PackedByteArray truncated = data;
+	truncated.resize(truncated.size() - 1);
+	CHECK(loaded->set_data(truncated) == ERR_INVALID_DATA);
+	CHECK(loaded->set_data(PackedByteArray()) == ERR_INVALID_DATA);
+	CHECK(loaded->get_frame_count() == 6);
+	TestEWBIKFixtures::ArmRig other = TestEWBIKFixtures::create_arm();
+	other.skeleton->add_bone("Finger");
+	CHECK(Dictionary(other.ik->replay_target_recording(recording)).is_empty());
+	ERR_PRINT_ON;
+
+	TestEWBIKFixtures::free_arm(other);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKTargetRecording3D
@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*  test_ik_trace_3d.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/json.h"
+#include "core/os/thread.h"
+#include "modules/many_bone_ik/src/ik_trace_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestIKTrace3D {
+
+TEST_CASE("[Modules][ManyBoneIK][IKTrace3D] Scopes export valid Chrome trace JSON") {
+	if (!IKTrace3D::is_available()) {
+		ERR_PRINT_OFF;
+		CHECK(IKTrace3D::start() == ERR_UNAVAILABLE);
+		ERR_PRINT_ON;
+		CHECK_FALSE(IKTrace3D::is_capturing());
+	}
+	IKTrace3D::start_capture();
+	{
+		IKTrace3D::Scope outer("outer", 42);
+		IKTrace3D::Scope inner("inner");
+		OS::get_singleton()->delay_usec(100);
+	}
+	IKTrace3D::stop();
+	{
+		IKTrace3D::Scope ignored("ignored");
+	}
+	REQUIRE(IKTrace3D::get_event_count() == 2);
+	CHECK(IKTrace3D::get_dropped_event_count() == 0);
+
+	Ref<JSON> json;
+	json.instantiate();
+	REQUIRE(json->parse(IKTrace3D::to_json()) == OK);
+	const Dictionary root = json->get_data();
+	CHECK(String(root["displayTimeUnit"]) == "ms");
+	const Array trace_events = root["traceEvents"];
+	REQUIRE(trace_events.size() == 2);
+	// Scopes record when they close, so the inner one comes first.
+	const Dictionary inner = trace_events[0];
+	const Dictionary outer = trace_events[1];
+	CHECK(String(inner["name"]) == "inner");
+	CHECK(String(outer["name"]) == "outer");
+	for (const Dictionary &event : { inner, outer }) {
+		CHECK(String(event["ph"]) == "X");
+		CHECK(String(event["cat"]) == "ewbik");
+		CHECK(int64_t(event["tid"]) == int64_t(Thread::get_caller_id()));
+	}
+	CHECK_FALSE(inner.has("args"));
+	CHECK(int64_t(Dictionary(outer["args"])["instance"]) == 42);
+	CHECK(double(inner["dur"]) >= 100.0);
+	CHECK(double(inner["ts"]) >= double(outer["ts"]));
+	CHECK(double(inner["ts"]) + double(inner["dur"]) <= double(outer["ts"]) + double(outer["dur"]));
+
+	IKTrace3D::clear();
+	CHECK(IKTrace3D::get_event_count() == 0);
+	REQUIRE(json->parse(IKTrace3D::to_json()) == OK);
+	CHECK(Array(Dictionary(json->get_data())["traceEvents"]).is_empty());
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][IKTrace3D] Captured solve exports valid Chrome trace JSON") {
+	if (!IKTrace3D::is_available()) {
+		// The solver's IK_TRACE_* scopes are compiled out; there is nothing to capture.
+		return;
+	}
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm(true);
+	REQUIRE(EWBIK3D::start_trace() == OK);
+	rig.ik->solve();
+	rig.ik->solve();
+	IKTrace3D::stop();
+	const uint32_t event_count = IKTrace3D::get_event_count();
+	rig.ik->solve();
+	CHECK(IKTrace3D::get_event_count() == event_count);
+
+	Ref<JSON> json;
+	json.instantiate();
+	REQUIRE(json->parse(IKTrace3D::to_json()) == OK);
+	const Dictionary root = json->get_data();
+	REQUIRE(root.has("traceEvents"));
+	const Array trace_events = root["traceEvents"];
+	CHECK(uint32_t(trace_events.size()) == event_count);
+
+	HashSet<String> names;
+	for (int32_t event_i = 0; event_i < trace_events.size(); event_i++) {
+		const Dictionary event = trace_events[event_i];
+		CHECK(String(event["ph"]) == "X");
+		CHECK(event.has("tid"));
+		CHECK(double(event["ts"]) >= 0.0);
+		CHECK(double(event["dur"]) >= 0.0);
+		names.insert(event["name"]);
+	}
+	CHECK(names.has("EWBIK3D::_process_modification"));
+	CHECK(names.has("EWBIK3D::_bone_list_changed"));
+	CHECK(names.has("IKBoneSegment3D::segment_solver"));
+	CHECK(names.has("IKBoneSegment3D::_set_optimal_rotation"));
+	CHECK(names.has("QCP::weighted_superpose"));
+
+	IKTrace3D::clear();
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestIKTrace3D
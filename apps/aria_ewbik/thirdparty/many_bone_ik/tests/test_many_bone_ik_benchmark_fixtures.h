@@ -0,0 +1,106 @@
+/**************************************************************************/
+/*  test_many_bone_ik_benchmark_fixtures.h                                */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/os/os.h"
+#include "core/templates/local_vector.h"
+#include "core/variant/dictionary.h"
+#include "tests/test_macros.h"
+
+// Benchmarks are tagged [Benchmark] and skipped by default. Run them with
+//   godot --test --test-case="*[Benchmark]*" --no-skip
+// Each result is printed as one JSON object per line. Set
+// MANY_BONE_IK_BENCHMARK_OUTPUT to a file path to also append the lines
+// there, so runs from two commits can be diffed or fed to a comparison script.
+namespace TestManyBoneIKBenchmarkFixtures {
+
+struct BenchmarkSettings {
+	int32_t warmup_samples = 3;
+	int32_t samples = 15;
+	int32_t operations_per_sample = 1000;
+};
+
+// p_metrics holds derived figures that are not timings, such as memory use.
+inline void emit_result(const String &p_suite, const String &p_name, const Dictionary &p_parameters, const LocalVector<double> &p_sample_nsec_per_operation, const Dictionary &p_metrics = Dictionary()) {
+	LocalVector<double> sorted = p_sample_nsec_per_operation;
+	sorted.sort();
+	Dictionary result;
+	result["suite"] = p_suite;
+	result["name"] = p_name;
+	result["parameters"] = p_parameters;
+	result["samples"] = int32_t(sorted.size());
+	result["min_ns"] = sorted.is_empty() ? 0.0 : sorted[0];
+	result["median_ns"] = sorted.is_empty() ? 0.0 : sorted[sorted.size() / 2];
+	result["p90_ns"] = sorted.is_empty() ? 0.0 : sorted[(sorted.size() * 9) / 10];
+	result["max_ns"] = sorted.is_empty() ? 0.0 : sorted[sorted.size() - 1];
+	for (const KeyValue<Variant, Variant> &metric : p_metrics) {
+		result[metric.key] = metric.value;
+	}
+	const String line = JSON::stringify(result, "", true);
+	MESSAGE(line);
+
+	const String output_path = OS::get_singleton()->get_environment("MANY_BONE_IK_BENCHMARK_OUTPUT");
+	if (output_path.is_empty()) {
+		return;
+	}
+	Ref<FileAccess> file = FileAccess::open(output_path, FileAccess::READ_WRITE);
+	if (file.is_null()) {
+		file = FileAccess::open(output_path, FileAccess::WRITE);
+	}
+	ERR_FAIL_COND_MSG(file.is_null(), vformat("Cannot append benchmark results to %s.", output_path));
+	file->seek_end();
+	file->store_line(line);
+}
+
+// Times p_operation in batches and reports the nanoseconds per call of each batch.
+template <typename F>
+void run_benchmark(const String &p_suite, const String &p_name, const Dictionary &p_parameters, const BenchmarkSettings &p_settings, F &&p_operation) {
+	for (int32_t sample_i = 0; sample_i < p_settings.warmup_samples; sample_i++) {
+		for (int32_t operation_i = 0; operation_i < p_settings.operations_per_sample; operation_i++) {
+			p_operation();
+		}
+	}
+	LocalVector<double> samples;
+	samples.reserve(p_settings.samples);
+	for (int32_t sample_i = 0; sample_i < p_settings.samples; sample_i++) {
+		const uint64_t start = OS::get_singleton()->get_ticks_usec();
+		for (int32_t operation_i = 0; operation_i < p_settings.operations_per_sample; operation_i++) {
+			p_operation();
+		}
+		const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+		samples.push_back(elapsed * 1000.0 / p_settings.operations_per_sample);
+	}
+	emit_result(p_suite, p_name, p_parameters, samples);
+}
+
+} // namespace TestManyBoneIKBenchmarkFixtures
@@ -0,0 +1,438 @@
+/**************************************************************************/
+/*  test_many_bone_ik_benchmarks.h                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/object/worker_thread_pool.h"
+#include "modules/many_bone_ik/src/ik_bone_segment_3d.h"
+#include "modules/many_bone_ik/src/ik_kusudama_3d.h"
+#include "modules/many_bone_ik/src/ik_open_cone_3d.h"
+#include "modules/many_bone_ik/src/math/ik_deterministic_math.h"
+#include "modules/many_bone_ik/src/math/ik_node_3d.h"
+#include "modules/many_bone_ik/src/math/qcp.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "modules/many_bone_ik/tests/test_many_bone_ik_benchmark_fixtures.h"
+#include "tests/test_macros.h"
+
+#ifdef MODULE_GLTF_ENABLED
+#include "modules/gltf/gltf_document.h"
+#include "modules/gltf/gltf_state.h"
+#endif
+
+namespace TestManyBoneIKBenchmarks {
+
+using namespace TestEWBIKFixtures;
+using namespace TestManyBoneIKBenchmarkFixtures;
+
+static constexpr uint64_t BENCHMARK_SEED = 20250101;
+
+TEST_CASE("[Modules][ManyBoneIK][QCP][Benchmark] weighted_superpose by heading count" * doctest::skip()) {
+	RandomPCG rng(BENCHMARK_SEED);
+	const Quaternion rotation(Vector3(0.3, 1.0, -0.2).normalized(), 0.7);
+	const int32_t heading_counts[] = { 1, 3, 7, 13, 25, 49 };
+	for (int32_t heading_count : heading_counts) {
+		PackedVector3Array moved;
+		PackedVector3Array target;
+		Vector<double> weights;
+		for (int32_t heading_i = 0; heading_i < heading_count; heading_i++) {
+			const Vector3 point(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f));
+			moved.push_back(point);
+			target.push_back(rotation.xform(point) + Vector3(0.1, 0.0, 0.2));
+			weights.push_back(rng.random(0.5f, 1.0f));
+		}
+		Dictionary parameters;
+		parameters["headings"] = heading_count;
+		int64_t result_count = 0;
+		for (bool translate : { false, true }) {
+			parameters["translate"] = translate;
+			run_benchmark("qcp", "weighted_superpose", parameters, BenchmarkSettings(), [&]() {
+				result_count += QuaternionCharacteristicPolynomial::weighted_superpose(moved, target, weights, translate, 1e-6).size();
+			});
+		}
+		CHECK(result_count > 0);
+	}
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKKusudama3D][Benchmark] Orientation and twist snapping by cone count" * doctest::skip()) {
+	RandomPCG rng(BENCHMARK_SEED);
+	const int32_t cone_counts[] = { 1, 2, 4, 8, 16 };
+	for (int32_t cone_count : cone_counts) {
+		Ref<IKKusudama3D> kusudama;
+		kusudama.instantiate();
+		kusudama->enable_orientational_limits();
+		for (int32_t cone_i = 0; cone_i < cone_count; cone_i++) {
+			// Narrow cones spread over the upper hemisphere, so most directions need a snap.
+			const real_t azimuth = Math::TAU * cone_i / cone_count;
+			Ref<IKLimitCone3D> cone;
+			cone.instantiate();
+			cone->set_attached_to(kusudama);
+			cone->set_radius(0.2);
+			cone->set_control_point(Vector3(Math::cos(azimuth) * 0.5, 1.0, Math::sin(azimuth) * 0.5).normalized());
+			kusudama->add_open_cone(cone);
+		}
+		kusudama->enable_axial_limits();
+		kusudama->set_axial_limits(-0.3, 0.6);
+
+		Ref<IKNode3D> parent;
+		parent.instantiate();
+		Ref<IKNode3D> to_set;
+		to_set.instantiate();
+		to_set->set_parent(parent);
+		Ref<IKNode3D> bone_direction;
+		bone_direction.instantiate();
+		bone_direction->set_parent(to_set);
+		Ref<IKNode3D> limiting_axes;
+		limiting_axes.instantiate();
+		limiting_axes->set_parent(parent);
+
+		LocalVector<Basis> orientations;
+		for (int32_t orientation_i = 0; orientation_i < 64; orientation_i++) {
+			const Vector3 axis = Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f)).normalized();
+			orientations.push_back(Basis(axis.is_zero_approx() ? Vector3(0, 1, 0) : axis, rng.random(0.0f, Math::PI)));
+		}
+
+		Dictionary parameters;
+		parameters["cones"] = cone_count;
+		uint32_t orientation_i = 0;
+		run_benchmark("kusudama", "snap_to_orientation_limit", parameters, BenchmarkSettings(), [&]() {
+			to_set->set_transform(Transform3D(orientations[orientation_i++ % orientations.size()], Vector3()));
+			kusudama->snap_to_orientation_limit(bone_direction, to_set, limiting_axes, 0.0, 1.0);
+		});
+		run_benchmark("kusudama", "set_snap_to_twist_limit", parameters, BenchmarkSettings(), [&]() {
+			to_set->set_transform(Transform3D(orientations[orientation_i++ % orientations.size()], Vector3()));
+			kusudama->set_snap_to_twist_limit(bone_direction, to_set, limiting_axes, 0.0, 1.0);
+		});
+	}
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKNode3D][Benchmark] Global transform propagation" * doctest::skip()) {
+	const int32_t node_counts[] = { 8, 64, 512 };
+	for (bool wide : { false, true }) {
+		for (int32_t node_count : node_counts) {
+			LocalVector<Ref<IKNode3D>> nodes;
+			Ref<IKNode3D> root;
+			root.instantiate();
+			nodes.push_back(root);
+			for (int32_t node_i = 1; node_i < node_count; node_i++) {
+				Ref<IKNode3D> node;
+				node.instantiate();
+				// A chain parents each node to the previous one; a wide tree branches in four.
+				node->set_parent(nodes[wide ? (node_i - 1) / 4 : node_i - 1]);
+				node->set_transform(Transform3D(Basis(Vector3(0, 0, 1), 0.1), Vector3(0, 1, 0)));
+				nodes.push_back(node);
+			}
+			Dictionary parameters;
+			parameters["shape"] = wide ? "tree" : "chain";
+			parameters["nodes"] = node_count;
+			BenchmarkSettings settings;
+			settings.operations_per_sample = 100;
+			real_t angle = 0.0;
+			run_benchmark("ik_node_3d", "propagate_root_change", parameters, settings, [&]() {
+				angle += 0.01;
+				root->set_transform(Transform3D(Basis(Vector3(0, 1, 0), angle), Vector3()));
+				for (const Ref<IKNode3D> &node : nodes) {
+					node->get_global_transform();
+				}
+			});
+		}
+	}
+}
+
+static void benchmark_segment_solver(const String &p_rig_name, Rig &r_rig) {
+	RandomPCG rng(BENCHMARK_SEED);
+	r_rig.ik->solve();
+	Vector<Ref<IKBoneSegment3D>> segments = r_rig.ik->get_segmented_skeletons();
+	REQUIRE_FALSE(segments.is_empty());
+	const Vector<float> damp;
+	Dictionary parameters;
+	parameters["rig"] = p_rig_name;
+	parameters["bones"] = r_rig.skeleton->get_bone_count();
+	parameters["pins"] = int32_t(r_rig.pinned_bones.size());
+	BenchmarkSettings settings;
+	settings.operations_per_sample = p_rig_name == "tree" ? 5 : 100;
+	settings.samples = 11;
+	run_benchmark("segment_solver", "pass", parameters, settings, [&]() {
+		for (const Ref<IKBoneSegment3D> &segment : segments) {
+			segment->segment_solver(damp, r_rig.ik->get_default_damp(), false, 0, 1);
+		}
+	});
+
+	// The whole modification, including reading targets and writing bones back.
+	parameters["iterations"] = r_rig.ik->get_iterations_per_frame();
+	run_benchmark("segment_solver", "frame", parameters, settings, [&]() {
+		step_targets(r_rig, rng);
+		r_rig.ik->solve();
+	});
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Benchmark] Segment solver passes on synthetic rigs" * doctest::skip()) {
+	Rig chain = create_chain_rig(16);
+	benchmark_segment_solver("chain", chain);
+	free_rig(chain);
+
+	Rig humanoid = create_humanoid_rig();
+	benchmark_segment_solver("humanoid", humanoid);
+	free_rig(humanoid);
+
+	Rig tree = create_tree_rig();
+	benchmark_segment_solver("tree", tree);
+	free_rig(tree);
+}
+
+// Independent humanoids, each with its own animated targets. Like the baker,
+// the rigs are detached from the tree before workers solve them, so no two
+// threads touch the same node.
+struct CrowdFrame {
+	LocalVector<Rig> *rigs = nullptr;
+	LocalVector<RandomPCG> *rngs = nullptr;
+};
+
+static void solve_crowd_instance(void *p_userdata, uint32_t p_index) {
+	CrowdFrame *frame = static_cast<CrowdFrame *>(p_userdata);
+	Rig &rig = (*frame->rigs)[p_index];
+	step_targets(rig, (*frame->rngs)[p_index]);
+	rig.ik->solve();
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Benchmark] Crowd throughput by instance and thread count" * doctest::skip()) {
+	const int32_t instance_counts[] = { 10, 100, 1000 };
+	const int32_t max_threads = WorkerThreadPool::get_singleton()->get_thread_count();
+	LocalVector<int32_t> thread_counts;
+	for (int32_t threads = 1; threads < max_threads; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(max_threads);
+	const int32_t warmup_frames = 5;
+	const int32_t frames = 60;
+
+	for (int32_t instance_count : instance_counts) {
+		LocalVector<Rig> rigs;
+		LocalVector<RandomPCG> rngs;
+		int64_t total_bytes = 0;
+		for (int32_t instance_i = 0; instance_i < instance_count; instance_i++) {
+			Rig rig = create_humanoid_rig();
+			// Build the segments on the main thread, then take the rig out of the tree.
+			rig.ik->solve();
+			SceneTree::get_singleton()->get_root()->remove_child(rig.skeleton);
+			total_bytes += int64_t(rig.ik->get_memory_report()["total"]);
+			rigs.push_back(rig);
+			rngs.push_back(RandomPCG(BENCHMARK_SEED + instance_i));
+		}
+		CrowdFrame frame;
+		frame.rigs = &rigs;
+		frame.rngs = &rngs;
+
+		double single_thread_median_ns = 0.0;
+		for (int32_t threads : thread_counts) {
+			LocalVector<double> samples;
+			for (int32_t frame_i = -warmup_frames; frame_i < frames; frame_i++) {
+				const uint64_t start = OS::get_singleton()->get_ticks_usec();
+				WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_native_group_task(&solve_crowd_instance, &frame, instance_count, threads, true, SNAME("EWBIK3DCrowdBenchmark"));
+				WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+				if (frame_i >= 0) {
+					samples.push_back((OS::get_singleton()->get_ticks_usec() - start) * 1000.0);
+				}
+			}
+			LocalVector<double> sorted = samples;
+			sorted.sort();
+			const double median_ns = sorted[sorted.size() / 2];
+			if (threads == 1) {
+				single_thread_median_ns = median_ns;
+			}
+
+			Dictionary parameters;
+			parameters["rig"] = "humanoid";
+			parameters["instances"] = instance_count;
+			parameters["threads"] = threads;
+			Dictionary metrics;
+			metrics["per_instance_median_ns"] = median_ns / instance_count;
+			// 1.0 means the frame time fell in proportion to the threads added.
+			metrics["scaling_efficiency"] = single_thread_median_ns / (median_ns * threads);
+			metrics["bytes_per_instance"] = double(total_bytes) / instance_count;
+			emit_result("crowd", "frame", parameters, samples, metrics);
+		}
+
+		for (Rig &rig : rigs) {
+			free_rig(rig);
+		}
+	}
+}
+
+#ifdef MODULE_GLTF_ENABLED
+// Solves a skinned glTF scene end to end: every leaf joint is pinned and its
+// target moves along a scripted path around the rest pose. The scene
+// defaults to the bundled SimpleSkin sample; point
+// MANY_BONE_IK_BENCHMARK_GLTF at another file to replay a production rig.
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Benchmark] Scripted targets on a glTF skin" * doctest::skip()) {
+	String path = OS::get_singleton()->get_environment("MANY_BONE_IK_BENCHMARK_GLTF");
+	if (path.is_empty()) {
+		path = String(__FILE__).get_base_dir().path_join("../../../../aria_joint/test/samples/SimpleSkin.gltf").simplify_path();
+	}
+	Ref<GLTFDocument> document;
+	document.instantiate();
+	Ref<GLTFState> state;
+	state.instantiate();
+	REQUIRE_MESSAGE(document->append_from_file(path, state) == OK, vformat("Cannot load %s.", path));
+	Node *scene = document->generate_scene(state);
+	REQUIRE(scene);
+	SceneTree::get_singleton()->get_root()->add_child(scene);
+	TypedArray<Node> skeletons = scene->find_children("*", "Skeleton3D", true, false);
+	REQUIRE_FALSE(skeletons.is_empty());
+	Skeleton3D *skeleton = Object::cast_to<Skeleton3D>(skeletons[0]);
+
+	LocalVector<int32_t> leaves;
+	for (int32_t bone_i = 0; bone_i < skeleton->get_bone_count(); bone_i++) {
+		if (skeleton->get_bone_children(bone_i).is_empty()) {
+			leaves.push_back(bone_i);
+		}
+	}
+	REQUIRE_FALSE(leaves.is_empty());
+	EWBIK3D *ik = memnew(EWBIK3D);
+	skeleton->add_child(ik);
+	ik->set_pin_count(leaves.size());
+	LocalVector<Transform3D> rests;
+	LocalVector<real_t> amplitudes;
+	for (uint32_t pin_i = 0; pin_i < leaves.size(); pin_i++) {
+		ik->set_pin_bone_name(pin_i, skeleton->get_bone_name(leaves[pin_i]));
+		rests.push_back(skeleton->get_bone_global_rest(leaves[pin_i]));
+		// Half the pinned bone's length keeps most of the path reachable.
+		amplitudes.push_back(MAX(real_t(0.05), skeleton->get_bone_rest(leaves[pin_i]).origin.length() * real_t(0.5)));
+	}
+	// The counters only add increments, so they stay on for the timed frames.
+	ik->set_stats_enabled(true);
+	ik->solve();
+
+	const int32_t warmup_frames = 100;
+	const int32_t frames = 2000;
+	const real_t period = 120.0;
+	for (bool figure_eight : { false, true }) {
+		LocalVector<double> samples;
+		LocalVector<Vector3> targets;
+		targets.resize(leaves.size());
+		uint64_t iterations = 0;
+		double error_sum = 0.0;
+		double max_error = 0.0;
+		for (int32_t frame_i = -warmup_frames; frame_i < frames; frame_i++) {
+			const real_t phase = Math::TAU * frame_i / period;
+			for (uint32_t pin_i = 0; pin_i < leaves.size(); pin_i++) {
+				// Offset each pin's phase so the targets do not move in lockstep.
+				const real_t pin_phase = phase + real_t(pin_i);
+				const Vector3 offset = figure_eight
+						? Vector3(Math::sin(pin_phase), Math::sin(2 * pin_phase) * real_t(0.5), 0)
+						: Vector3(Math::cos(pin_phase), Math::sin(pin_phase), 0);
+				targets[pin_i] = rests[pin_i].origin + offset * amplitudes[pin_i];
+				ik->set_pin_target_transform_override(pin_i, Transform3D(rests[pin_i].basis, targets[pin_i]));
+			}
+			const uint64_t start = OS::get_singleton()->get_ticks_usec();
+			ik->solve();
+			const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+			if (frame_i < 0) {
+				continue;
+			}
+			samples.push_back(elapsed * 1000.0);
+			iterations += uint64_t(ik->get_stats()["iterations"]);
+			for (uint32_t pin_i = 0; pin_i < leaves.size(); pin_i++) {
+				const double error = skeleton->get_bone_global_pose(leaves[pin_i]).origin.distance_to(targets[pin_i]);
+				error_sum += error;
+				max_error = MAX(max_error, error);
+			}
+		}
+		Dictionary parameters;
+		parameters["scene"] = path.get_file();
+		parameters["bones"] = skeleton->get_bone_count();
+		parameters["pins"] = int32_t(leaves.size());
+		parameters["path"] = figure_eight ? "figure8" : "circle";
+		parameters["iterations"] = ik->get_iterations_per_frame();
+		Dictionary metrics;
+		metrics["mean_solver_iterations"] = double(iterations) / frames;
+		metrics["mean_residual"] = error_sum / (double(frames) * leaves.size());
+		metrics["max_residual"] = max_error;
+		emit_result("gltf_scene", "frame", parameters, samples, metrics);
+	}
+
+	memdelete(scene);
+}
+#endif // MODULE_GLTF_ENABLED
+
+TEST_CASE("[Modules][ManyBoneIK][IKApproximateMath][Benchmark] Trigonometry by math policy" * doctest::skip()) {
+	RandomPCG rng(BENCHMARK_SEED);
+	LocalVector<double> angles;
+	LocalVector<double> cosines;
+	LocalVector<Quaternion> rotations;
+	for (int32_t sample_i = 0; sample_i < 1024; sample_i++) {
+		angles.push_back(rng.random(-Math::PI, Math::PI));
+		cosines.push_back(rng.random(-1.0f, 1.0f));
+		rotations.push_back(Quaternion(Vector3(rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f), rng.random(-1.0f, 1.0f) + 2.0f).normalized(), rng.random(-3.0f, 3.0f)));
+	}
+	const Quaternion slerp_to(Vector3(0, 1, 0), 1.2);
+	double sink = 0.0;
+	for (IKMath::Policy policy : { IKMath::POLICY_PRECISE, IKMath::POLICY_APPROXIMATE }) {
+		IKMath::PolicyScope scope(policy);
+		Dictionary parameters;
+		parameters["policy"] = policy == IKMath::POLICY_PRECISE ? "precise" : "approximate";
+		uint32_t index = 0;
+		run_benchmark("math_policy", "cos", parameters, BenchmarkSettings(), [&]() {
+			sink += IKMath::cos(angles[index++ & 1023]);
+		});
+		run_benchmark("math_policy", "get_angle", parameters, BenchmarkSettings(), [&]() {
+			sink += IKMath::get_angle(Quaternion(0, 0, Math::sqrt(1.0 - cosines[index & 1023] * cosines[index & 1023]), cosines[index & 1023]));
+			index++;
+		});
+		run_benchmark("math_policy", "slerp", parameters, BenchmarkSettings(), [&]() {
+			sink += IKMath::slerp(rotations[index++ & 1023], slerp_to, 0.3).w;
+		});
+		run_benchmark("math_policy", "axis_angle", parameters, BenchmarkSettings(), [&]() {
+			sink += IKMath::axis_angle(Vector3(0, 1, 0), angles[index++ & 1023]).w;
+		});
+	}
+	CHECK(Math::is_finite(sink));
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Benchmark] Humanoid frames by math policy" * doctest::skip()) {
+	for (bool approximate : { false, true }) {
+		RandomPCG rng(BENCHMARK_SEED);
+		Rig humanoid = create_humanoid_rig();
+		humanoid.ik->set_approximate_math_enabled(approximate);
+		humanoid.ik->solve();
+		Dictionary parameters;
+		parameters["rig"] = "humanoid";
+		parameters["policy"] = approximate ? "approximate" : "precise";
+		BenchmarkSettings settings;
+		settings.operations_per_sample = 100;
+		settings.samples = 11;
+		run_benchmark("math_policy", "frame", parameters, settings, [&]() {
+			step_targets(humanoid, rng);
+			humanoid.ik->solve();
+		});
+		free_rig(humanoid);
+	}
+}
+
+} // namespace TestManyBoneIKBenchmarks
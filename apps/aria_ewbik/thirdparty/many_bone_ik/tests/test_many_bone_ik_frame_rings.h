@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  test_many_bone_ik_frame_rings.h                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/core/ik_core_frame_ring.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace TestManyBoneIKFrameRings {
+
+#ifndef _WIN32
+
+struct FrameHeader {
+	uint64_t frame;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+struct TargetFrame {
+	FrameHeader header;
+	float target[7];
+};
+
+struct PoseFrame {
+	FrameHeader header;
+	float rotations[4 * 4];
+};
+
+// The other process's side of the exchange: it creates both rings, writes
+// targets and reads poses.
+struct RingPeer {
+	CharString targets_name;
+	CharString poses_name;
+	IKCore::SharedMemory targets_memory;
+	IKCore::SharedMemory poses_memory;
+	IKCore::FrameRing targets;
+	IKCore::FrameRing poses;
+
+	bool create() {
+		targets_name = vformat("/ewbik_targets_%d", int(getpid())).utf8();
+		poses_name = vformat("/ewbik_poses_%d", int(getpid())).utf8();
+		const size_t size = (IKCore::FrameRing::get_required_size(8, sizeof(PoseFrame)) + 4095) & ~size_t(4095);
+		IKCore::SharedMemory::unlink(targets_name.get_data());
+		IKCore::SharedMemory::unlink(poses_name.get_data());
+		return targets_memory.create(targets_name.get_data(), size) && poses_memory.create(poses_name.get_data(), size) &&
+				targets.create(targets_memory.get_memory(), size, 8, sizeof(TargetFrame)) == IKCore::FrameRing::RESULT_OK &&
+				poses.create(poses_memory.get_memory(), size, 8, sizeof(PoseFrame)) == IKCore::FrameRing::RESULT_OK;
+	}
+
+	~RingPeer() {
+		IKCore::SharedMemory::unlink(targets_name.get_data());
+		IKCore::SharedMemory::unlink(poses_name.get_data());
+	}
+};
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Solves targets read from a frame ring and publishes the pose") {
+	RingPeer peer;
+	REQUIRE(peer.create());
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	REQUIRE(rig.ik->attach_frame_rings(String(peer.targets_name.get_data()), String(peer.poses_name.get_data())) == OK);
+	CHECK(rig.ik->is_attached_to_frame_rings());
+
+	const Vector3 target(1.2, 2.2, 0.4);
+	// Only the newest target counts; the stale one before it is skipped.
+	for (uint64_t frame_i = 0; frame_i < 2; frame_i++) {
+		TargetFrame frame = {};
+		frame.header.frame = 40 + frame_i;
+		frame.header.count = 1;
+		const Vector3 origin = frame_i == 0 ? Vector3(-1, 1, 0) : target;
+		const float values[7] = { 0, 0, 0, 1, float(origin.x), float(origin.y), float(origin.z) };
+		memcpy(frame.target, values, sizeof(values));
+		REQUIRE(peer.targets.push(&frame, sizeof(frame)) == IKCore::FrameRing::RESULT_OK);
+	}
+	for (int32_t solve_i = 0; solve_i < 4; solve_i++) {
+		rig.ik->solve();
+	}
+	CHECK(rig.ik->has_pin_target_transform_override(0));
+	CHECK(TestEWBIKFixtures::get_hand_position(rig).distance_to(target) < 0.05);
+
+	// One pose per solve, each carrying the number of the target it answers.
+	PoseFrame pose;
+	uint32_t size = 0;
+	int32_t pose_count = 0;
+	while (peer.poses.pop(&pose, sizeof(pose), &size) == IKCore::FrameRing::RESULT_OK) {
+		pose_count++;
+		CHECK(size == sizeof(PoseFrame));
+		CHECK(pose.header.frame == 41);
+		CHECK(pose.header.count == 4);
+	}
+	CHECK(pose_count == 4);
+	for (int32_t bone_i = 0; bone_i < 4; bone_i++) {
+		const Quaternion published(pose.rotations[bone_i * 4 + 0], pose.rotations[bone_i * 4 + 1], pose.rotations[bone_i * 4 + 2], pose.rotations[bone_i * 4 + 3]);
+		CHECK(published.is_equal_approx(rig.skeleton->get_bone_pose_rotation(bone_i)));
+	}
+
+	rig.ik->detach_frame_rings();
+	CHECK_FALSE(rig.ik->is_attached_to_frame_rings());
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Attaching to frame rings that do not exist fails") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	ERR_PRINT_OFF;
+	CHECK(rig.ik->attach_frame_rings("/ewbik_missing_targets", "/ewbik_missing_poses") == ERR_CANT_OPEN);
+	ERR_PRINT_ON;
+	CHECK_FALSE(rig.ik->is_attached_to_frame_rings());
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+#endif // _WIN32
+
+} // namespace TestManyBoneIKFrameRings
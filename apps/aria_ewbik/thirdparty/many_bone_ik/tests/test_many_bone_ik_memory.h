@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*  test_many_bone_ik_memory.h                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_damping_tables_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestManyBoneIKMemory {
+
+using namespace TestEWBIKFixtures;
+
+TEST_CASE("[Modules][ManyBoneIK][IKDampingTables3D] Identical settings share one table") {
+	const IKDampingTables3D::Tables first = IKDampingTables3D::get(10, 0.5f, 1.0f);
+	const IKDampingTables3D::Tables second = IKDampingTables3D::get(10, 0.5f, 1.0f);
+	CHECK_EQ(first.half_returnfulness_dampened.size(), 10);
+	CHECK_EQ(first.cos_half_returnfulness_dampened.size(), 10);
+	CHECK(first.half_returnfulness_dampened.ptr() == second.half_returnfulness_dampened.ptr());
+	CHECK(first.cos_half_returnfulness_dampened.ptr() == second.cos_half_returnfulness_dampened.ptr());
+
+	const IKDampingTables3D::Tables other = IKDampingTables3D::get(10, 0.5f, 2.0f);
+	CHECK(first.half_returnfulness_dampened.ptr() != other.half_returnfulness_dampened.ptr());
+	CHECK(Math::is_equal_approx(other.half_returnfulness_dampened[0], 2.0f * first.half_returnfulness_dampened[0]));
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKDampingTables3D] A full cache evicts only the least recently used table") {
+	IKDampingTables3D::clear_cache();
+	const IKDampingTables3D::Tables kept = IKDampingTables3D::get(10, 0.5f, 1.0f);
+	const IKDampingTables3D::Tables evicted = IKDampingTables3D::get(10, 0.5f, 2.0f);
+	for (int32_t table_i = 0; table_i < IKDampingTables3D::MAX_CACHED_TABLES; table_i++) {
+		// Keep the first table recently used while the others fill the cache.
+		CHECK(IKDampingTables3D::get(10, 0.5f, 1.0f).half_returnfulness_dampened.ptr() == kept.half_returnfulness_dampened.ptr());
+		IKDampingTables3D::get(4, 0.25f, 0.01f * (table_i + 1));
+	}
+	CHECK(IKDampingTables3D::get_cached_count() == IKDampingTables3D::MAX_CACHED_TABLES);
+	CHECK(IKDampingTables3D::get(10, 0.5f, 1.0f).half_returnfulness_dampened.ptr() == kept.half_returnfulness_dampened.ptr());
+	CHECK(IKDampingTables3D::get(10, 0.5f, 2.0f).half_returnfulness_dampened.ptr() != evicted.half_returnfulness_dampened.ptr());
+	IKDampingTables3D::clear_cache();
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Memory grows by a bounded amount per bone") {
+	Rig short_chain = create_chain_rig(16);
+	short_chain.ik->solve();
+	Rig long_chain = create_chain_rig(64);
+	long_chain.ik->solve();
+	const Dictionary short_report = short_chain.ik->get_memory_report();
+	const Dictionary long_report = long_chain.ik->get_memory_report();
+
+	CHECK_EQ(int32_t(short_report["bone_count"]), 16);
+	CHECK_EQ(int32_t(long_report["bone_count"]), 64);
+	int64_t category_sum = 0;
+	for (const String category : { "transform_nodes", "headings", "constraints", "tables", "bones" }) {
+		CHECK(int64_t(long_report[category]) >= 0);
+		category_sum += int64_t(long_report[category]);
+	}
+	CHECK_EQ(category_sum, int64_t(long_report["total"]));
+
+	const double growth_per_bone = double(int64_t(long_report["total"]) - int64_t(short_report["total"])) / 48.0;
+	CHECK(growth_per_bone > 0.0);
+	CHECK(growth_per_bone < 16384.0);
+	CHECK(double(long_report["bytes_per_bone"]) <= double(short_report["bytes_per_bone"]));
+
+	// The root and the other bones have different dampening, so two shared
+	// pairs of tables serve each chain however long it is.
+	CHECK_EQ(int64_t(long_report["tables"]), int64_t(short_report["tables"]));
+	CHECK(int64_t(long_report["tables"]) <= int64_t(2 * 2 * 10 * sizeof(float)));
+
+	// Both nodes use the same settings, so their bones hold the same buffers.
+	const Ref<IKBone3D> short_bone = short_chain.ik->get_bone_list()[8];
+	const Ref<IKBone3D> long_bone = long_chain.ik->get_bone_list()[8];
+	CHECK(short_bone->get_half_returnfullness_dampened().ptr() == long_bone->get_half_returnfullness_dampened().ptr());
+
+	free_rig(short_chain);
+	free_rig(long_chain);
+}
+
+} // namespace TestManyBoneIKMemory
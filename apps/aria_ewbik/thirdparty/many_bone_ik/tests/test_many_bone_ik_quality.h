@@ -0,0 +1,336 @@
+/**************************************************************************/
+/*  test_many_bone_ik_quality.h                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+// Convergence against cost. Every standard target scenario runs on each rig
+// for every combination of iterations per frame, default damping and
+// stabilization passes, and one CSV row is written per pin:
+//   godot --test --test-case="*[Quality]*" --no-skip
+// Set MANY_BONE_IK_QUALITY_OUTPUT to a file path to write the CSV there;
+// otherwise the rows are printed. Jitter is the largest frame to frame
+// rotation of any bone while the targets hold still, so it stays zero for a
+// solver that settles.
+namespace TestManyBoneIKQuality {
+
+using namespace TestEWBIKFixtures;
+
+static constexpr uint64_t QUALITY_SEED = 20250101;
+static constexpr int32_t QUALITY_FRAMES = 120;
+static constexpr int32_t SETTLE_FRAMES = 20;
+static constexpr int32_t TELEPORT_PERIOD = 30;
+
+enum Scenario {
+	SCENARIO_REACHABLE,
+	SCENARIO_UNREACHABLE,
+	SCENARIO_TELEPORTING,
+	SCENARIO_NOISY_TRACKER,
+	SCENARIO_CONSTRAINT_BOUNDARY,
+	SCENARIO_MAX,
+};
+
+static const char *scenario_names[SCENARIO_MAX] = {
+	"reachable",
+	"unreachable",
+	"teleporting",
+	"noisy_tracker",
+	"constraint_boundary",
+};
+
+static const char *csv_header = "rig,scenario,iterations,default_damp,stabilization_passes,pin,bone,"
+								"mean_position_error,final_position_error,mean_orientation_error,unreachable_frames,"
+								"mean_jitter,max_jitter,mean_solve_usec,p90_solve_usec";
+
+struct PinQuality {
+	double position_error_sum = 0.0;
+	double orientation_error_sum = 0.0;
+	float final_position_error = 0.0;
+	int32_t unreachable_frames = 0;
+	// Solver iterations, counted across frames, until the pin first came within
+	// the residual tolerance; -1 if it never did or history was off.
+	int32_t iterations_to_converge = -1;
+};
+
+struct ScenarioQuality {
+	LocalVector<PinQuality> pins;
+	int32_t measured_frames = 0;
+	double mean_jitter = 0.0;
+	double max_jitter = 0.0;
+	double mean_solve_usec = 0.0;
+	double p90_solve_usec = 0.0;
+	uint64_t solver_iterations = 0; // Only counted while tracking convergence.
+};
+
+// Narrow cones around each bone's rest direction and a small twist range,
+// so the constraint-boundary targets hold the bones against their limits.
+static void constrain_all_bones(Rig &r_rig) {
+	for (int32_t bone_i = 1; bone_i < r_rig.skeleton->get_bone_count(); bone_i++) {
+		const String bone_name = r_rig.skeleton->get_bone_name(bone_i);
+		int32_t constraint_i = r_rig.ik->find_constraint(bone_name);
+		if (constraint_i == -1) {
+			constraint_i = r_rig.ik->get_constraint_count();
+			r_rig.ik->add_constraint();
+			r_rig.ik->set_constraint_name_at_index(constraint_i, bone_name);
+		}
+		r_rig.ik->set_kusudama_open_cone_count(constraint_i, 1);
+		r_rig.ik->set_kusudama_open_cone(constraint_i, 0, Vector3(0, 1, 0), 0.35);
+		r_rig.ik->set_joint_twist(constraint_i, Vector2(-0.2, 0.4));
+	}
+}
+
+static Vector3 random_offset(RandomPCG &r_rng, real_t p_extent) {
+	return Vector3(r_rng.random(-p_extent, p_extent), r_rng.random(-p_extent, p_extent), r_rng.random(-p_extent, p_extent));
+}
+
+// Where pin p_pin_index should be at p_frame. Reachable offsets stay within a
+// bone length of the rest pose; unreachable ones are three times as far from
+// the skeleton origin as the rest pose.
+static Transform3D get_scenario_target(Scenario p_scenario, const Transform3D &p_rest, int32_t p_pin_index, int32_t p_frame, RandomPCG &r_rng) {
+	Transform3D target = p_rest;
+	const Vector3 reachable_offset = Vector3(0.2, -0.15, 0.1).rotated(Vector3(0, 1, 0), 1.3 * p_pin_index);
+	switch (p_scenario) {
+		case SCENARIO_REACHABLE:
+			target.origin += reachable_offset;
+			break;
+		case SCENARIO_UNREACHABLE:
+			target.origin = p_rest.origin.is_zero_approx() ? Vector3(0, 10, 0) : p_rest.origin * 3.0;
+			break;
+		case SCENARIO_TELEPORTING: {
+			RandomPCG jump_rng(QUALITY_SEED + p_frame / TELEPORT_PERIOD * 31 + p_pin_index);
+			target.origin += random_offset(jump_rng, 0.3);
+		} break;
+		case SCENARIO_NOISY_TRACKER:
+			// A still tracker reporting a few millimetres of noise.
+			target.origin += reachable_offset + random_offset(r_rng, 0.003);
+			target.basis = Basis(Vector3(0, 1, 0), r_rng.random(-0.01f, 0.01f)) * target.basis;
+			break;
+		case SCENARIO_CONSTRAINT_BOUNDARY:
+			// Far to the side, where the cones stop every bone short.
+			target.origin += Vector3(1.5, -0.5, 0.0).rotated(Vector3(0, 1, 0), 1.3 * p_pin_index);
+			break;
+		case SCENARIO_MAX:
+			break;
+	}
+	return target;
+}
+
+static bool is_target_still(Scenario p_scenario, int32_t p_frame) {
+	if (p_frame < SETTLE_FRAMES) {
+		return false;
+	}
+	if (p_scenario == SCENARIO_TELEPORTING) {
+		return p_frame % TELEPORT_PERIOD != 0;
+	}
+	return true;
+}
+
+static void write_rows(const LocalVector<String> &p_rows) {
+	const String output_path = OS::get_singleton()->get_environment("MANY_BONE_IK_QUALITY_OUTPUT");
+	if (output_path.is_empty()) {
+		MESSAGE(csv_header);
+		for (const String &row : p_rows) {
+			MESSAGE(row);
+		}
+		return;
+	}
+	Ref<FileAccess> file = FileAccess::open(output_path, FileAccess::WRITE);
+	ERR_FAIL_COND_MSG(file.is_null(), vformat("Cannot write quality results to %s.", output_path));
+	file->store_line(csv_header);
+	for (const String &row : p_rows) {
+		file->store_line(row);
+	}
+}
+
+// Runs one scenario from the rest pose. With p_track_convergence the residual
+// history and statistics are kept so each pin's iterations to converge and
+// the solver's iteration total can be counted; sweeps leave them off so they
+// do not add to the solve times.
+static ScenarioQuality measure_scenario(Rig &r_rig, Scenario p_scenario, int32_t p_iterations, float p_damp, int32_t p_stabilization_passes, bool p_track_convergence = false) {
+	r_rig.skeleton->reset_bone_poses();
+	r_rig.ik->set_iterations_per_frame(p_iterations);
+	r_rig.ik->set_default_damp(p_damp);
+	r_rig.ik->set_stabilization_passes(p_stabilization_passes);
+	r_rig.ik->set_residual_tolerance(0.01);
+	r_rig.ik->set_residual_history_enabled(p_track_convergence);
+	r_rig.ik->set_stats_enabled(p_track_convergence);
+
+	const int32_t bone_count = r_rig.skeleton->get_bone_count();
+	const int32_t pin_count = r_rig.pinned_bones.size();
+	LocalVector<Transform3D> rest_targets;
+	for (int32_t bone : r_rig.pinned_bones) {
+		rest_targets.push_back(r_rig.skeleton->get_bone_global_pose(bone));
+	}
+	LocalVector<Quaternion> previous_rotations;
+	previous_rotations.resize(bone_count);
+	ScenarioQuality quality;
+	quality.pins.resize(pin_count);
+	LocalVector<double> solve_usec;
+	double jitter_sum = 0.0;
+	int32_t still_frames = 0;
+	int32_t iterations_done = 0;
+	RandomPCG rng(QUALITY_SEED);
+
+	for (int32_t frame = 0; frame < QUALITY_FRAMES; frame++) {
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			r_rig.ik->set_pin_target_transform_override(pin_i, get_scenario_target(p_scenario, rest_targets[pin_i], pin_i, frame, rng));
+		}
+		const uint64_t start = OS::get_singleton()->get_ticks_usec();
+		r_rig.ik->solve();
+		solve_usec.push_back(OS::get_singleton()->get_ticks_usec() - start);
+		if (p_track_convergence) {
+			quality.solver_iterations += uint64_t(r_rig.ik->get_stats()["iterations"]);
+			const int32_t history_size = r_rig.ik->get_residual_history_iterations();
+			for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+				PinQuality &pin = quality.pins[pin_i];
+				const Vector2 *history = r_rig.ik->get_pin_residual_history_ptr(pin_i);
+				for (int32_t iteration_i = 0; history && pin.iterations_to_converge == -1 && iteration_i < history_size; iteration_i++) {
+					if (history[iteration_i].x <= r_rig.ik->get_residual_tolerance()) {
+						pin.iterations_to_converge = iterations_done + iteration_i + 1;
+					}
+				}
+			}
+			iterations_done += history_size;
+		}
+
+		double frame_jitter = 0.0;
+		for (int32_t bone_i = 0; bone_i < bone_count; bone_i++) {
+			const Quaternion rotation = r_rig.skeleton->get_bone_pose_rotation(bone_i);
+			if (frame > 0) {
+				frame_jitter = MAX(frame_jitter, double(previous_rotations[bone_i].angle_to(rotation)));
+			}
+			previous_rotations[bone_i] = rotation;
+		}
+		if (is_target_still(p_scenario, frame)) {
+			jitter_sum += frame_jitter;
+			quality.max_jitter = MAX(quality.max_jitter, frame_jitter);
+			still_frames++;
+		}
+		if (frame < SETTLE_FRAMES) {
+			continue;
+		}
+		quality.measured_frames++;
+		for (int32_t pin_i = 0; pin_i < pin_count; pin_i++) {
+			PinQuality &pin = quality.pins[pin_i];
+			pin.final_position_error = r_rig.ik->get_pin_position_error(pin_i);
+			pin.position_error_sum += pin.final_position_error;
+			pin.orientation_error_sum += r_rig.ik->get_pin_orientation_error(pin_i);
+			pin.unreachable_frames += r_rig.ik->is_pin_unreachable(pin_i) ? 1 : 0;
+		}
+	}
+	r_rig.ik->set_stats_enabled(false);
+	r_rig.ik->set_residual_history_enabled(false);
+
+	solve_usec.sort();
+	double solve_usec_sum = 0.0;
+	for (double usec : solve_usec) {
+		solve_usec_sum += usec;
+	}
+	quality.mean_solve_usec = solve_usec_sum / solve_usec.size();
+	quality.p90_solve_usec = solve_usec[(solve_usec.size() * 9) / 10];
+	quality.mean_jitter = still_frames ? jitter_sum / still_frames : 0.0;
+	return quality;
+}
+
+static void run_scenario(const String &p_rig_name, Rig &r_rig, Scenario p_scenario, int32_t p_iterations, float p_damp, int32_t p_stabilization_passes, LocalVector<String> &r_rows) {
+	const ScenarioQuality quality = measure_scenario(r_rig, p_scenario, p_iterations, p_damp, p_stabilization_passes);
+	for (uint32_t pin_i = 0; pin_i < quality.pins.size(); pin_i++) {
+		const PinQuality &pin = quality.pins[pin_i];
+		CHECK(Math::is_finite(pin.position_error_sum));
+		r_rows.push_back(vformat("%s,%s,%d,%f,%d,%d,%s,%f,%f,%f,%d,%f,%f,%f,%f",
+				p_rig_name, scenario_names[p_scenario], p_iterations, p_damp, p_stabilization_passes,
+				pin_i, r_rig.skeleton->get_bone_name(r_rig.pinned_bones[pin_i]),
+				pin.position_error_sum / quality.measured_frames, pin.final_position_error, pin.orientation_error_sum / quality.measured_frames, pin.unreachable_frames,
+				quality.mean_jitter, quality.max_jitter, quality.mean_solve_usec, quality.p90_solve_usec));
+	}
+}
+
+static void sweep(const String &p_rig_name, Rig (*p_create_rig)(), LocalVector<String> &r_rows) {
+	const int32_t iteration_counts[] = { 1, 2, 4, 8, 16 };
+	const float damps[] = { Math::deg_to_rad(1.0f), Math::deg_to_rad(5.0f), Math::deg_to_rad(10.0f), Math::deg_to_rad(20.0f) };
+	const int32_t stabilization_pass_counts[] = { 0, 1 };
+	for (int32_t scenario_i = 0; scenario_i < SCENARIO_MAX; scenario_i++) {
+		// A fresh rig per scenario, so constraints never leak into the others.
+		Rig rig = p_create_rig();
+		if (scenario_i == SCENARIO_CONSTRAINT_BOUNDARY) {
+			constrain_all_bones(rig);
+		}
+		for (int32_t iterations : iteration_counts) {
+			for (float damp : damps) {
+				for (int32_t stabilization_passes : stabilization_pass_counts) {
+					run_scenario(p_rig_name, rig, Scenario(scenario_i), iterations, damp, stabilization_passes, r_rows);
+				}
+			}
+		}
+		free_rig(rig);
+	}
+}
+
+static Rig create_quality_chain_rig() {
+	return create_chain_rig(8);
+}
+
+// Checked-in ceilings for the guarded scenario below: an eight bone chain
+// following a still, reachable target at 8 iterations and 5 degrees damping.
+// Raise them only together with a change that is meant to cost quality.
+static constexpr int32_t GUARD_ITERATIONS = 8;
+static constexpr int32_t GUARD_MAX_ITERATIONS_TO_CONVERGE = 48;
+static constexpr double GUARD_MAX_MEAN_POSITION_ERROR = 0.01;
+static constexpr double GUARD_MAX_JITTER = 0.01; // Radians per frame.
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Quality] A reachable chain stays within its quality thresholds") {
+	Rig rig = create_quality_chain_rig();
+	const ScenarioQuality quality = measure_scenario(rig, SCENARIO_REACHABLE, GUARD_ITERATIONS, Math::deg_to_rad(5.0f), 0, true);
+	// Every frame runs exactly the configured iterations; none are skipped or repeated.
+	CHECK(quality.solver_iterations == uint64_t(QUALITY_FRAMES) * GUARD_ITERATIONS);
+	REQUIRE(quality.pins.size() == 1);
+	const PinQuality &pin = quality.pins[0];
+	CHECK(pin.iterations_to_converge > 0);
+	CHECK(pin.iterations_to_converge <= GUARD_MAX_ITERATIONS_TO_CONVERGE);
+	CHECK(pin.position_error_sum / quality.measured_frames < GUARD_MAX_MEAN_POSITION_ERROR);
+	CHECK(pin.final_position_error < GUARD_MAX_MEAN_POSITION_ERROR);
+	CHECK(pin.unreachable_frames == 0);
+	CHECK(quality.max_jitter < GUARD_MAX_JITTER);
+	free_rig(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D][Benchmark][Quality] Convergence against cost by scenario" * doctest::skip()) {
+	LocalVector<String> rows;
+	sweep("chain", &create_quality_chain_rig, rows);
+	sweep("humanoid", &create_humanoid_rig, rows);
+	CHECK(rows.size() > 0);
+	write_rows(rows);
+}
+
+} // namespace TestManyBoneIKQuality
@@ -0,0 +1,70 @@
+/**************************************************************************/
+/*  test_many_bone_ik_residuals.h                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestManyBoneIKResiduals {
+
+const Transform3D reachable_target(Basis(), Vector3(1.0, 2.0, 0.3));
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Pin residuals report the distance left to the target") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->set_pin_target_transform_override(0, reachable_target);
+	for (int32_t solve_i = 0; solve_i < 4; solve_i++) {
+		rig.ik->solve();
+	}
+	REQUIRE(rig.ik->get_pin_residual_count() == 1);
+	const float position_error = rig.ik->get_pin_position_error(0);
+	CHECK(position_error == doctest::Approx(TestEWBIKFixtures::get_hand_position(rig).distance_to(reachable_target.origin)).epsilon(0.01));
+	CHECK(position_error < rig.ik->get_residual_tolerance());
+	CHECK_FALSE(rig.ik->is_pin_unreachable(0));
+	CHECK_FALSE(rig.ik->is_pin_constraint_limited(0));
+	CHECK(rig.ik->get_pin_residual_history(0).is_empty());
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Residual history holds one entry per iteration") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->set_residual_history_enabled(true);
+	rig.ik->solve();
+	rig.ik->set_pin_target_transform_override(0, reachable_target);
+	rig.ik->solve();
+	const PackedVector2Array history = rig.ik->get_pin_residual_history(0);
+	REQUIRE(history.size() == 10);
+	CHECK(history[history.size() - 1].x <= history[0].x);
+	CHECK(history[history.size() - 1].x == doctest::Approx(rig.ik->get_pin_position_error(0)));
+	CHECK(rig.ik->get_pin_residual_history_ptr(0) != nullptr);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestManyBoneIKResiduals
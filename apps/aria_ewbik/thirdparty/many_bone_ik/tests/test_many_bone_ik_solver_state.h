@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*  test_many_bone_ik_solver_state.h                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestManyBoneIKSolverState {
+
+const Transform3D first_target(Basis(Vector3(0, 0, 1), 0.4), Vector3(1.0, 2.0, 0.3));
+const Transform3D second_target(Basis(Vector3(1, 0, 0), -0.6), Vector3(-1.2, 1.5, -0.4));
+
+void solve_towards(EWBIK3D *p_ik, const Transform3D &p_target, int32_t p_solves) {
+	p_ik->set_pin_target_transform_override(0, p_target);
+	for (int32_t solve_i = 0; solve_i < p_solves; solve_i++) {
+		p_ik->solve();
+	}
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Restoring the solver state rolls back the solve") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm(true);
+	rig.ik->set_stabilization_passes(1);
+	rig.ik->solve();
+	solve_towards(rig.ik, first_target, 2);
+
+	const PackedByteArray state = rig.ik->save_solver_state();
+	REQUIRE(state.size() == rig.ik->get_solver_state_size());
+	const int64_t saved_hash = rig.ik->get_pose_hash();
+
+	// Predict ahead, then replay from the saved point.
+	solve_towards(rig.ik, first_target, 1);
+	const int64_t predicted_hash = rig.ik->get_pose_hash();
+
+	solve_towards(rig.ik, second_target, 3);
+	CHECK(rig.ik->get_pose_hash() != saved_hash);
+
+	REQUIRE(rig.ik->restore_solver_state(state) == OK);
+	CHECK(rig.ik->get_pose_hash() == saved_hash);
+	solve_towards(rig.ik, first_target, 1);
+	CHECK(rig.ik->get_pose_hash() == predicted_hash);
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Many states fit in one caller-provided buffer") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->solve();
+	const int64_t state_size = rig.ik->get_solver_state_size();
+	const int32_t frame_count = 8;
+	LocalVector<uint8_t> ring;
+	ring.resize(state_size * frame_count);
+	LocalVector<int64_t> hashes;
+	for (int32_t frame_i = 0; frame_i < frame_count; frame_i++) {
+		solve_towards(rig.ik, Transform3D(Basis(), Vector3(0.2 * frame_i, 2.5, 0.1)), 1);
+		REQUIRE(rig.ik->save_solver_state_to_buffer(ring.ptr() + frame_i * state_size, state_size) == OK);
+		hashes.push_back(rig.ik->get_pose_hash());
+	}
+	for (int32_t frame_i = frame_count; frame_i-- > 0;) {
+		REQUIRE(rig.ik->restore_solver_state_from_buffer(ring.ptr() + frame_i * state_size, state_size) == OK);
+		CHECK(rig.ik->get_pose_hash() == hashes[frame_i]);
+	}
+	CHECK(rig.ik->get_solver_state_size() == state_size);
+
+	ERR_PRINT_OFF;
+	CHECK(rig.ik->restore_solver_state_from_buffer(ring.ptr(), state_size - 1) == ERR_INVALID_DATA);
+	ERR_PRINT_ON;
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] A state from another layout is rejected") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->solve();
+	const PackedByteArray state = rig.ik->save_solver_state();
+
+	rig.ik->set_pin_count(2);
+	rig.ik->set_pin_bone_name(1, "LowerArm");
+	rig.ik->solve();
+	CHECK(rig.ik->get_solver_state_size() != state.size());
+	ERR_PRINT_OFF;
+	CHECK(rig.ik->restore_solver_state(state) != OK);
+	ERR_PRINT_ON;
+
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+} // namespace TestManyBoneIKSolverState
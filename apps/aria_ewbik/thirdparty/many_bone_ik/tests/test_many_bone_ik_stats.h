@@ -0,0 +1,100 @@
+/**************************************************************************/
+/*  test_many_bone_ik_stats.h                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "modules/many_bone_ik/src/ik_solver_stats_3d.h"
+#include "modules/many_bone_ik/tests/test_ewbik_fixtures.h"
+#include "tests/test_macros.h"
+
+namespace TestManyBoneIKStats {
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Statistics stay empty while disabled") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	CHECK_FALSE(rig.ik->is_stats_enabled());
+	rig.ik->solve();
+	const Dictionary stats = rig.ik->get_stats();
+	CHECK(int64_t(stats["solves"]) == 0);
+	CHECK(int64_t(stats["iterations"]) == 0);
+	CHECK(double(stats["total_usec"]) == 0.0);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[SceneTree][Modules][ManyBoneIK][EWBIK3D] Statistics count the last solve") {
+	TestEWBIKFixtures::ArmRig rig = TestEWBIKFixtures::create_arm();
+	rig.ik->set_stats_enabled(true);
+	rig.ik->solve();
+	Dictionary stats = rig.ik->get_stats();
+	CHECK(int64_t(stats["solves"]) == 1);
+	CHECK(int64_t(stats["rebuilds"]) == 1);
+	CHECK(int64_t(stats["iterations"]) == 10);
+	CHECK(int64_t(stats["segments"]) >= 10);
+	CHECK(int64_t(stats["bones"]) >= int64_t(stats["segments"]));
+	CHECK(double(stats["qcp_usec"]) > 0.0);
+	CHECK(double(stats["total_usec"]) >= double(stats["qcp_usec"]));
+
+	// Counters are per frame, and a clean solve does not rebuild the segments.
+	rig.ik->set_pin_target_transform_override(0, Transform3D(Basis(), Vector3(1.0, 2.0, 0.5)));
+	rig.ik->solve();
+	stats = rig.ik->get_stats();
+	CHECK(int64_t(stats["solves"]) == 1);
+	CHECK(int64_t(stats["rebuilds"]) == 0);
+	CHECK(int64_t(stats["iterations"]) == 10);
+	CHECK(double(stats["target_update_usec"]) > 0.0);
+
+	rig.ik->set_stats_enabled(false);
+	CHECK(int64_t(rig.ik->get_stats()["solves"]) == 0);
+	TestEWBIKFixtures::free_arm(rig);
+}
+
+TEST_CASE("[Modules][ManyBoneIK][IKSolverStats3D] Global statistics report the last finished frame") {
+	IKSolverStats3D::Counters first;
+	first.solves = 2;
+	first.iterations = 20;
+	IKSolverStats3D::Counters second;
+	second.solves = 3;
+	second.iterations = 45;
+
+	// Far from the engine's own frame counter, so other solves do not mix in.
+	const uint64_t frame = 1000000;
+	IKSolverStats3D::add_to_global(first, frame);
+	IKSolverStats3D::add_to_global(first, frame);
+	CHECK(IKSolverStats3D::get_global_last_frame(frame + 1).solves == 4);
+	// The snapshot stays readable however late the monitors poll.
+	CHECK(IKSolverStats3D::get_global_last_frame(frame + 10).iterations == 40);
+
+	// While the next frame fills up, the finished one is still reported.
+	IKSolverStats3D::add_to_global(second, frame + 1);
+	CHECK(IKSolverStats3D::get_global_last_frame(frame + 1).solves == 4);
+	CHECK(IKSolverStats3D::get_global_last_frame(frame + 2).solves == 3);
+	CHECK(IKSolverStats3D::get_global_last_frame(frame + 2).iterations == 45);
+}
+
+} // namespace TestManyBoneIKStats